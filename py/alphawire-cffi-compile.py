@@ -289,6 +289,8 @@ typedef struct {
 AwResult AwControl_Init(AwControl* self, AwDevice* device, MAllocator* allocator);
 AwResult AwControl_Connect(AwControl* self, AwSonyProtocolVersion version);
 AwResult AwControl_Cleanup(AwControl* self);
+AwResult AwControl_AcquireTransport(AwControl* self, int timeoutMilliseconds);
+void AwControl_ReleaseTransport(AwControl* self);
 AwResult AwControl_UpdateProperties(AwControl* self);
 size_t AwControl_NumProperties(AwControl* self);
 AwPtpProperty* AwControl_GetPropertyAtIndex(AwControl* self, u16 index);
@@ -97,7 +97,9 @@ class AwControl:
         live_view_frames = ffi.new("AwLiveViewFrames[1]")
         p_live_view_frames = ffi.addressof(live_view_frames[0])
 
+        self.awire_lib.AwControl_AcquireTransport(self.control, -1)
         self.awire_lib.AwControl_GetLiveViewImage(self.control, p_mem_io, p_live_view_frames)
+        self.awire_lib.AwControl_ReleaseTransport(self.control)
         if self.live_view_image.size:
             self.awire_lib.AwControl_FreeLiveViewFrames(self.control, live_view_frames)
             buffer_obj = ffi.buffer(self.live_view_image.mem, self.live_view_image.size)
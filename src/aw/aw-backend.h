@@ -14,7 +14,47 @@ typedef void* (*AwDevice_ReallocBuffer_Func)(struct AwDevice* device, AwBufferTy
 typedef void (*AwDevice_FreeBuffer_Func)(struct AwDevice* device, AwBufferType type, void* dataMem, size_t dataOldSize);
 typedef AwResult (*AwDevice_SendAndRecv_Func)(struct AwDevice* device, AwPtpRequestHeader* request, u8* dataIn,
     size_t dataInSize, AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize, size_t* actualDataOutSize);
+#define AW_DATA_SINK_CHUNK_SIZE_DEFAULT (512 * 1024)
+
+// Called with each chunk of a streamed data phase as it arrives, return FALSE to stop receiving chunks
+typedef b32 (*AwDataSink_Write_Func)(void* userData, const u8* data, size_t size);
+
+// Caller owned destination for a data phase, the transport receives the payload directly into 'mem' rather than into
+// its own out buffer.
+// If 'write' is set the payload is streamed instead, 'mem' & 'capacity' are unused and the transport passes each
+// chunk (of at most chunkSize bytes) to 'write' while the rest of the transfer is still in flight.
+typedef struct AwDataSink {
+    u8* mem;
+    size_t capacity;
+    size_t size; // Number of bytes received into mem or passed to write()
+    AwDataSink_Write_Func write;
+    void* userData;
+    size_t chunkSize; // Streaming chunk size, 0 for AW_DATA_SINK_CHUNK_SIZE_DEFAULT
+    b32 aborted; // Set if write() returned FALSE, the rest of the data phase is received but dropped
+    // Set to the payload length if it doesn't fit in 'capacity', the data phase is then drained and the transport
+    // returns AW_RESULT_BUFFER_TOO_SMALL
+    size_t required;
+} AwDataSink;
+
+MINLINE size_t AwDataSink_GetChunkSize(AwDataSink* sink) {
+    return sink->chunkSize ? sink->chunkSize : AW_DATA_SINK_CHUNK_SIZE_DEFAULT;
+}
+
+// Pass a chunk of a streamed data phase to the sink
+MINLINE void AwDataSink_Write(AwDataSink* sink, const u8* data, size_t size) {
+    if (size && !sink->aborted && !sink->write(sink->userData, data, size)) {
+        sink->aborted = TRUE;
+    }
+    sink->size += size;
+}
+
+typedef AwResult (*AwDevice_SendAndRecvSink_Func)(struct AwDevice* device, AwPtpRequestHeader* request, u8* dataIn,
+    size_t dataInSize, AwPtpResponseHeader* response, AwDataSink* sink);
 typedef b32 (*AwDevice_Reset_Func)(struct AwDevice* device);
+// Ask the device to abort the transaction in flight, callable from any thread.  The sendAndRecv / sendAndRecvSink call
+// running the transaction returns AW_RESULT_CANCELLED once the device has stopped, leaving the session usable.
+// Does nothing if no transaction is in flight.
+typedef AwResult (*AwDevice_Cancel_Func)(struct AwDevice* device);
 typedef AwResult (*AwDevice_ReadEvents_Func)(struct AwDevice* device, int timeoutMilliseconds, MAllocator* alloc,
                                              AwPtpEvent** outEventList);
 
@@ -23,7 +63,9 @@ typedef struct {
     AwDevice_ReallocBuffer_Func reallocBuffer;
     AwDevice_FreeBuffer_Func freeBuffer;
     AwDevice_SendAndRecv_Func sendAndRecv;
+    AwDevice_SendAndRecvSink_Func sendAndRecvSink; // Optional, NULL if the transport can't receive into caller memory
     AwDevice_Reset_Func reset;
+    AwDevice_Cancel_Func cancel; // Optional, NULL if the transport can't cancel transactions
     AwDevice_ReadEvents_Func readEvents;
     b32 requiresSessionOpenClose;
     MAllocator* allocator;
@@ -61,7 +103,12 @@ typedef struct AwDevice {
 } AwDevice;
 
 typedef struct MBackendConfig {
+    // Don't start background threads to read events (libusb, PTP/IP), events are then only read when polled
     b32 disallowSpawnEventThread;
+    // USB bulk in data phase pipeline: number of transfers kept in flight and bytes per transfer.
+    // 0 uses the backend default, a transfer count of 1 disables the async pipeline.
+    u32 usbAsyncTransferCount;
+    u32 usbAsyncTransferSize;
 } AwBackendConfig;
 
 struct AwBackend;
@@ -74,6 +121,7 @@ typedef b32 (*AwBackend_PollListUpdates_Func)(struct AwBackend* backend, AwDevic
 typedef AwResult (*AwBackend_ReleaseList_Func)(struct AwBackend* backend);
 typedef AwResult (*AwBackend_OpenDevice_Func)(struct AwBackend* backend, AwDeviceInfo* deviceInfo, AwDevice** deviceOut);
 typedef AwResult (*AwBackend_CloseDevice_Func)(struct AwBackend* backend, AwDevice* device);
+typedef AwResult (*AwBackend_ServiceDevices_Func)(struct AwBackend* backend, int timeoutMilliseconds);
 
 // Generic backend
 typedef struct AwBackend {
@@ -85,6 +133,7 @@ typedef struct AwBackend {
     AwBackend_ReleaseList_Func releaseList;
     AwBackend_OpenDevice_Func openDevice;
     AwBackend_CloseDevice_Func closeDevice;
+    AwBackend_ServiceDevices_Func serviceDevices; // Optional, NULL if the backend has no multi-device event loop
     AwBackendType type;
     AwBackendConfig config;
     AwLog logger;
@@ -0,0 +1,746 @@
+﻿#include "aw-command-queue.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+#define ATOMIC_LOAD_U32(p) ((u32)InterlockedCompareExchange((volatile LONG*)(p), 0, 0))
+#define ATOMIC_STORE_U32(p, v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#define ATOMIC_SUB_FETCH_U32(p, v) ((u32)InterlockedExchangeAdd((volatile LONG*)(p), -(LONG)(v)) - (v))
+#define ATOMIC_ADD_FETCH_U32(p, v) ((u32)InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v)) + (v))
+#else
+#define ATOMIC_LOAD_U32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_U32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_SUB_FETCH_U32(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_ADD_FETCH_U32(p, v) __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#endif
+
+typedef struct AwCommandThread {
+#ifdef _WIN32
+    HANDLE handle;
+    HANDLE deadlineHandle;
+    CRITICAL_SECTION lock;
+    CONDITION_VARIABLE workCond; // Signalled when a command is queued or the queue stops
+    CONDITION_VARIABLE doneCond; // Broadcast when a command finishes
+    CONDITION_VARIABLE deadlineCond; // Signalled when a command starts running or the queue stops
+#else
+    pthread_t handle;
+    pthread_t deadlineHandle;
+    pthread_mutex_t lock;
+    pthread_cond_t workCond;
+    pthread_cond_t doneCond;
+    pthread_cond_t deadlineCond;
+#endif
+    b32 stop;
+    AwCommand* running; // The worker's current command, NULL between commands
+    u32 refCount; // Queue + each submitted command, the lock outlives Stop() while callers still hold commands
+    AwCommand* completed; // Done commands whose callbacks haven't been run yet, see RunCompletions()
+} AwCommandThread;
+
+static void Lock(AwCommandThread* thread) {
+#ifdef _WIN32
+    EnterCriticalSection(&thread->lock);
+#else
+    pthread_mutex_lock(&thread->lock);
+#endif
+}
+
+static void Unlock(AwCommandThread* thread) {
+#ifdef _WIN32
+    LeaveCriticalSection(&thread->lock);
+#else
+    pthread_mutex_unlock(&thread->lock);
+#endif
+}
+
+#ifdef _WIN32
+#define CondSignal(c) WakeConditionVariable(c)
+#define CondBroadcast(c) WakeAllConditionVariable(c)
+#define CondWait(t, c) SleepConditionVariableCS(c, &(t)->lock, INFINITE)
+#else
+#define CondSignal(c) pthread_cond_signal(c)
+#define CondBroadcast(c) pthread_cond_broadcast(c)
+#define CondWait(t, c) pthread_cond_wait(c, &(t)->lock)
+#endif
+
+// Returns FALSE on timeout
+static b32 CondWaitMs(AwCommandThread* thread, void* cond, u32 waitMs) {
+#ifdef _WIN32
+    return SleepConditionVariableCS((CONDITION_VARIABLE*)cond, &thread->lock, waitMs) != 0;
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += waitMs / 1000;
+    deadline.tv_nsec += (long)(waitMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait((pthread_cond_t*)cond, &thread->lock, &deadline) != ETIMEDOUT;
+#endif
+}
+
+static void DestroyThread(AwCommandThread* thread) {
+#ifdef _WIN32
+    DeleteCriticalSection(&thread->lock);
+#else
+    pthread_cond_destroy(&thread->deadlineCond);
+    pthread_cond_destroy(&thread->doneCond);
+    pthread_cond_destroy(&thread->workCond);
+    pthread_mutex_destroy(&thread->lock);
+#endif
+}
+
+static void ReleaseThread(AwCommandThread* thread, MAllocator* allocator) {
+    if (ATOMIC_SUB_FETCH_U32(&thread->refCount, 1) == 0) {
+        DestroyThread(thread);
+        MFree(allocator, thread, sizeof(AwCommandThread));
+    }
+}
+
+static void FreeCommandRef(AwCommand* command, MAllocator* allocator) {
+    if (ATOMIC_SUB_FETCH_U32(&command->refCount, 1) == 0) {
+        ReleaseThread(command->thread, allocator);
+        MFree(allocator, command, sizeof(AwCommand));
+    }
+}
+
+// Called with the lock held, the callback and the queue's reference are handled by RunCompletions() once unlocked
+static void CompleteCommand(AwCommandQueue* self, AwCommand* command, AwResult result) {
+    command->result = result;
+    ATOMIC_STORE_U32(&command->state, AW_COMMAND_DONE);
+    CondBroadcast(&self->thread->doneCond);
+    command->next = self->thread->completed;
+    self->thread->completed = command;
+}
+
+// Run the callbacks of completed commands, called without the lock so callbacks can submit
+static void RunCompletions(AwCommandQueue* self, AwCommandThread* thread) {
+    Lock(thread);
+    AwCommand* command = thread->completed;
+    thread->completed = NULL;
+    Unlock(thread);
+
+    while (command) {
+        AwCommand* next = command->next;
+        command->next = NULL;
+        if (command->onComplete) {
+            command->onComplete(command, command->callbackData);
+        }
+        FreeCommandRef(command, self->control->allocator);
+        command = next;
+    }
+}
+
+// Called with the lock held
+static AwCommand* PopCommand(AwCommandQueue* self, int priority) {
+    AwCommand* command = self->heads[priority];
+    if (command) {
+        self->heads[priority] = command->next;
+        if (!command->next) {
+            self->tails[priority] = NULL;
+        }
+        command->next = NULL;
+        self->stats.classes[priority].queued--;
+    }
+    return command;
+}
+
+// Called with the lock held
+static void ShedCommand(AwCommandQueue* self, AwCommand* command) {
+    self->stats.classes[command->priority].shed++;
+    CompleteCommand(self, command, (AwResult){.code = AW_RESULT_CANCELLED});
+}
+
+// Take the highest priority command that's still worth running, called with the lock held
+static AwCommand* NextCommand(AwCommandQueue* self) {
+    u64 now = MGetTimeMicroseconds();
+    for (int priority = 0; priority < AW_PRIORITY_COUNT; ++priority) {
+        AwCommand* command;
+        while ((command = PopCommand(self, priority)) != NULL) {
+            u32 maxWaitMs = self->config.maxWaitMs[priority];
+            if (priority >= AW_PRIORITY_SHEDDABLE && maxWaitMs && now - command->submitTimeUs > maxWaitMs * 1000ull) {
+                ShedCommand(self, command);
+                continue;
+            }
+            if (command->deadlineUs && now >= command->deadlineUs) {
+                CompleteCommand(self, command, (AwResult){.code = AW_RESULT_TIMEOUT});
+                continue;
+            }
+            return command;
+        }
+    }
+    return NULL;
+}
+
+static void WorkerRun(AwCommandQueue* self) {
+    AwCommandThread* thread = self->thread;
+    Lock(thread);
+    for (;;) {
+        AwCommand* command = NextCommand(self);
+        if (thread->completed) {
+            Unlock(thread);
+            RunCompletions(self, thread);
+            Lock(thread);
+            if (!command) {
+                // Work may have been queued while unlocked, check again before waiting
+                continue;
+            }
+        }
+        if (!command) {
+            if (thread->stop) {
+                break;
+            }
+            CondWait(thread, &thread->workCond);
+            continue;
+        }
+
+        AwCommandClassStats* stats = self->stats.classes + command->priority;
+        u64 wait = MGetTimeMicroseconds() - command->submitTimeUs;
+        u32 waitUs = wait > 0xffffffff ? 0xffffffff : (u32)wait;
+        stats->lastWaitUs = waitUs;
+        if (waitUs > stats->maxWaitUs) {
+            stats->maxWaitUs = waitUs;
+        }
+        stats->totalWaitUs += waitUs;
+        ATOMIC_STORE_U32(&command->state, AW_COMMAND_RUNNING);
+        thread->running = command;
+        if (command->deadlineUs) {
+            CondSignal(&thread->deadlineCond);
+        }
+        Unlock(thread);
+
+        // Share the session with threads calling AwControl directly, see AwControl_AcquireTransport()
+        AwControl_AcquireTransport(self->control, -1);
+
+        // Cancels from here on can reach the command's transfers, one that came in while waiting for the transport
+        // skips the command
+        Lock(thread);
+        b32 cancelled = ATOMIC_LOAD_U32(&command->cancelRequested);
+        command->transportToken = AwControl_GetTransportToken(self->control);
+        Unlock(thread);
+
+        AwResult result = {.code = AW_RESULT_CANCELLED};
+        if (!cancelled) {
+            result = command->run(self->control, command->userData);
+        }
+
+        Lock(thread);
+        command->transportToken = 0;
+        Unlock(thread);
+        AwControl_ReleaseTransport(self->control);
+
+        Lock(thread);
+        thread->running = NULL;
+        if (command->deadlinePassed && result.code == AW_RESULT_CANCELLED) {
+            result.code = AW_RESULT_TIMEOUT;
+        }
+        stats->completed++;
+        CompleteCommand(self, command, result);
+    }
+    Unlock(thread);
+}
+
+// Cancel a running command, called with the lock held and returns with it held.  The queue lock is released before
+// the cancel is sent, AwControl_CancelTransactionForToken() drops it if the command has given up the transport by then.
+static void CancelRunning(AwCommandQueue* self, AwCommand* command) {
+    ATOMIC_STORE_U32(&command->cancelRequested, TRUE);
+    u32 transportToken = command->transportToken;
+    if (!transportToken) {
+        // Not holding the transport yet (or any more), the worker sees cancelRequested before it runs
+        return;
+    }
+    // The command may be freed and the queue stopped while unlocked, the caller's reference (its own command or the
+    // queue's) keeps the thread state alive
+    AwCommandThread* thread = command->thread;
+    Unlock(thread);
+    AwControl_CancelTransactionForToken(self->control, transportToken);
+    Lock(thread);
+}
+
+// Cancels the running command once it is past its deadline, the worker can't while it is blocked in the transfer
+static void DeadlineRun(AwCommandQueue* self) {
+    AwCommandThread* thread = self->thread;
+    Lock(thread);
+    while (!thread->stop) {
+        AwCommand* command = thread->running;
+        if (!command || !command->deadlineUs || command->deadlinePassed) {
+            CondWait(thread, &thread->deadlineCond);
+            continue;
+        }
+        u64 now = MGetTimeMicroseconds();
+        if (now < command->deadlineUs) {
+            u64 waitMs = (command->deadlineUs - now + 999) / 1000;
+            CondWaitMs(thread, &thread->deadlineCond, waitMs > 0xffffffff ? 0xffffffff : (u32)waitMs);
+            continue;
+        }
+        AW_LOG_WARNING(&self->control->logger, "Command past its deadline, cancelling");
+        command->deadlinePassed = TRUE;
+        CancelRunning(self, command);
+    }
+    Unlock(thread);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerThreadProc(LPVOID param) {
+    WorkerRun((AwCommandQueue*)param);
+    return 0;
+}
+
+static DWORD WINAPI DeadlineThreadProc(LPVOID param) {
+    DeadlineRun((AwCommandQueue*)param);
+    return 0;
+}
+#else
+static void* WorkerThreadProc(void* param) {
+    WorkerRun((AwCommandQueue*)param);
+    return NULL;
+}
+
+static void* DeadlineThreadProc(void* param) {
+    DeadlineRun((AwCommandQueue*)param);
+    return NULL;
+}
+#endif
+
+// Ask the worker and deadline threads to exit, they finish once the running command is done
+static void StopWorker(AwCommandThread* thread) {
+    Lock(thread);
+    thread->stop = TRUE;
+    CondSignal(&thread->workCond);
+    CondSignal(&thread->deadlineCond);
+    Unlock(thread);
+}
+
+AwResult AwCommandQueue_Start(AwCommandQueue* self, AwControl* control, AwCommandQueueConfig* config) {
+    if (!self || !control) {
+        return (AwResult){.code = AW_RESULT_PARAM_ERROR};
+    }
+    if (self->running) {
+        return (AwResult){.code = AW_RESULT_OK};
+    }
+
+    memset(self, 0, sizeof(AwCommandQueue));
+    self->control = control;
+    if (config) {
+        self->config = *config;
+    }
+    for (int i = AW_PRIORITY_SHEDDABLE; i < AW_PRIORITY_COUNT; ++i) {
+        if (!self->config.maxQueued[i]) {
+            self->config.maxQueued[i] = AW_COMMAND_QUEUE_MAX_QUEUED_DEFAULT;
+        }
+    }
+    if (!self->config.maxWaitMs[AW_PRIORITY_REFRESH]) {
+        self->config.maxWaitMs[AW_PRIORITY_REFRESH] = AW_COMMAND_QUEUE_REFRESH_MAX_WAIT_MS_DEFAULT;
+    }
+    if (!self->config.maxWaitMs[AW_PRIORITY_LIVE_VIEW]) {
+        self->config.maxWaitMs[AW_PRIORITY_LIVE_VIEW] = AW_COMMAND_QUEUE_LIVE_VIEW_MAX_WAIT_MS_DEFAULT;
+    }
+
+    AwCommandThread* thread = MMallocZ(control->allocator, sizeof(AwCommandThread));
+    thread->refCount = 1;
+    self->thread = thread;
+#ifdef _WIN32
+    InitializeCriticalSection(&thread->lock);
+    InitializeConditionVariable(&thread->workCond);
+    InitializeConditionVariable(&thread->doneCond);
+    InitializeConditionVariable(&thread->deadlineCond);
+    thread->handle = CreateThread(NULL, 0, WorkerThreadProc, self, 0, NULL);
+    b32 started = thread->handle != NULL;
+    if (started) {
+        thread->deadlineHandle = CreateThread(NULL, 0, DeadlineThreadProc, self, 0, NULL);
+        if (!thread->deadlineHandle) {
+            StopWorker(thread);
+            WaitForSingleObject(thread->handle, INFINITE);
+            CloseHandle(thread->handle);
+            started = FALSE;
+        }
+    }
+#else
+    pthread_mutex_init(&thread->lock, NULL);
+    pthread_cond_init(&thread->workCond, NULL);
+    pthread_cond_init(&thread->doneCond, NULL);
+    pthread_cond_init(&thread->deadlineCond, NULL);
+    b32 started = pthread_create(&thread->handle, NULL, WorkerThreadProc, self) == 0;
+    if (started && pthread_create(&thread->deadlineHandle, NULL, DeadlineThreadProc, self) != 0) {
+        StopWorker(thread);
+        pthread_join(thread->handle, NULL);
+        started = FALSE;
+    }
+#endif
+    if (!started) {
+        DestroyThread(thread);
+        AW_LOG_ERROR(&control->logger, "Failed to start command queue thread");
+        MFree(control->allocator, self->thread, sizeof(AwCommandThread));
+        self->thread = NULL;
+        return (AwResult){.code = AW_RESULT_NOT_SUPPORTED};
+    }
+
+    self->running = TRUE;
+    return (AwResult){.code = AW_RESULT_OK};
+}
+
+void AwCommandQueue_Stop(AwCommandQueue* self) {
+    if (!self->running) {
+        return;
+    }
+    AW_LOG_TRACE(&self->control->logger, "AwCommandQueue_Stop");
+
+    AwCommandThread* thread = self->thread;
+    Lock(thread);
+    for (int priority = 0; priority < AW_PRIORITY_COUNT; ++priority) {
+        AwCommand* command;
+        while ((command = PopCommand(self, priority)) != NULL) {
+            CompleteCommand(self, command, (AwResult){.code = AW_RESULT_CANCELLED});
+        }
+    }
+    Unlock(thread);
+    StopWorker(thread);
+    RunCompletions(self, thread);
+
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    WaitForSingleObject(thread->deadlineHandle, INFINITE);
+    CloseHandle(thread->deadlineHandle);
+#else
+    pthread_join(thread->handle, NULL);
+    pthread_join(thread->deadlineHandle, NULL);
+#endif
+    RunCompletions(self, thread);
+
+    // Commands the caller still holds keep the lock alive for AwCommand_Wait() / AwCommand_Cancel()
+    self->thread = NULL;
+    self->running = FALSE;
+    ReleaseThread(thread, self->control->allocator);
+}
+
+static AwResult SubmitCommand(AwCommandQueue* self, AwCommand* command, const AwCommandOptions* options,
+                              AwCommand** outCommand) {
+    AwCommandThread* thread = self->thread;
+    if (outCommand) {
+        *outCommand = NULL;
+    }
+    if (!self->running) {
+        MFree(self->control->allocator, command, sizeof(AwCommand));
+        return (AwResult){.code = AW_RESULT_CANCELLED};
+    }
+
+    command->queue = self;
+    command->thread = thread;
+    ATOMIC_ADD_FETCH_U32(&thread->refCount, 1);
+    command->state = AW_COMMAND_QUEUED;
+    command->refCount = outCommand ? 2 : 1;
+    command->submitTimeUs = MGetTimeMicroseconds();
+    if (options) {
+        if (options->timeoutMilliseconds) {
+            command->deadlineUs = command->submitTimeUs + options->timeoutMilliseconds * 1000ull;
+        }
+        command->onComplete = options->onComplete;
+        command->callbackData = options->callbackData;
+    }
+
+    int priority = command->priority;
+    Lock(thread);
+    AwCommandClassStats* stats = self->stats.classes + priority;
+    stats->submitted++;
+
+    // Polling classes only keep the newest few commands
+    if (priority >= AW_PRIORITY_SHEDDABLE) {
+        while (stats->queued >= self->config.maxQueued[priority]) {
+            AwCommand* oldest = PopCommand(self, priority);
+            if (oldest->run == command->run && priority == AW_PRIORITY_REFRESH) {
+                command->args.fullRefresh |= oldest->args.fullRefresh;
+            }
+            ShedCommand(self, oldest);
+        }
+    }
+
+    if (self->tails[priority]) {
+        self->tails[priority]->next = command;
+    } else {
+        self->heads[priority] = command;
+    }
+    self->tails[priority] = command;
+    stats->queued++;
+    CondSignal(&thread->workCond);
+
+    // Capture commands preempt a running poll, a live view download or refresh can take long enough to delay the
+    // shutter noticeably.  The poll completes with AW_RESULT_CANCELLED, the caller polls again anyway.
+    AwCommand* running = thread->running;
+    if (priority == AW_PRIORITY_CAPTURE && running && running->priority >= AW_PRIORITY_SHEDDABLE &&
+            !ATOMIC_LOAD_U32(&running->cancelRequested)) {
+        CancelRunning(self, running);
+    }
+    b32 shed = thread->completed != NULL;
+    Unlock(thread);
+    if (shed) {
+        RunCompletions(self, thread);
+    }
+
+    if (outCommand) {
+        *outCommand = command;
+    }
+    return (AwResult){.code = AW_RESULT_OK};
+}
+
+static AwCommand* NewCommand(AwCommandQueue* self, AwCommandPriority priority, AwCommandFunc run, void* userData) {
+    AwCommand* command = MMallocZ(self->control->allocator, sizeof(AwCommand));
+    command->priority = priority;
+    command->run = run;
+    command->userData = userData ? userData : command;
+    return command;
+}
+
+AwResult AwCommandQueue_Submit(AwCommandQueue* self, AwCommandPriority priority, AwCommandFunc run,
+                               void* userData, const AwCommandOptions* options, AwCommand** outCommand) {
+    if (!run || priority < 0 || priority >= AW_PRIORITY_COUNT) {
+        return (AwResult){.code = AW_RESULT_PARAM_ERROR};
+    }
+    AwCommand* command = NewCommand(self, priority, run, userData);
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_Call(AwCommandQueue* self, AwCommandPriority priority, AwCommandFunc run, void* userData) {
+    AwCommand* command = NULL;
+    AwResult r = AwCommandQueue_Submit(self, priority, run, userData, NULL, &command);
+    if (r.code != AW_RESULT_OK) {
+        return r;
+    }
+    AwCommand_Wait(command, -1, &r);
+    AwCommand_Release(command);
+    return r;
+}
+
+AwCommandPriority AwCommandQueue_GetControlPriority(u16 controlCode) {
+    switch (controlCode) {
+        case DPC_SHUTTER_HALF_PRESS:
+        case DPC_SHUTTER:
+        case DPC_SHUTTER_ONE:
+        case DPC_SHUTTER_ONE_RESET:
+        case DPC_SHUTTER_BOTH:
+        case DPC_AFL_BUTTON:
+        case DPC_AE_LOCK:
+        case DPC_AUTO_FOCUS_HOLD:
+        case DPC_MOVIE_RECORD:
+        case DPC_REMOTE_BUTTON:
+            return AW_PRIORITY_CAPTURE;
+        default:
+            return AW_PRIORITY_PROPERTY_SET;
+    }
+}
+
+static AwResult RunSetControlValue(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_SetControlValue(control, command->args.set.code, command->args.set.value);
+}
+
+static AwResult RunSetControlToggle(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_SetControlToggle(control, command->args.set.code, command->args.set.value.u8);
+}
+
+static AwResult RunSetPropertyValue(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    // Looked up here, property pointers don't survive a refresh
+    AwPtpProperty* property = AwControl_GetPropertyByCode(control, command->args.set.code);
+    if (!property) {
+        return (AwResult){.code = AW_RESULT_NOT_SUPPORTED};
+    }
+    return AwControl_SetPropertyValue(control, property, command->args.set.value);
+}
+
+static AwResult RunRemoteButtonPress(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_RemoteButtonPress(control, command->args.set.code, command->args.set.value.u8);
+}
+
+static AwResult RunUpdateProperties(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_UpdateProperties(control, command->args.fullRefresh);
+}
+
+static AwResult RunGetLiveViewImage(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_GetLiveViewImage(control, command->args.liveView.jpeg, command->args.liveView.frames);
+}
+
+static AwResult RunGetCapturedImage(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_GetCapturedImage(control, command->args.transfer.file, command->args.transfer.imageInfo);
+}
+
+static AwResult RunGetCameraSettingsFile(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_GetCameraSettingsFile(control, command->args.transfer.file);
+}
+
+static AwResult RunPutCameraSettingsFile(AwControl* control, void* userData) {
+    AwCommand* command = userData;
+    return AwControl_PutCameraSettingsFile(control, command->args.transfer.file);
+}
+
+AwResult AwCommandQueue_SetControlValue(AwCommandQueue* self, u16 controlCode, AwPtpPropValue value,
+                                        const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AwCommandQueue_GetControlPriority(controlCode), RunSetControlValue, NULL);
+    command->args.set.code = controlCode;
+    command->args.set.value = value;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_SetControlToggle(AwCommandQueue* self, u16 controlCode, b32 pressed,
+                                         const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AwCommandQueue_GetControlPriority(controlCode), RunSetControlToggle, NULL);
+    command->args.set.code = controlCode;
+    command->args.set.value.u8 = pressed ? 1 : 0;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_SetPropertyValue(AwCommandQueue* self, u16 propCode, AwPtpPropValue value,
+                                         const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_PROPERTY_SET, RunSetPropertyValue, NULL);
+    command->args.set.code = propCode;
+    command->args.set.value = value;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_RemoteButtonPress(AwCommandQueue* self, u16 button, b32 pressed,
+                                          const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_CAPTURE, RunRemoteButtonPress, NULL);
+    command->args.set.code = button;
+    command->args.set.value.u8 = pressed ? 1 : 0;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_UpdateProperties(AwCommandQueue* self, b32 fullRefresh, const AwCommandOptions* options,
+                                         AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_REFRESH, RunUpdateProperties, NULL);
+    command->args.fullRefresh = fullRefresh;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_GetLiveViewImage(AwCommandQueue* self, MMemIO* outJpeg, AwLiveViewFrames* outLiveViewFrames,
+                                         const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_LIVE_VIEW, RunGetLiveViewImage, NULL);
+    command->args.liveView.jpeg = outJpeg;
+    command->args.liveView.frames = outLiveViewFrames;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_GetCapturedImage(AwCommandQueue* self, MMemIO* outFile, AwPtpCapturedImageInfo* outImageInfo,
+                                         const AwCommandOptions* options, AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_TRANSFER, RunGetCapturedImage, NULL);
+    command->args.transfer.file = outFile;
+    command->args.transfer.imageInfo = outImageInfo;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_GetCameraSettingsFile(AwCommandQueue* self, MMemIO* outFile, const AwCommandOptions* options,
+                                              AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_TRANSFER, RunGetCameraSettingsFile, NULL);
+    command->args.transfer.file = outFile;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+AwResult AwCommandQueue_PutCameraSettingsFile(AwCommandQueue* self, MMemIO* file, const AwCommandOptions* options,
+                                              AwCommand** outCommand) {
+    AwCommand* command = NewCommand(self, AW_PRIORITY_TRANSFER, RunPutCameraSettingsFile, NULL);
+    command->args.transfer.file = file;
+    return SubmitCommand(self, command, options, outCommand);
+}
+
+void AwCommandQueue_GetStats(AwCommandQueue* self, AwCommandQueueStats* outStats) {
+    if (!self->thread) {
+        *outStats = self->stats;
+        return;
+    }
+    Lock(self->thread);
+    *outStats = self->stats;
+    Unlock(self->thread);
+}
+
+b32 AwCommand_Wait(AwCommand* command, int timeoutMilliseconds, AwResult* outResult) {
+    if (ATOMIC_LOAD_U32(&command->state) != AW_COMMAND_DONE) {
+        AwCommandThread* thread = command->thread;
+        u64 deadline = MGetTimeMilliseconds() + (timeoutMilliseconds > 0 ? timeoutMilliseconds : 0);
+        Lock(thread);
+        while (command->state != AW_COMMAND_DONE) {
+            if (timeoutMilliseconds < 0) {
+                CondWait(thread, &thread->doneCond);
+                continue;
+            }
+            u64 now = MGetTimeMilliseconds();
+            if (now >= deadline) {
+                break;
+            }
+            CondWaitMs(thread, &thread->doneCond, (u32)(deadline - now));
+        }
+        Unlock(thread);
+    }
+
+    if (ATOMIC_LOAD_U32(&command->state) != AW_COMMAND_DONE) {
+        return FALSE;
+    }
+    if (outResult) {
+        *outResult = command->result;
+    }
+    return TRUE;
+}
+
+b32 AwCommand_IsDone(AwCommand* command) {
+    return ATOMIC_LOAD_U32(&command->state) == AW_COMMAND_DONE;
+}
+
+b32 AwCommand_Cancel(AwCommand* command) {
+    if (ATOMIC_LOAD_U32(&command->state) == AW_COMMAND_DONE) {
+        return FALSE;
+    }
+    AwCommandQueue* self = command->queue;
+    AwCommandThread* thread = command->thread;
+    b32 removed = FALSE;
+    Lock(thread);
+    if (command->state == AW_COMMAND_QUEUED) {
+        // Unlink from its class, commands only leave the queue under the lock
+        int priority = command->priority;
+        AwCommand* prev = NULL;
+        for (AwCommand* it = self->heads[priority]; it; prev = it, it = it->next) {
+            if (it == command) {
+                if (prev) {
+                    prev->next = command->next;
+                } else {
+                    self->heads[priority] = command->next;
+                }
+                if (self->tails[priority] == command) {
+                    self->tails[priority] = prev;
+                }
+                command->next = NULL;
+                self->stats.classes[priority].queued--;
+                CompleteCommand(self, command, (AwResult){.code = AW_RESULT_CANCELLED});
+                removed = TRUE;
+                break;
+            }
+        }
+    } else if (command->state == AW_COMMAND_RUNNING) {
+        CancelRunning(self, command);
+    }
+    Unlock(thread);
+    if (removed) {
+        RunCompletions(self, thread);
+    }
+    return removed;
+}
+
+b32 AwCommand_IsCancelRequested(AwCommand* command) {
+    return ATOMIC_LOAD_U32(&command->cancelRequested);
+}
+
+void AwCommand_Release(AwCommand* command) {
+    if (command) {
+        FreeCommandRef(command, command->queue->control->allocator);
+    }
+}
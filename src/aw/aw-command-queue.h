@@ -0,0 +1,284 @@
+﻿#pragma once
+
+#include "mlib/mlib.h"
+
+#include "aw/aw-const.h"
+#include "aw/aw-control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Command priority classes, lower values run first.  Commands within a class run in submission order.
+ */
+typedef enum {
+    AW_PRIORITY_CAPTURE,      // Shutter, AF and other time critical controls, preempt a running sheddable command
+    AW_PRIORITY_PROPERTY_SET, // Property sets and other controls
+    AW_PRIORITY_TRANSFER,     // Image downloads and camera settings files
+    AW_PRIORITY_REFRESH,      // Property refresh polling, sheddable
+    AW_PRIORITY_LIVE_VIEW,    // Live view polling, sheddable
+    AW_PRIORITY_COUNT,
+} AwCommandPriority;
+
+#define AW_PRIORITY_SHEDDABLE AW_PRIORITY_REFRESH // Classes from here on are polling and may be shed under load
+
+typedef AwResult (*AwCommandFunc)(AwControl* control, void* userData);
+
+struct AwCommand;
+struct AwCommandThread;
+
+/**
+ * Completion callback, called once per command on whichever thread completed it: the worker thread, or the thread
+ * that shed, cancelled or stopped it.  No queue lock is held, so the callback may submit more commands.
+ * The command's result is valid, the command itself is only valid for the duration of the call unless the
+ * submitter kept a reference.
+ */
+typedef void (*AwCommandCallback)(struct AwCommand* command, void* callbackData);
+
+/**
+ * Optional per command settings, pass NULL for none.
+ */
+typedef struct AwCommandOptions {
+    // Max time from submission, 0 for no limit.  A command that hasn't started by then completes with AW_RESULT_TIMEOUT
+    // when the worker next picks a command, without running.  A running command's transaction is cancelled with
+    // AwControl_CancelTransactionForToken(), and it completes with AW_RESULT_TIMEOUT if that stopped it.
+    u32 timeoutMilliseconds;
+    AwCommandCallback onComplete;
+    void* callbackData;
+} AwCommandOptions;
+
+typedef enum {
+    AW_COMMAND_QUEUED,
+    AW_COMMAND_RUNNING,
+    AW_COMMAND_DONE,
+} AwCommandState;
+
+/**
+ * A submitted command, see AwCommand_Wait() and AwCommand_Release().
+ */
+typedef struct AwCommand {
+    AwCommandFunc run;
+    void* userData;
+    AwCommandPriority priority;
+    AwCommandState state; // Guarded by the queue lock
+    AwResult result; // Valid once state is AW_COMMAND_DONE, AW_RESULT_CANCELLED if shed or the queue was stopped
+    u64 submitTimeUs; // MGetTimeMicroseconds() at submission
+    u64 deadlineUs; // MGetTimeMicroseconds() deadline to finish by, 0 for none
+    u32 cancelRequested; // Set by AwCommand_Cancel() or the deadline while running, see AwCommand_IsCancelRequested()
+    b32 deadlinePassed; // Cancelled for running past deadlineUs, guarded by the queue lock
+    u32 transportToken; // AwControl_GetTransportToken() while running, 0 when not holding the transport
+    AwCommandCallback onComplete;
+    void* callbackData;
+    u32 refCount; // Queue + caller, guarded by the queue lock
+    struct AwCommandQueue* queue;
+    struct AwCommandThread* thread; // Queue thread state, kept alive until the command is freed
+    struct AwCommand* next;
+    // Arguments of the built-in commands
+    union {
+        struct {
+            u16 code;
+            AwPtpPropValue value;
+        } set;
+        b32 fullRefresh;
+        struct {
+            MMemIO* jpeg;
+            AwLiveViewFrames* frames;
+        } liveView;
+        struct {
+            MMemIO* file;
+            AwPtpCapturedImageInfo* imageInfo;
+        } transfer;
+    } args;
+} AwCommand;
+
+typedef struct AwCommandClassStats {
+    u32 submitted;
+    u32 completed; // Ran to completion, whatever the result
+    u32 shed; // Dropped under load, or superseded by a newer command of the same class
+    u32 queued; // Currently waiting
+    u32 lastWaitUs; // Submission to start time of the most recent command
+    u32 maxWaitUs;
+    u64 totalWaitUs; // Sum over all started commands, divide by completed for the average
+} AwCommandClassStats;
+
+typedef struct AwCommandQueueStats {
+    AwCommandClassStats classes[AW_PRIORITY_COUNT];
+} AwCommandQueueStats;
+
+/**
+ * Load shedding limits for the sheddable classes, indexed by AwCommandPriority.  Zero entries use the defaults.
+ */
+typedef struct AwCommandQueueConfig {
+    // Max commands waiting in a class, submitting more sheds the oldest (the newer poll has fresher results)
+    u32 maxQueued[AW_PRIORITY_COUNT];
+    // Commands that waited longer than this are shed instead of run, the caller will have polled again by then
+    u32 maxWaitMs[AW_PRIORITY_COUNT];
+} AwCommandQueueConfig;
+
+#define AW_COMMAND_QUEUE_MAX_QUEUED_DEFAULT 1
+#define AW_COMMAND_QUEUE_REFRESH_MAX_WAIT_MS_DEFAULT 1000
+#define AW_COMMAND_QUEUE_LIVE_VIEW_MAX_WAIT_MS_DEFAULT 200
+
+/**
+ * Per device command queue that owns the PTP session.  A worker thread runs one command at a time, always taking the
+ * highest priority command waiting, so a shutter press never sits behind a live view download or property refresh
+ * that hasn't started yet.  Scheduling is otherwise non-preemptive, except that submitting an AW_PRIORITY_CAPTURE
+ * command cancels a running sheddable command (see AwCommand_Cancel()) so it doesn't wait for that to finish.
+ *
+ * Any thread can submit commands.  Each command owns the transport while it runs, so other threads calling AwControl
+ * directly while the queue is running must do so between AwControl_AcquireTransport() / AwControl_ReleaseTransport().
+ *
+ * Submitting never blocks on the camera.  Completion is reported through a callback (AwCommandOptions), by polling
+ * AwCommand_IsDone(), or by waiting with AwCommand_Wait(), so a few threads can keep many cameras busy.
+ *
+ * @code{.c}
+ *    AwCommandQueue queue = {};
+ *    AwCommandQueue_Start(&queue, &aw, NULL);
+ *
+ *    // UI thread, each frame
+ *    AwCommandQueue_UpdateProperties(&queue, FALSE, NULL, NULL);
+ *
+ *    // Shutter button, jumps ahead of any queued polling
+ *    AwCommand* cmd = NULL;
+ *    AwCommandQueue_SetControlToggle(&queue, DPC_SHUTTER, TRUE, NULL, &cmd);
+ *    AwResult r = {};
+ *    AwCommand_Wait(cmd, 1000, &r);
+ *    AwCommand_Release(cmd);
+ *
+ *    // Download without blocking, OnImageDownloaded() is called on the worker thread
+ *    AwCommandOptions options = {.timeoutMilliseconds = 10000, .onComplete = OnImageDownloaded, .callbackData = cam};
+ *    AwCommandQueue_GetCapturedImage(&queue, &cam->file, &cam->imageInfo, &options, NULL);
+ *    ...
+ *    AwCommandQueue_Stop(&queue);
+ * @endcode
+ */
+typedef struct AwCommandQueue {
+    AwControl* control;
+    AwCommandQueueConfig config;
+    AwCommand* heads[AW_PRIORITY_COUNT]; // FIFO per class
+    AwCommand* tails[AW_PRIORITY_COUNT];
+    AwCommandQueueStats stats;
+    b32 running;
+    struct AwCommandThread* thread;
+} AwCommandQueue;
+
+/**
+ * Start the worker thread.
+ * @param config Optional shedding limits, NULL for the defaults
+ * @return AW_RESULT_NOT_SUPPORTED if threads can't be created on this platform
+ */
+AW_EXPORT AwResult AwCommandQueue_Start(AwCommandQueue* self, AwControl* control, AwCommandQueueConfig* config);
+
+/**
+ * Stop the worker thread.  Waits for the running command, commands still waiting complete with AW_RESULT_CANCELLED.
+ */
+AW_EXPORT void AwCommandQueue_Stop(AwCommandQueue* self);
+
+/**
+ * Queue a command to run on the worker thread.
+ * @param userData Passed to 'run', NULL passes the AwCommand itself (for AwCommand_IsCancelRequested())
+ * @param options Optional timeout and completion callback, NULL for none
+ * @param outCommand Optional, set to the command to poll, wait on or cancel, release it with AwCommand_Release().
+ *                   When NULL the command is fire and forget.
+ * @return AW_RESULT_CANCELLED if the queue isn't running
+ */
+AW_EXPORT AwResult AwCommandQueue_Submit(AwCommandQueue* self, AwCommandPriority priority, AwCommandFunc run,
+                                         void* userData, const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Submit a command and wait for it to finish.
+ */
+AW_EXPORT AwResult AwCommandQueue_Call(AwCommandQueue* self, AwCommandPriority priority, AwCommandFunc run,
+                                       void* userData);
+
+/**
+ * Queue the common AwControl operations.  Shutter and AF controls run at AW_PRIORITY_CAPTURE, other controls and
+ * property sets at AW_PRIORITY_PROPERTY_SET.  String values must stay valid until the command is done.
+ */
+AW_EXPORT AwResult AwCommandQueue_SetControlValue(AwCommandQueue* self, u16 controlCode, AwPtpPropValue value,
+                                                  const AwCommandOptions* options, AwCommand** outCommand);
+AW_EXPORT AwResult AwCommandQueue_SetControlToggle(AwCommandQueue* self, u16 controlCode, b32 pressed,
+                                                   const AwCommandOptions* options, AwCommand** outCommand);
+AW_EXPORT AwResult AwCommandQueue_SetPropertyValue(AwCommandQueue* self, u16 propCode, AwPtpPropValue value,
+                                                   const AwCommandOptions* options, AwCommand** outCommand);
+AW_EXPORT AwResult AwCommandQueue_RemoteButtonPress(AwCommandQueue* self, u16 button, b32 pressed,
+                                                    const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Queue a property refresh at AW_PRIORITY_REFRESH.  A refresh still waiting is superseded, keeping its fullRefresh.
+ */
+AW_EXPORT AwResult AwCommandQueue_UpdateProperties(AwCommandQueue* self, b32 fullRefresh,
+                                                   const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Queue a live view frame fetch at AW_PRIORITY_LIVE_VIEW, see AwControl_GetLiveViewImage().  outJpeg and
+ * outLiveViewFrames are written on the worker thread and must stay valid until the command is done.
+ */
+AW_EXPORT AwResult AwCommandQueue_GetLiveViewImage(AwCommandQueue* self, MMemIO* outJpeg,
+                                                   AwLiveViewFrames* outLiveViewFrames,
+                                                   const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Queue a captured image download at AW_PRIORITY_TRANSFER, see AwControl_GetCapturedImage().  outFile and
+ * outImageInfo are written on the worker thread and must stay valid until the command is done.
+ */
+AW_EXPORT AwResult AwCommandQueue_GetCapturedImage(AwCommandQueue* self, MMemIO* outFile,
+                                                   AwPtpCapturedImageInfo* outImageInfo,
+                                                   const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Queue a camera settings file read or write at AW_PRIORITY_TRANSFER, see AwControl_GetCameraSettingsFile() and
+ * AwControl_PutCameraSettingsFile().  The file must stay valid until the command is done.
+ */
+AW_EXPORT AwResult AwCommandQueue_GetCameraSettingsFile(AwCommandQueue* self, MMemIO* outFile,
+                                                        const AwCommandOptions* options, AwCommand** outCommand);
+AW_EXPORT AwResult AwCommandQueue_PutCameraSettingsFile(AwCommandQueue* self, MMemIO* file,
+                                                        const AwCommandOptions* options, AwCommand** outCommand);
+
+/**
+ * Priority class for a control code, AW_PRIORITY_CAPTURE for shutter and AF controls.
+ */
+AW_EXPORT AwCommandPriority AwCommandQueue_GetControlPriority(u16 controlCode);
+
+/**
+ * Snapshot of the per class counters, including the time commands spent waiting in the queue.
+ */
+AW_EXPORT void AwCommandQueue_GetStats(AwCommandQueue* self, AwCommandQueueStats* outStats);
+
+/**
+ * Wait for a command to finish.
+ * @param timeoutMilliseconds Max time to wait, -1 to wait forever
+ * @param outResult Optional, the command's result
+ * @return TRUE if the command finished
+ */
+AW_EXPORT b32 AwCommand_Wait(AwCommand* command, int timeoutMilliseconds, AwResult* outResult);
+
+/**
+ * Check if a command has finished without blocking, command->result is valid once it has.
+ */
+AW_EXPORT b32 AwCommand_IsDone(AwCommand* command);
+
+/**
+ * Cancel a command.  A command that hasn't started completes with AW_RESULT_CANCELLED without running.  A running
+ * command is asked to stop, see AwCommand_IsCancelRequested(), and its in-flight transaction is cancelled with
+ * AwControl_CancelTransactionForToken(), so a cancel that arrives as the command finishes never reaches the next
+ * command's transaction.  It completes with whatever result it returns, usually AW_RESULT_CANCELLED.
+ * @return TRUE if the command was removed from the queue before it ran
+ */
+AW_EXPORT b32 AwCommand_Cancel(AwCommand* command);
+
+/**
+ * For AwCommandFunc implementations that can stop early, TRUE once AwCommand_Cancel() was called on the running
+ * command.  Pass the AwCommand the func was submitted with (userData of the built-in commands).
+ */
+AW_EXPORT b32 AwCommand_IsCancelRequested(AwCommand* command);
+
+/**
+ * Release the caller's reference, the command keeps running if it hasn't finished.
+ */
+AW_EXPORT void AwCommand_Release(AwCommand* command);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
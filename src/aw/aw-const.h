@@ -487,6 +487,8 @@ typedef enum {
     AW_RESULT_PARAM_ERROR,
     AW_RESULT_NOT_SUPPORTED,
     AW_RESULT_DEVICE_INFO_FAILURE,
+    AW_RESULT_CANCELLED,
+    AW_RESULT_BUFFER_TOO_SMALL,
 } AwResultCode;
 
 typedef struct AwResult {
@@ -639,6 +641,9 @@ typedef struct {
     AwFocusFrameTracking* frames;
 } AwTrackingFrames;
 
+// Capacity of each of the AwLiveViewFrames arrays, further frames reported by the camera are skipped
+#define AW_LIVE_VIEW_FRAMES_MAX 128
+
 typedef struct {
     u16 version;
     AwFocusFrames focus;
@@ -691,6 +696,7 @@ typedef struct {
             u32 objectHandle;
         };
     };
+    u64 timestampMicroseconds; // MGetTimeMicroseconds() when the event was received, 0 if not recorded
 } AwPtpEvent;
 
 #define PTP_MAX_PARAMS 5
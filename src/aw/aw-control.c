@@ -7,6 +7,89 @@
 #include "aw/aw-control.h"
 #include "aw/aw-util.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+#define ATOMIC_ADD_FETCH_U32(p, v) ((u32)InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v)) + (v))
+#define ATOMIC_SUB_FETCH_U32(p, v) ((u32)InterlockedExchangeAdd((volatile LONG*)(p), -(LONG)(v)) - (v))
+#else
+#define ATOMIC_ADD_FETCH_U32(p, v) __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_SUB_FETCH_U32(p, v) __atomic_sub_fetch((p), (v), __ATOMIC_ACQ_REL)
+#endif
+
+// Transport ownership and property state lock, see 'Concurrency' in aw-control.h
+typedef struct AwControlSync {
+#ifdef _WIN32
+    SRWLOCK stateLock;
+    CRITICAL_SECTION transportLock;
+    CONDITION_VARIABLE transportCond;
+    CRITICAL_SECTION snapshotLock; // Only held to swap or take a reference to the current snapshot
+#else
+    pthread_rwlock_t stateLock;
+    pthread_mutex_t transportLock;
+    pthread_cond_t transportCond;
+    pthread_mutex_t snapshotLock;
+#endif
+    // Guarded by transportLock, only held to change ownership, never for the transfer
+    u32 transportDepth; // Nested AwControl_AcquireTransport() calls by the owner, 0 if not owned
+    u32 transportToken; // Changes each time a thread takes the transport, see AwControl_GetTransportToken()
+#ifdef _WIN32
+    DWORD transportOwner;
+#else
+    pthread_t transportOwner;
+#endif
+} AwControlSync;
+
+#ifdef _WIN32
+#define CurrentThreadOwnsTransport(sync) ((sync)->transportDepth && (sync)->transportOwner == GetCurrentThreadId())
+#else
+#define CurrentThreadOwnsTransport(sync) ((sync)->transportDepth && pthread_equal((sync)->transportOwner, pthread_self()))
+#endif
+
+static void StateLockExclusive(AwControl* self) {
+    if (!self->sync) {
+        return;
+    }
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&self->sync->stateLock);
+#else
+    pthread_rwlock_wrlock(&self->sync->stateLock);
+#endif
+}
+
+static void StateUnlockExclusive(AwControl* self) {
+    if (!self->sync) {
+        return;
+    }
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&self->sync->stateLock);
+#else
+    pthread_rwlock_unlock(&self->sync->stateLock);
+#endif
+}
+
+static void SnapshotLock(AwControlSync* sync) {
+#ifdef _WIN32
+    EnterCriticalSection(&sync->snapshotLock);
+#else
+    pthread_mutex_lock(&sync->snapshotLock);
+#endif
+}
+
+static void SnapshotUnlock(AwControlSync* sync) {
+#ifdef _WIN32
+    LeaveCriticalSection(&sync->snapshotLock);
+#else
+    pthread_mutex_unlock(&sync->snapshotLock);
+#endif
+}
+
 typedef struct {
     u8 value;
     char* str;
@@ -1695,131 +1778,112 @@ static MStr GetFocalDistanceMeters(AwControl* self, MAllocator* allocator, AwPtp
 
 static PTPPropertyMetadata sPropertyMetadata[] = {
     META_ENUM_U8 ("image-file-format", DPC_COMPRESSION_SETTING, sProp_CompressionSetting),
-    META_ENUM_U8 ("image-file-format", DPC_IMAGE_FILE_FORMAT, sProp_ImageFileFormat),
-    META_ENUM_U8 ("raw-file-type", DPC_RAW_FILE_TYPE, sProp_RawFileType),
-    META_ENUM_U8 ("compressed-file-type", DPC_IMAGE_COMPRESSED_FILE_TYPE, sProp_CompressedImageFileFormat),
-    META_ENUM_U8 ("image-quality", DPC_IMAGE_QUALITY, sProp_ImageQuality),
-    META_ENUM_U8 ("image-size", DPC_IMAGE_SIZE, sProp_ImageSize),
-    META_ENUM_U16("image-save-destination", DPC_IMAGE_SAVE_DESTINATION, sProp_PcRemoteSaveDest),
-    META_ENUM_U8 ("pc-save-image", DPC_PC_SAVE_IMAGE, sProp_PcSaveImage),
-    META_ENUM_U8 ("image-transfer-size", DPC_IMAGE_TRANSFER_SIZE, sProp_ImageTransferSize),
-
+    META_ENUM_U16("white-balance", DPC_WHITE_BALANCE, sProp_WhiteBalance),
+    META_FUNC_U16("f-number", DPC_F_NUMBER, GetFNumberAsString),
+    META_ENUM_U16("focus-mode", DPC_FOCUS_MODE, sProp_FocusMode),
+    META_ENUM_U16("exposure-metering-mode", DPC_EXPOSURE_METERING_MODE, sProp_ExposureMeteringMode),
+    META_ENUM_U16("flash-mode", DPC_FLASH_MODE, sProp_FlashMode),
     META_ENUM_U16("program-mode", DPC_EXPOSURE_PROGRAM_MODE, sProp_ExposureProgramMode16),
     META_ENUM_U32("program-mode", DPC_EXPOSURE_PROGRAM_MODE, sProp_ExposureProgramMode32),
-    META_ENUM_U8 ("dial-override", DPC_DIAL_MODE, sProp_DialOverride),
+    META_FUNC_I16("exposure-bias-compensation", DPC_EXPOSURE_COMPENSATION, GetExposureBiasAsString),
     META_ENUM_U16("capture-mode", DPC_CAPTURE_MODE, sProp_CaptureMode16),
     META_ENUM_U32("capture-mode", DPC_CAPTURE_MODE, sProp_CaptureMode32),
-    META_FUNC_U16("f-number", DPC_F_NUMBER, GetFNumberAsString),
-    META_FUNC_U32("shutter-speed", DPC_SHUTTER_SPEED, GetShutterSpeedAsString),
-    META_FUNC_U32("iso", DPC_ISO, GetIsoAsString),
-    META_FUNC_U32("iso-current", DPC_ISO_CURRENT, GetIsoAsString),
-    META_ENUM_U8 ("image-stabilization", DPC_IMAGE_STABILIZATION, sProp_OnOff1),
+    META_ENUM_U8 ("iris-mode", DPC_IRIS_MODE, sProp_IrisMode),
+    META_FUNC_U32("focal-distance-meters", DPC_FOCAL_DISTANCE_METER, GetFocalDistanceMeters),
     META_ENUM_U8 ("shutter-mode", DPC_SHUTTER_MODE, sProp_ShutterMode),
-    META_ENUM_U8 ("shutter-type", DPC_SHUTTER_TYPE, sProp_ShutterType),
     META_ENUM_U8 ("shutter-mode-setting", DPC_SHUTTER_MODE_SETTING, sProp_ShutterModeSetting),
+    META_ENUM_U8 ("gain-control", DPC_GAIN_CONTROL, sProp_GainControl),
+    META_FUNC_U32("iso-current", DPC_ISO_CURRENT, GetIsoAsString),
+    META_ENUM_U8 ("movie-format-proxy", DPC_MOVIE_FILE_FORMAT_PROXY, sProp_MovieFormat),
+    META_ENUM_U8 ("media-playback", DPC_PLAYBACK_MEDIA, sProp_MediaPlayback),
+    META_ENUM_U8 ("touch-operation", DPC_TOUCH_OPERATION, sProp_TouchOperation),
+    META_ENUM_U8 ("time-code-format", DPC_TIME_CODE_FORMAT, sProp_TimeCodeFormat),
+    META_ENUM_U8 ("image-stabilization", DPC_IMAGE_STABILIZATION, sProp_OnOff1),
     META_ENUM_U8 ("silent-mode", DPC_SILENT_MODE, sProp_OnOff1),
     META_ENUM_U8 ("silent-mode-aperture-drive-af", DPC_SILENT_MODE_APERTURE_DRIVE_AF, sProp_ApertureDriveAF),
     META_ENUM_U8 ("silent-mode-power-off", DPC_SILENT_MODE_POWER_OFF, sProp_SilentModePowerOff),
     META_ENUM_U8 ("silent-mode-auto-pixel-mapping", DPC_SILENT_MODE_AUTO_PIXEL_MAPPING, sProp_SilentModeAutoPixelMapping),
+    META_ENUM_U8 ("shutter-type", DPC_SHUTTER_TYPE, sProp_ShutterType),
+    META_ENUM_U16("creative-look", DPC_CREATIVE_LOOK, sProp_CreativeLook),
     META_ENUM_U8 ("shutter-release-timing", DPC_SHUTTER_RELEASE_TIMING, sProp_ShutterReleaseTiming),
-
-    META_ENUM_U8 ("aspect-ratio", DPC_ASPECT_RATIO, sProp_AspectRatio),
-    META_ENUM_U8 ("iris-mode", DPC_IRIS_MODE, sProp_IrisMode),
-
-    META_ENUM_U16("white-balance", DPC_WHITE_BALANCE, sProp_WhiteBalance),
+    META_FUNC_I16("flash-compensation", DPC_FLASH_COMPENSATION, GetFlashCompAsString),
+    META_ENUM_U8 ("dro-hdr-mode", DPC_DRO_HDR_MODE, sProp_DRO),
+    META_ENUM_U8 ("image-size", DPC_IMAGE_SIZE, sProp_ImageSize),
+    META_ENUM_U8 ("osd-image-mode", DPC_OSD_IMAGE_MODE, sProp_OnOff0),
+    META_ENUM_U16("button-list", DPC_BUTTON_LIST, sProp_ButtonList),
+    META_ENUM_U16("button-list-multi", DPC_BUTTON_LIST_MULTI, sProp_ButtonList),
+    META_ENUM_U16("dial-list", DPC_DIAL_LIST, sProp_DialList),
+    META_FUNC_U32("shutter-speed", DPC_SHUTTER_SPEED, GetShutterSpeedAsString),
+    META_ENUM_U8 ("battery-level", DPC_BATTERY_LEVEL, sProp_BatteryLevel),
     META_FUNC_U16("white-balance-custom-temp", DPC_CUSTOM_COLOR_TEMP, GetCustomColorTempAsString),
     META_FUNC_U8 ("white-balance-gm", DPC_WHITE_BALANCE_GM, GetWhiteBalanceGMAsString),
+    META_ENUM_U8 ("aspect-ratio", DPC_ASPECT_RATIO, sProp_AspectRatio),
+    META_ENUM_U8 ("auto-focus-status", DPC_AUTO_FOCUS_STATUS, sProp_AutoFocusStatus),
+    META_FUNC_U32("predicted-max-file-size", DPC_PREDICTED_MAX_FILE_SIZE, GetPredictedMaxFileSizeAsString),
+    META_FUNC_U16("pending-files", DPC_PENDING_FILES, GetPendingFileInfoAsString),
+    META_ENUM_U8 ("ae-lock-satus", DPC_AE_LOCK_STATUS, sProp_LockedUnlocked),
+    META_FUNC_I8 ("battery-remaining", DPC_BATTERY_REMAINING, GetBatteryRemainingAsString),
+    META_ENUM_U16("picture-effect", DPC_PICTURE_EFFECT, sProp_PictureEffect),
     META_FUNC_U8 ("white-balance-ab", DPC_WHITE_BALANCE_AB, GetWhiteBalanceABAsString),
-
-    META_ENUM_U8 ("gain-control", DPC_GAIN_CONTROL, sProp_GainControl),
-    META_ENUM_U16("exposure-metering-mode", DPC_EXPOSURE_METERING_MODE, sProp_ExposureMeteringMode),
-    META_FUNC_I16("exposure-bias-compensation", DPC_EXPOSURE_COMPENSATION, GetExposureBiasAsString),
-    META_ENUM_U8 ("dro-hdr-mode", DPC_DRO_HDR_MODE, sProp_DRO),
-
-    META_ENUM_U8 ("awb-lock-satus", DPC_AWB_LOCK_STATUS, sProp_LockedUnlocked),
+    META_ENUM_U8 ("movie-recording-state", DPC_MOVIE_REC_STATE, sProp_MovieRecState),
+    META_FUNC_U32("iso", DPC_ISO, GetIsoAsString),
     META_ENUM_U8 ("fel-lock-satus", DPC_FEL_LOCK_STATUS, sProp_LockedUnlocked),
-    META_ENUM_U8 ("ae-lock-satus", DPC_AE_LOCK_STATUS, sProp_LockedUnlocked),
-
-    META_ENUM_U16("focus-mode", DPC_FOCUS_MODE, sProp_FocusMode),
+    META_ENUM_U8 ("live-view-status", DPC_LIVE_VIEW_STATUS, sProp_LiveViewStatus),
+    META_ENUM_U16("image-save-destination", DPC_IMAGE_SAVE_DESTINATION, sProp_PcRemoteSaveDest),
     META_ENUM_U16("focus-area", DPC_FOCUS_AREA, sProp_FocusArea),
-    META_ENUM_U8 ("manual-focus-adjust-enabled", DPC_MANUAL_FOCUS_ADJUST_ENABLED, sProp_EnabledDisabled),
-    META_ENUM_U8 ("af-tracking-sens", DPC_AF_TRACKING_SENS, sProp_AFTrackingSensitivity),
-    META_ENUM_U8 ("auto-focus-status", DPC_AUTO_FOCUS_STATUS, sProp_AutoFocusStatus),
     META_FUNC_U16("focus-magnify-scale", DPC_FOCUS_MAGNIFY_SCALE, GetFocusMagnifyScale),
     META_FUNC_U32("focus-magnify-pos", DPC_FOCUS_MAGNIFY_POS, GetFocusMagnifyPos),
-    META_FUNC_U64("focus-magnify", DPC_FOCUS_MAGNIFY, GetFocusMagnify),
+    META_ENUM_U8 ("live-view-setting-effect", DPC_LIVE_VIEW_SETTING_EFFECT, sProp_LiveViewSettingEffect),
     META_FUNC_U32("focus-spot-pos", DPC_FOCUS_AREA_POS_OLD, GetFocusSpotPos),
-    META_FUNC_U8("focus-position", DPC_FOCUS_POSITION, NULL),
-    META_FUNC_U16("focus-position-abs", DPC_FOCUS_POSITION_ABS, NULL),
-    META_FUNC_U32("focal-distance-meters", DPC_FOCAL_DISTANCE_METER, GetFocalDistanceMeters),
-
-    META_ENUM_U16("flash-mode", DPC_FLASH_MODE, sProp_FlashMode),
-    META_ENUM_U8 ("wireless-flash", DPC_WIRELESS_FLASH, sProp_OnOff0),
-    META_ENUM_U8 ("red-eye-reduction", DPC_RED_EYE_REDUCTION, sProp_OnOff0),
-    META_FUNC_I16("flash-compensation", DPC_FLASH_COMPENSATION, GetFlashCompAsString),
-
-    META_ENUM_U16("picture-effect", DPC_PICTURE_EFFECT, sProp_PictureEffect),
+    META_ENUM_U8 ("manual-focus-adjust-enabled", DPC_MANUAL_FOCUS_ADJUST_ENABLED, sProp_EnabledDisabled),
+    META_ENUM_U8 ("pixel-shift-shooting-mode", DPC_PIXEL_SHIFT_SHOOTING_MODE, sProp_PixelShiftShootingMode),
+    META_FUNC_U16("pixel-shift-shooting-number", DPC_PIXEL_SHIFT_SHOOTING_NUMBER, GetPixelShootingNumberAsString),
+    META_FUNC_U16("pixel-shift-shooting-interval", DPC_PIXEL_SHIFT_SHOOTING_INTERVAL, GetPixelShootingIntervalAsString),
+    META_ENUM_U8 ("pixel-shift-shooting-status", DPC_PIXEL_SHIFT_SHOOTING_STATUS, sProp_PixelShiftShootingStatus),
+    META_FUNC_U16("pixel-shift-shooting-status", DPC_PIXEL_SHIFT_SHOOTING_PROGRESS, GetPixelShootingProgressAsString),
     META_ENUM_U8 ("picture-profile", DPC_PICTURE_PROFILE, sProp_PictureProfile),
     META_ENUM_U8 ("creative-style", DPC_CREATIVE_STYLE, sProp_CreativeStyle),
-    META_ENUM_U16("creative-look", DPC_CREATIVE_LOOK, sProp_CreativeLook),
-
     META_ENUM_U8 ("movie-format", DPC_MOVIE_FILE_FORMAT, sProp_MovieFormat),
-    META_ENUM_U8 ("movie-format-proxy", DPC_MOVIE_FILE_FORMAT_PROXY, sProp_MovieFormat),
     META_ENUM_U16("movie-quality", DPC_MOVIE_QUALITY, sProp_MovieQuality),
-    META_ENUM_U8 ("movie-recording-state", DPC_MOVIE_REC_STATE, sProp_MovieRecState),
-    META_ENUM_U8 ("movie-frame-rate", DPC_MOVIE_FRAME_RATE, sProp_MovieFrameRate),
-
+    META_ENUM_U8 ("media-slot1-status", DPC_MEDIA_SLOT1_STATUS, sProp_MediaSlotStatus),
+    META_FUNC_U8("focus-position", DPC_FOCUS_POSITION, NULL),
+    META_ENUM_U8 ("awb-lock-satus", DPC_AWB_LOCK_STATUS, sProp_LockedUnlocked),
     META_ENUM_U8 ("interval-record-mode", DPC_INTERVAL_RECORD_MODE, sProp_OnOff1),
     META_ENUM_U8 ("interval-record-status", DPC_INTERVAL_RECORD_STATUS, sProp_IntervalRecStatus),
-
-    META_ENUM_U8 ("media-playback", DPC_PLAYBACK_MEDIA, sProp_MediaPlayback),
-    META_ENUM_U8 ("media-slot1-status", DPC_MEDIA_SLOT1_STATUS, sProp_MediaSlotStatus),
+    META_ENUM_U8 ("device-overheating-state", DPC_DEVICE_OVERHEATING_STATE, sProp_DeviceOverheatingState),
+    META_ENUM_U8 ("image-quality", DPC_IMAGE_QUALITY, sProp_ImageQuality),
+    META_ENUM_U8 ("image-file-format", DPC_IMAGE_FILE_FORMAT, sProp_ImageFileFormat),
+    META_FUNC_U64("focus-magnify", DPC_FOCUS_MAGNIFY, GetFocusMagnify),
+    META_ENUM_U8 ("af-tracking-sens", DPC_AF_TRACKING_SENS, sProp_AFTrackingSensitivity),
     META_ENUM_U8 ("media-slot2-status", DPC_MEDIA_SLOT2_STATUS, sProp_MediaSlotStatus),
+    META_ENUM_U8 ("dial-override", DPC_DIAL_MODE, sProp_DialOverride),
+    META_ENUM_U8 ("zoom-operation-enabled", DPC_ZOOM_OPERATION_ENABLED, sProp_EnabledDisabled),
+    META_FUNC_U32("zoom-scale", DPC_ZOOM_SCALE, GetZoomScale),
+    META_FUNC_U32("zoom-bar-info", DPC_ZOOM_BAR_INFO, GetZoomBarInfo),
+    META_ENUM_U8 ("zoom-setting", DPC_ZOOM_SETTING, sProp_ZoomSetting),
+    META_ENUM_U8 ("zoom-type-status", DPC_ZOOM_TYPE_STATUS, sProp_ZoomSetting),
+    META_ENUM_U8 ("wireless-flash", DPC_WIRELESS_FLASH, sProp_OnOff0),
+    META_ENUM_U8 ("red-eye-reduction", DPC_RED_EYE_REDUCTION, sProp_OnOff0),
+    META_ENUM_U8 ("remote-restrict-status", DPC_REMOTE_RESTRICT_STATUS, sProp_EnabledDisabled),
+    META_ENUM_U8 ("image-transfer-size", DPC_IMAGE_TRANSFER_SIZE, sProp_ImageTransferSize),
+    META_ENUM_U8 ("pc-save-image", DPC_PC_SAVE_IMAGE, sProp_PcSaveImage),
+    META_ENUM_U8 ("live-view-quality", DPC_LIVE_VIEW_QUALITY, sProp_LiveViewImageQuality),
+    META_ENUM_U8 ("camera-settings-save-enabled", DPC_CAMERA_SETTING_SAVE_ENABLED, sProp_EnabledDisabled),
+    META_ENUM_U8 ("camera-settings-read-enabled", DPC_CAMERA_SETTING_READ_ENABLED, sProp_EnabledDisabled),
     META_ENUM_U8 ("format-media-slot1-enabled", DPC_FORMAT_MEDIA_SLOT1_ENABLED, sProp_EnabledDisabled),
     META_ENUM_U8 ("format-media-slot2-enabled", DPC_FORMAT_MEDIA_SLOT2_ENABLED, sProp_EnabledDisabled),
+    META_ENUM_U8 ("touch-focus-operation", DPC_TOUCH_FOCUS_OPERATION, sProp_TouchFocusOperation),
+    META_ENUM_U8 ("remote-touch-enabled", DPC_REMOTE_TOUCH_ENABLED, sProp_EnabledDisabled),
+    META_ENUM_U8 ("remote-touch-cancel-enabled", DPC_REMOTE_TOUCH_CANCEL_ENABLED, sProp_EnabledDisabled),
+    META_ENUM_U8 ("movie-frame-rate", DPC_MOVIE_FRAME_RATE, sProp_MovieFrameRate),
+    META_ENUM_U8 ("compressed-file-type", DPC_IMAGE_COMPRESSED_FILE_TYPE, sProp_CompressedImageFileFormat),
+    META_ENUM_U8 ("raw-file-type", DPC_RAW_FILE_TYPE, sProp_RawFileType),
     META_ENUM_U8 ("format-media-quick-slot1-enabled", DPC_FORMAT_MEDIA_QUICK_SLOT1_ENABLED, sProp_EnabledDisabled),
     META_ENUM_U8 ("format-media-quick-slot1-enabled", DPC_FORMAT_MEDIA_QUICK_SLOT2_ENABLED, sProp_EnabledDisabled),
     META_ENUM_U8 ("format-media-cancel-enabled", DPC_FORMAT_MEDIA_CANCEL_ENABLED, sProp_EnabledDisabled),
-
     META_ENUM_U8 ("contents-transfer-enabled", DPC_CONTENTS_TRANSFER_ENABLED, sProp_EnabledDisabled),
-
-    META_ENUM_U8 ("live-view-quality", DPC_LIVE_VIEW_QUALITY, sProp_LiveViewImageQuality),
-    META_ENUM_U8 ("live-view-status", DPC_LIVE_VIEW_STATUS, sProp_LiveViewStatus),
-    META_ENUM_U8 ("live-view-setting-effect", DPC_LIVE_VIEW_SETTING_EFFECT, sProp_LiveViewSettingEffect),
-    META_ENUM_U8 ("osd-image-mode", DPC_OSD_IMAGE_MODE, sProp_OnOff0),
-
-    META_FUNC_I8 ("battery-remaining", DPC_BATTERY_REMAINING, GetBatteryRemainingAsString),
-    META_ENUM_U8 ("battery-level", DPC_BATTERY_LEVEL, sProp_BatteryLevel),
-    META_ENUM_U8 ("device-overheating-state", DPC_DEVICE_OVERHEATING_STATE, sProp_DeviceOverheatingState),
-    META_ENUM_U8 ("touch-operation", DPC_TOUCH_OPERATION, sProp_TouchOperation),
-    META_ENUM_U8 ("touch-focus-operation", DPC_TOUCH_FOCUS_OPERATION, sProp_TouchFocusOperation),
-    META_ENUM_U8 ("remote-touch-enabled", DPC_REMOTE_TOUCH_ENABLED, sProp_EnabledDisabled),
-    META_ENUM_U8 ("remote-touch-cancel-enabled", DPC_REMOTE_TOUCH_CANCEL_ENABLED, sProp_EnabledDisabled),
-    META_ENUM_U8 ("time-code-format", DPC_TIME_CODE_FORMAT, sProp_TimeCodeFormat),
-    META_FUNC_U32("predicted-max-file-size", DPC_PREDICTED_MAX_FILE_SIZE, GetPredictedMaxFileSizeAsString),
-    META_FUNC_U16("pending-files", DPC_PENDING_FILES, GetPendingFileInfoAsString),
-
-    META_ENUM_U8 ("pixel-shift-shooting-mode", DPC_PIXEL_SHIFT_SHOOTING_MODE, sProp_PixelShiftShootingMode),
-    META_FUNC_U16("pixel-shift-shooting-number", DPC_PIXEL_SHIFT_SHOOTING_NUMBER, GetPixelShootingNumberAsString),
-    META_FUNC_U16("pixel-shift-shooting-interval", DPC_PIXEL_SHIFT_SHOOTING_INTERVAL, GetPixelShootingIntervalAsString),
-    META_ENUM_U8 ("pixel-shift-shooting-status", DPC_PIXEL_SHIFT_SHOOTING_STATUS, sProp_PixelShiftShootingStatus),
-    META_FUNC_U16("pixel-shift-shooting-status", DPC_PIXEL_SHIFT_SHOOTING_PROGRESS, GetPixelShootingProgressAsString),
-
-    META_ENUM_U8 ("zoom-operation-enabled", DPC_ZOOM_OPERATION_ENABLED, sProp_EnabledDisabled),
-    META_ENUM_U8 ("zoom-setting", DPC_ZOOM_SETTING, sProp_ZoomSetting),
-    META_ENUM_U8 ("zoom-type-status", DPC_ZOOM_TYPE_STATUS, sProp_ZoomSetting),
-    META_FUNC_U32("zoom-scale", DPC_ZOOM_SCALE, GetZoomScale),
-    META_FUNC_U32("zoom-bar-info", DPC_ZOOM_BAR_INFO, GetZoomBarInfo),
-
-    META_ENUM_U8 ("remote-restrict-status", DPC_REMOTE_RESTRICT_STATUS, sProp_EnabledDisabled),
-    META_ENUM_U16("button-list", DPC_BUTTON_LIST, sProp_ButtonList),
-    META_ENUM_U16("button-list-multi", DPC_BUTTON_LIST_MULTI, sProp_ButtonList),
-    META_ENUM_U16("dial-list", DPC_DIAL_LIST, sProp_DialList),
-
+    META_FUNC_U16("focus-position-abs", DPC_FOCUS_POSITION_ABS, NULL),
     META_ENUM_U8 ("lens-info-enabled", DPC_LENS_INFORMATION_ENABLED, sProp_EnabledDisabled),
-
-    META_ENUM_U8 ("camera-settings-save-enabled", DPC_CAMERA_SETTING_SAVE_ENABLED, sProp_EnabledDisabled),
-    META_ENUM_U8 ("camera-settings-read-enabled", DPC_CAMERA_SETTING_READ_ENABLED, sProp_EnabledDisabled),
 };
 
 static PtpPropNames sPtpPropertyLabels[] = {
@@ -1847,9 +1911,9 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD00D, "White Balance Tint"},
     {0xD00E, "Shutter Angle"},
     {DPC_SHUTTER_SETTING, "Shutter Setting"},
-    {DPC_SHUTTER_ELECTRONIC_MODE, "Electronic Shutter Mode"},
     {DPC_SHUTTER_MODE, "Shutter Mode"},
     {DPC_SHUTTER_MODE_STATUS, "Shutter Mode Status"},
+    {DPC_SHUTTER_ELECTRONIC_MODE, "Electronic Shutter Mode"},
     {DPC_SHUTTER_MODE_SETTING, "Shutter Mode Setting"},
     {DPC_SHUTTER_SLOW, "Shutter Slow"},
     {DPC_SHUTTER_SLOW_FRAMES, "Shutter Slow Frames"},
@@ -2091,10 +2155,32 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD144, "Paint/Look Multi Matrix Hue"},
     {0xD145, "Paint/Look Multi Matrix Saturation"},
     {0xD14A, "FTP Transfer Still Quality Size"},
+    {0xD14B, "FTP Transfer Target (Proxy)"},
+    {0xD14C, "FTP Power Save"},
+    {0xD14D, "ISO Auto Min Shutter Speed Mode"},
+    {0xD14E, "ND Filter Unit Setting"},
+    {0xD14F, "ND Filter Optical Density Value"},
+    {0xD150, "USB Power Supply"},
+    {0xD151, "Interval REC (Movie) Frame Rate"},
+    {0xD152, "Interval REC (Movie) Record Setting"},
+    {0xD153, "E-framing Recording Image Crop"},
+    {0xD154, "E-framing HDMI Crop"},
+    {0xD155, "Synchroterminal Forced Output"},
+    {DPC_SHUTTER_RELEASE_TIMING, "Shutter Release Timing"},
+    {0xD157, "Subject Recognition in AF"},
+    {0xD158, "Recognition Target"},
+    {0xD159, "Right/Left Eye Select"},
     {0xD15B, "Long Exposure NR"},
     {0xD15C, "High ISO NR"},
     {0xD15D, "HLG Image"},
     {0xD15E, "Color Space Image"},
+    {0xD15F, "Recording Media - Image"},
+    {0xD160, "Recording Media - Movie"},
+    {0xD161, "Auto Switch Media"},
+    {0xD162, "Continuous Shooting Speed in Electric Shutter(Hi+)"},
+    {0xD163, "Continuous Shooting Speed in Electric Shutter(Hi)"},
+    {0xD164, "Continuous Shooting Speed in Electric Shutter(Mid)"},
+    {0xD165, "Continuous Shooting Speed in Electric Shutter(Lo)"},
     {0xD166, "Bracket order"},
     {0xD167, "Focus Bracket order"},
     {0xD168, "Focus Bracket Exposure Lock 1st Img"},
@@ -2109,7 +2195,6 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD171, "Wind Noise Reduction"},
     {0xD172, "Audio Level Display"},
     {0xD173, "Auto Slow Shutter"},
-    {0xD14D, "ISO Auto Min Shutter Speed Mode"},
     {0xD176, "ISO Auto Min Shutter Speed Manual"},
     {0xD177, "ISO Auto Min Shutter Speed Preset"},
     {0xD178, "Soft Skin Effect"},
@@ -2138,10 +2223,16 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD191, "Media Slot 3 ProfileUrl"},
     {0xD192, "Image Stabilization Steady Shot Adjust"},
     {0xD193, "Image Stabilization Steady Shot Focal Length"},
+    {0xD194, "Camera Shake Status"},
+    {0xD195, "Update Body Status"},
     {0xD196, "Embed LUT File"},
+    {0xD197, "Media Slot 1 Writing State"},
+    {0xD198, "Media Slot 2 Writing State"},
     {0xD199, "Auto FTP Transfer Target (Movie)"},
     {0xD19A, "FTP Transfer Target"},
     {0xD19B, "TimeShift Shooting Status"},
+    {0xD19C, "Focus Driving Status (Absolute)"},
+    {0xD19D, "Zoom Driving Status (Absolute)"},
     {0xD19E, "Default AF Free Size and Position Setting"},
     {0xD19F, "Extended Shutter Speed"},
     {0xD1A2, "Lens Compensation Shading"},
@@ -2164,33 +2255,6 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD1B3, "Anti-dust Shutter When Power Off"},
     {0xD1B4, "Shooting Self-timer Status"},
     {0xD1B5, "Metered Manual Level"},
-    {0xD14B, "FTP Transfer Target (Proxy)"},
-    {0xD14C, "FTP Power Save"},
-    {0xD14E, "ND Filter Unit Setting"},
-    {0xD14F, "ND Filter Optical Density Value"},
-    {0xD150, "USB Power Supply"},
-    {0xD151, "Interval REC (Movie) Frame Rate"},
-    {0xD152, "Interval REC (Movie) Record Setting"},
-    {0xD153, "E-framing Recording Image Crop"},
-    {0xD154, "E-framing HDMI Crop"},
-    {0xD157, "Subject Recognition in AF"},
-    {0xD158, "Recognition Target"},
-    {0xD155, "Synchroterminal Forced Output"},
-    {DPC_SHUTTER_RELEASE_TIMING, "Shutter Release Timing"},
-    {0xD159, "Right/Left Eye Select"},
-    {0xD15F, "Recording Media - Image"},
-    {0xD160, "Recording Media - Movie"},
-    {0xD161, "Auto Switch Media"},
-    {0xD162, "Continuous Shooting Speed in Electric Shutter(Hi+)"},
-    {0xD163, "Continuous Shooting Speed in Electric Shutter(Hi)"},
-    {0xD164, "Continuous Shooting Speed in Electric Shutter(Mid)"},
-    {0xD165, "Continuous Shooting Speed in Electric Shutter(Lo)"},
-    {0xD194, "Camera Shake Status"},
-    {0xD195, "Update Body Status"},
-    {0xD197, "Media Slot 1 Writing State"},
-    {0xD198, "Media Slot 2 Writing State"},
-    {0xD19C, "Focus Driving Status (Absolute)"},
-    {0xD19D, "Zoom Driving Status (Absolute)"},
     {0xD1B6, "ISO Auto Range Limit (min)"},
     {0xD1B7, "ISO Auto Range Limit (max)"},
     {0xD1B8, "Face/Eye Frame Display"},
@@ -2276,7 +2340,6 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {DPC_PREDICTED_MAX_FILE_SIZE, "Predicted Maximum File Size"},
     {0xD215, "Shooting File Info"},
     {0xD216, "Auto FTP Transfer Target (Still)"},
-    {DPC_PENDING_FILES, "Files Pending"},
     {DPC_AE_LOCK_STATUS, "AELock Indication"},
     {DPC_BATTERY_REMAINING, "Battery Remaining"},
     {DPC_PICTURE_EFFECT, "Picture Effect"},
@@ -2290,17 +2353,14 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD223, "Date/Time Setting"},
     {0xD225, "Protect Image in FTP Transfer"},
     {0xD229, "Auto Recognition Target Candidates"},
-    {DPC_IMAGE_SAVE_DESTINATION, "Image Save Destination"},
-    {DPC_DATE_TIME_SET, "Date/Time Set"},
     {DPC_FOCUS_AREA, "Focus Area"},
     {DPC_FOCUS_MAGNIFY_SCALE, "Focus Magnify Scale"},
     {DPC_FOCUS_MAGNIFY_POS, "Focus Magnify Position"},
     {DPC_LIVE_VIEW_SETTING_EFFECT, "Live View Display Effect"},
+    {DPC_FOCUS_AREA_POS_OLD, "Focus Area Position"},
     {0xD234, "Auto Recognition Target Setting"},
     {0xD235, "Near/Far Enable Status"},
     {0xD237, "Exposure Step"},
-    {DPC_FOCUS_AREA_POS_OLD, "Focus Area Position"},
-    {DPC_MANUAL_FOCUS_ADJUST_ENABLED, "Manual Focus Adjust Enabled"},
     {0xD239, "Pixel Shift Shooting Mode"},
     {0xD23A, "Pixel Shift Shooting Number"},
     {0xD23B, "Pixel Shift Shooting Interval"},
@@ -2310,15 +2370,6 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {0xD240, "Creative Style"},
     {0xD241, "File Format (Movie)"},
     {0xD242, "Recording Setting (Movie)"},
-    {DPC_PIXEL_SHIFT_SHOOTING_MODE, "Pixel Shift Shooting Mode"},
-    {DPC_PIXEL_SHIFT_SHOOTING_NUMBER, "Pixel Shift Shooting Shot Num"},
-    {DPC_PIXEL_SHIFT_SHOOTING_INTERVAL, "Pixel Shift Shooting Interval"},
-    {DPC_PIXEL_SHIFT_SHOOTING_STATUS, "Pixel Shift Shooting Status"},
-    {DPC_PIXEL_SHIFT_SHOOTING_PROGRESS, "Pixel Shift Shooting Progress"},
-    {DPC_PICTURE_PROFILE, "Picture Profile"},
-    {DPC_CREATIVE_STYLE, "Creative Style"},
-    {DPC_MOVIE_FILE_FORMAT, "Movie File Format"},
-    {DPC_MOVIE_QUALITY, "Movie Recording Setting"},
     {DPC_MEDIA_SLOT1_STATUS, "Media Slot 1 Status"},
     {0xD249, "Media Slot 1 Remaining Shots"},
     {0xD24A, "Media Slot 1 Remaining Record Time"},
@@ -2331,13 +2382,6 @@ static PtpPropNames sPtpPropertyLabels[] = {
     {DPC_IMAGE_FILE_FORMAT, "Image File Format"},
     {DPC_FOCUS_MAGNIFY, "Focus Magnifier"},
     {0xD255, "AF Tracking Sensitivity (Image)"},
-    {DPC_INTERVAL_RECORD_MODE, "Interval Record Mode"},
-    {DPC_INTERVAL_RECORD_STATUS, "Interval Record Status"},
-    {DPC_DEVICE_OVERHEATING_STATE, "Device Overheating State"},
-    {DPC_IMAGE_QUALITY, "Image Quality"},
-    {DPC_IMAGE_FILE_FORMAT, "Image File Format"},
-    {DPC_FOCUS_MAGNIFY, "Focus Magnifier"},
-    {DPC_AF_TRACKING_SENS, "AF Tracking Sensitivity"},
     {DPC_MEDIA_SLOT2_STATUS, "Media Slot 2 Status"},
     {0xD257, "Media Slot 2 Remaining Shots"},
     {0xD258, "Media Slot 2 Remaining Record Time"},
@@ -2624,7 +2668,7 @@ static PtpEventLabels sPtpEventLabels[] = {
     {0xC234, "SDIE_ContentInfoListChanged"},
     {0xC238, "SDIE_ControlPTZFResult"},
     {0xC239, "SDIE_PresetPTZFEvent"},
-    {0xC240, "SDIE_DeleteContentResult"}
+    {0xC240, "SDIE_DeleteContentResult"},
 };
 
 static AwPtpPropValueEnum sControl_UpDown[] = {
@@ -2666,9 +2710,8 @@ static AwPtpControl sAwControlsMetadata[] = {
     {DPC_FOCUS_STEP_NEAR,              PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Focus Step Near", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_FOCUS_STEP_FAR,               PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Focus Step Far", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_AWB_LOCK,                     PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "AWBL Button", PROP_ENUM_SET(sControl_UpDown)},
-    {DPC_FOCUS_AREA_X_Y,               PTP_DT_UINT32, SDI_CONTROL_NOTCH,    PTP_FORM_FLAG_RANGE, "AF Area Position (x, y)", .form.range={.min.u32=0,.max.u32=0xffffffff,.step.u32=1}},
     {0xD2DB,                           PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Reboot First Start", PROP_ENUM_SET(sControl_UpDown)},
-    {0xd2f6,                           PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Spot Boosting", PROP_ENUM_SET(sControl_UpDown)},
+    {DPC_FOCUS_AREA_X_Y,               PTP_DT_UINT32, SDI_CONTROL_NOTCH,    PTP_FORM_FLAG_RANGE, "AF Area Position (x, y)", .form.range={.min.u32=0,.max.u32=0xffffffff,.step.u32=1}},
     {DPC_ZOOM,                         PTP_DT_INT8,   SDI_CONTROL_VARIABLE, PTP_FORM_FLAG_RANGE, "Zoom Operation", .form.range={.min.i8=-1,.max.i8=1,.step.i8=1}},
     {DPC_CUSTOM_WB_CAPTURE_STANDBY,    PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Custom WB Capture Standby", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_CUSTOM_WB_CAPTURE_STANDBY_CANCEL, PTP_DT_UINT16, SDI_CONTROL_BUTTON, PTP_FORM_FLAG_ENUM, "Custom WB Capture Standby Cancel", PROP_ENUM_SET(sControl_UpDown)},
@@ -2686,6 +2729,7 @@ static AwPtpControl sAwControlsMetadata[] = {
     {DPC_FOCUS_OPERATION,              PTP_DT_INT8,   SDI_CONTROL_VARIABLE, PTP_FORM_FLAG_RANGE, "Focus Operation", .form.range={.min.i8=-1,.max.i8=1,.step.i8=1}},
     {DPC_FLICKER_SCAN,                 PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Flicker Scan", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_SETTINGS_RESET,               PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Settings Reset", PROP_ENUM_SET(sControl_UpDown)},
+    {0xd2f6,                           PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Spot Boosting", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_PIXEL_MAPPING,                PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Pixel Mapping", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_POWER_OFF,                    PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Power Off", PROP_ENUM_SET(sControl_UpDown)},
     { DPC_TIME_CODE_PRESET_RESET,       PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Time Code Preset Reset", PROP_ENUM_SET(sControl_UpDown)},
@@ -2693,42 +2737,82 @@ static AwPtpControl sAwControlsMetadata[] = {
     {DPC_SENSOR_CLEANING,              PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Sensor Cleaning", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_RESET_PICTURE_PROFILE,        PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Reset Picture Profile", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_RESET_CREATIVE_LOOK,          PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Reset Creative Look", PROP_ENUM_SET(sControl_UpDown)},
-    {DPC_SHUTTER_ECS_NUMBER_STEP,      PTP_DT_INT16,  SDI_CONTROL_NOTCH,    PTP_FORM_FLAG_ENUM,  "Shutter ECS Number Step", .form.range={.min.i16=I16_MIN,.max.i16=I16_MAX,.step.i16=1}},
-    {DPC_MOVIE_RECORD_TOGGLE,          PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Movie Record Toggle", PROP_ENUM_SET(sControl_UpDown)},
-    {DPC_FOCUS_POSITION_CANCEL,        PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Focus Position Cancel", PROP_ENUM_SET(sControl_UpDown)},
     {DPC_REMOTE_BUTTON,                PTP_DT_UINT32, SDI_CONTROL_VARIABLE, PTP_FORM_FLAG_RANGE,  "Remote Button", .form.range={.min.u32=0,.max.u32=0xffffffff,.step.u32=1}},
     {DPC_REMOTE_BUTTON_MULTI,          PTP_DT_UINT32, SDI_CONTROL_VARIABLE, PTP_FORM_FLAG_RANGE,  "Remote Button Multi", .form.range={.min.u32=0,.max.u32=0xffffffff,.step.u32=1}},
     {DPC_REMOTE_DIAL_ADJUST,           PTP_DT_INT32,  SDI_CONTROL_VARIABLE, PTP_FORM_FLAG_RANGE,  "Remote Dial Adjust", .form.range={.min.i32=I32_MIN,.max.i32=I32_MAX,.step.i32=1}},
+    {DPC_SHUTTER_ECS_NUMBER_STEP,      PTP_DT_INT16,  SDI_CONTROL_NOTCH,    PTP_FORM_FLAG_ENUM,  "Shutter ECS Number Step", .form.range={.min.i16=I16_MIN,.max.i16=I16_MAX,.step.i16=1}},
+    {DPC_MOVIE_RECORD_TOGGLE,          PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Movie Record Toggle", PROP_ENUM_SET(sControl_UpDown)},
+    {DPC_FOCUS_POSITION_CANCEL,        PTP_DT_UINT16, SDI_CONTROL_BUTTON,   PTP_FORM_FLAG_ENUM,  "Focus Position Cancel", PROP_ENUM_SET(sControl_UpDown)},
 };
 
-char* AwGetPropertyLabel(u16 propCode) {
-    for (int i = 0; i < MStaticArraySize(sPtpPropertyLabels); i++) {
-        if (sPtpPropertyLabels[i].code == propCode) {
-            return sPtpPropertyLabels[i].label;
+// The static code tables above and below are kept sorted by code (then data type for sPropertyMetadata) so they can be
+// binary searched, debug builds check the ordering and for duplicate codes in CheckCodeTablesSorted().
+// Returns the index of the first entry with the given code, or -1 if there isn't one.
+static int FindInCodeTable(const void* table, size_t count, size_t stride, size_t codeOffset, u16 code) {
+    const u8* base = (const u8*)table;
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        u16 midCode = *(const u16*)(base + mid * stride + codeOffset);
+        if (midCode < code) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
-
-    return NULL;
+    if (lo < count && *(const u16*)(base + lo * stride + codeOffset) == code) {
+        return (int)lo;
+    }
+    return -1;
 }
 
-char* AwGetControlLabel(u16 controlCode) {
-    for (int i = 0; i < MStaticArraySize(sAwControlsMetadata); i++) {
-        if (sAwControlsMetadata[i].controlCode == controlCode) {
-            return sAwControlsMetadata[i].label;
+#define FIND_IN_CODE_TABLE(table, field, code) \
+    FindInCodeTable((table), MStaticArraySize(table), sizeof((table)[0]), offsetof(M_TYPEOF((table)[0]), field), (code))
+
+static PTPPropertyMetadata* FindPropertyMetadata(u16 propCode, u16 dataType) {
+    int i = FIND_IN_CODE_TABLE(sPropertyMetadata, propCode, propCode);
+    if (i < 0) {
+        return NULL;
+    }
+    for (; i < MStaticArraySize(sPropertyMetadata) && sPropertyMetadata[i].propCode == propCode; i++) {
+        if (sPropertyMetadata[i].type == dataType) {
+            return sPropertyMetadata + i;
         }
     }
-
     return NULL;
 }
 
-char* AwGetEventLabel(u16 eventCode) {
-    for (int i = 0; i < MStaticArraySize(sPtpEventLabels); i++) {
-        if (sPtpEventLabels[i].code == eventCode) {
-            return sPtpEventLabels[i].label;
-        }
+static AwPtpControl* FindControlMetadata(u16 controlCode) {
+    int i = FIND_IN_CODE_TABLE(sAwControlsMetadata, controlCode, controlCode);
+    if (i < 0) {
+        return NULL;
+    }
+    return sAwControlsMetadata + i;
+}
+
+char* AwGetPropertyLabel(u16 propCode) {
+    int i = FIND_IN_CODE_TABLE(sPtpPropertyLabels, code, propCode);
+    if (i < 0) {
+        return NULL;
     }
+    return sPtpPropertyLabels[i].label;
+}
 
-    return NULL;
+char* AwGetControlLabel(u16 controlCode) {
+    AwPtpControl* meta = FindControlMetadata(controlCode);
+    if (!meta) {
+        return NULL;
+    }
+    return meta->label;
+}
+
+char* AwGetEventLabel(u16 eventCode) {
+    int i = FIND_IN_CODE_TABLE(sPtpEventLabels, code, eventCode);
+    if (i < 0) {
+        return NULL;
+    }
+    return sPtpEventLabels[i].label;
 }
 
 typedef struct {
@@ -2750,13 +2834,11 @@ static ObjectFormatMetadata sPtpObjectFormatMetadata[] = {
 };
 
 char* AwGetObjectFormatStr(u16 objectFormatCode) {
-    for (int i = 0; i < MStaticArraySize(sPtpObjectFormatMetadata); i++) {
-        if (sPtpObjectFormatMetadata[i].code == objectFormatCode) {
-            return sPtpObjectFormatMetadata[i].name;
-        }
+    int i = FIND_IN_CODE_TABLE(sPtpObjectFormatMetadata, code, objectFormatCode);
+    if (i < 0) {
+        return NULL;
     }
-
-    return NULL;
+    return sPtpObjectFormatMetadata[i].name;
 }
 
 typedef struct {
@@ -2794,11 +2876,6 @@ static OperationMetadata sPtpOperationMetadata[] = {
     {0x101A, "CopyObject", NULL},
     {0x101B, "GetPartialObject", NULL},
     {0x101C, "InitiateOpenCapture", NULL},
-    {0x9801, "GetObjectPropsSupported", "same as Media Transfer Protocol v.1.1 Spec"},
-    {0x9802, "GetObjectPropDesc", "same as Media Transfer Protocol v.1.1 Spec"},
-    {0x9803, "GetObjectPropValue", "same as Media Transfer Protocol v.1.1 Spec"},
-    {0x9804, "SetObjectPropValue", "same as Media Transfer Protocol v.1.1 Spec"},
-    {0x9805, "GetObjectPropList", "same as Media Transfer Protocol v.1.1 Spec"},
     {PTP_OC_SDIO_Connect, "SDIO_Connect", "This is for the authentication handshake."},
     {PTP_OC_SDIO_GetExtDeviceInfo, "SDIO_GetExtDeviceInfo", "Get the protocol version and the supported properties "
         "of the connected device."},
@@ -2840,17 +2917,57 @@ static OperationMetadata sPtpOperationMetadata[] = {
     {PTP_OC_SDIO_SetAreaTimeZoneSetting, "SDIO_SetAreaTimeZoneSetting", "Set AreaTimeZone Setting."},
     {PTP_OC_SDIO_DeleteContent, "SDIO_DeleteContent", "Delete Content."},
     {PTP_OC_SDIO_GetExtDeviceProp, "SDIO_GetExtDeviceProp", "Get the DevicePropInfo."},
+    {0x9801, "GetObjectPropsSupported", "same as Media Transfer Protocol v.1.1 Spec"},
+    {0x9802, "GetObjectPropDesc", "same as Media Transfer Protocol v.1.1 Spec"},
+    {0x9803, "GetObjectPropValue", "same as Media Transfer Protocol v.1.1 Spec"},
+    {0x9804, "SetObjectPropValue", "same as Media Transfer Protocol v.1.1 Spec"},
+    {0x9805, "GetObjectPropList", "same as Media Transfer Protocol v.1.1 Spec"},
 };
 
 char* AwGetOperationLabel(u16 operationCode) {
-    for (int i = 0; i < MStaticArraySize(sPtpOperationMetadata); i++) {
-        if (sPtpOperationMetadata[i].code == operationCode) {
-            return sPtpOperationMetadata[i].label;
+    int i = FIND_IN_CODE_TABLE(sPtpOperationMetadata, code, operationCode);
+    if (i < 0) {
+        return NULL;
+    }
+    return sPtpOperationMetadata[i].label;
+}
+
+#ifdef M_ASSERT
+static void CheckCodeTableSorted(const char* name, const void* table, size_t count, size_t stride, size_t codeOffset,
+                                 size_t typeOffset) {
+    const u8* base = (const u8*)table;
+    for (size_t i = 1; i < count; i++) {
+        u16 prevCode = *(const u16*)(base + (i - 1) * stride + codeOffset);
+        u16 code = *(const u16*)(base + i * stride + codeOffset);
+        if (typeOffset && prevCode == code) {
+            u16 prevType = *(const u16*)(base + (i - 1) * stride + typeOffset);
+            u16 type = *(const u16*)(base + i * stride + typeOffset);
+            MAssertf(prevType < type, "%s: duplicate or unsorted entry for code 0x%04x", name, code);
+        } else {
+            MAssertf(prevCode < code, "%s: duplicate or unsorted entry for code 0x%04x", name, code);
         }
     }
+}
 
-    return NULL;
+#define CHECK_CODE_TABLE_SORTED(table, field, typeOffset) \
+    CheckCodeTableSorted(#table, (table), MStaticArraySize(table), sizeof((table)[0]), \
+                         offsetof(M_TYPEOF((table)[0]), field), (typeOffset))
+
+// Lookups binary search the static code tables, catch any edit that breaks their ordering or duplicates a code
+static void CheckCodeTablesSorted() {
+    static b32 checked = FALSE;
+    if (checked) {
+        return;
+    }
+    checked = TRUE;
+    CHECK_CODE_TABLE_SORTED(sPropertyMetadata, propCode, offsetof(PTPPropertyMetadata, type));
+    CHECK_CODE_TABLE_SORTED(sPtpPropertyLabels, code, 0);
+    CHECK_CODE_TABLE_SORTED(sAwControlsMetadata, controlCode, 0);
+    CHECK_CODE_TABLE_SORTED(sPtpEventLabels, code, 0);
+    CHECK_CODE_TABLE_SORTED(sPtpObjectFormatMetadata, code, 0);
+    CHECK_CODE_TABLE_SORTED(sPtpOperationMetadata, code, 0);
 }
+#endif
 
 char* AwPtpGetDataTypeStr(PtpDataType dataType) {
     switch (dataType) {
@@ -3092,6 +3209,17 @@ size_t Ptp_PropValueSize(PtpDataType dataType, AwPtpPropValue value) {
     return 0;
 }
 
+static void UpdateStr(MAllocator* allocator, MStr* strIn, MStr* strOut) {
+    size_t size = strIn->size + 1;
+    if (strOut->capacity < size) {
+        strOut->str = MRealloc(allocator, strOut->str, strOut->capacity, size);
+        strOut->capacity = size;
+    }
+    memcpy(strOut->str, strIn->str, strIn->size);
+    strOut->str[strIn->size] = '\0';
+    strOut->size = strIn->size;
+}
+
 static void PropValueFree(MAllocator* mem, PtpDataType dataType, AwPtpPropValue* value) {
     if (value == NULL) {
         return;
@@ -3370,31 +3498,99 @@ static void PrintProperties(AwControl* self) {
     }
 }
 
-void AwControl_InitDataBuffers(AwControl* self, size_t dataInSize, size_t dataOutSize) {
-    if (dataInSize > self->dataInCapacity || self->dataInMem == NULL) {
-        void* mem = self->device->transport.reallocBuffer(self->device, AW_BUFFER_IN,
-                                                          self->dataInMem, self->dataInCapacity,
-                                                          dataInSize);
-        self->dataInCapacity = dataInSize;
-        self->dataInMem = mem;
+// Transport data buffers are allocated in size classes, so requests of a similar size (e.g. live view frames) keep
+// reusing the same allocation: powers of two from AW_DATA_BUFFER_MIN_SIZE up to AW_DATA_BUFFER_POW2_MAX, then
+// multiples of AW_DATA_BUFFER_POW2_MAX.
+#define AW_DATA_BUFFER_MIN_SIZE 0x1000
+#define AW_DATA_BUFFER_POW2_MAX 0x100000
+// A buffer larger than AW_DATA_BUFFER_SHRINK_MIN is shrunk once AW_DATA_BUFFER_SHRINK_AFTER consecutive requests have
+// fit in a quarter of it
+#define AW_DATA_BUFFER_SHRINK_MIN 0x100000
+#define AW_DATA_BUFFER_SHRINK_AFTER 8
+
+static size_t DataBufferSizeClass(size_t size) {
+    if (size <= AW_DATA_BUFFER_MIN_SIZE) {
+        return AW_DATA_BUFFER_MIN_SIZE;
+    }
+    if (size > AW_DATA_BUFFER_POW2_MAX) {
+        return MSizeAlign(size, AW_DATA_BUFFER_POW2_MAX);
+    }
+    size_t sizeClass = AW_DATA_BUFFER_MIN_SIZE;
+    while (sizeClass < size) {
+        sizeClass <<= 1;
+    }
+    return sizeClass;
+}
+
+static void ResizeDataBuffer(AwControl* self, AwBufferType type, u8** mem, u32* capacity, u32* peakCapacity,
+                             size_t newCapacity) {
+    *mem = self->device->transport.reallocBuffer(self->device, type, *mem, *capacity, newCapacity);
+    *capacity = (u32)newCapacity;
+    if (*capacity > *peakCapacity) {
+        *peakCapacity = *capacity;
     }
+    self->dataBufferStats.resizeCount++;
+}
 
-    if (dataOutSize > self->dataOutCapacity || self->dataOutMem == NULL) {
-        void* mem = self->device->transport.reallocBuffer(self->device, AW_BUFFER_OUT,
-                                                          self->dataOutMem, self->dataOutCapacity,
-                                                          dataOutSize);
-        self->dataOutCapacity = dataOutSize;
-        self->dataOutMem = mem;
+// Grow a buffer to fit 'size' bytes, or shrink it if it has been oversized for a run of requests.  Buffer contents
+// are not preserved or cleared, every request writes what it sends and only reads back what was received.
+static void PrepareDataBuffer(AwControl* self, AwBufferType type, u8** mem, u32* capacity, u32* smallRequests,
+                              u32* peakCapacity, size_t size) {
+    size_t sizeClass = DataBufferSizeClass(size);
+    if (*mem == NULL || size > *capacity) {
+        ResizeDataBuffer(self, type, mem, capacity, peakCapacity, sizeClass);
+        *smallRequests = 0;
+    } else if (*capacity > AW_DATA_BUFFER_SHRINK_MIN && sizeClass * 4 <= *capacity) {
+        (*smallRequests)++;
+        if (*smallRequests >= AW_DATA_BUFFER_SHRINK_AFTER) {
+            ResizeDataBuffer(self, type, mem, capacity, peakCapacity, sizeClass);
+            self->dataBufferStats.shrinkCount++;
+            *smallRequests = 0;
+        }
+    } else {
+        *smallRequests = 0;
     }
+}
+
+void AwControl_InitDataBuffers(AwControl* self, size_t dataInSize, size_t dataOutSize) {
+    AwDataBufferStats* stats = &self->dataBufferStats;
+    PrepareDataBuffer(self, AW_BUFFER_IN, &self->dataInMem, &self->dataInCapacity, &self->dataInSmallRequests,
+                      &stats->inPeakCapacity, dataInSize);
+    PrepareDataBuffer(self, AW_BUFFER_OUT, &self->dataOutMem, &self->dataOutCapacity, &self->dataOutSmallRequests,
+                      &stats->outPeakCapacity, dataOutSize);
 
     self->dataInSize = dataInSize;
     self->dataOutSize = dataOutSize;
-    memset(self->dataInMem, 0, dataInSize);
-    if (dataOutSize) {
-        memset(self->dataOutMem, 0, dataOutSize);
+    if (dataInSize > stats->inPeakSize) {
+        stats->inPeakSize = dataInSize;
+    }
+    if (dataOutSize > stats->outPeakSize) {
+        stats->outPeakSize = dataOutSize;
     }
 }
 
+void AwControl_TrimDataBuffers(AwControl* self) {
+    AwDataBufferStats* stats = &self->dataBufferStats;
+    if (self->dataInMem && self->dataInCapacity > AW_DATA_BUFFER_MIN_SIZE) {
+        ResizeDataBuffer(self, AW_BUFFER_IN, &self->dataInMem, &self->dataInCapacity, &stats->inPeakCapacity,
+                         AW_DATA_BUFFER_MIN_SIZE);
+        stats->shrinkCount++;
+    }
+    if (self->dataOutMem && self->dataOutCapacity > AW_DATA_BUFFER_MIN_SIZE) {
+        ResizeDataBuffer(self, AW_BUFFER_OUT, &self->dataOutMem, &self->dataOutCapacity, &stats->outPeakCapacity,
+                         AW_DATA_BUFFER_MIN_SIZE);
+        stats->shrinkCount++;
+    }
+    self->dataInSmallRequests = 0;
+    self->dataOutSmallRequests = 0;
+}
+
+void AwControl_GetDataBufferStats(AwControl* self, AwDataBufferStats* outStats) {
+    *outStats = self->dataBufferStats;
+    outStats->inCapacity = self->dataInCapacity;
+    outStats->outCapacity = self->dataOutCapacity;
+}
+
 void AwControl_FreeDataBuffers(AwControl* self) {
     self->device->transport.freeBuffer(self->device, AW_BUFFER_IN, self->dataInMem, self->dataInCapacity);
     self->dataInMem = NULL;
@@ -3405,6 +3601,8 @@ void AwControl_FreeDataBuffers(AwControl* self) {
 }
 
 static AwPtpRequestHeader BuildReq(AwControl* self, size_t dataInSize, size_t dataOutSize, u16 opCode) {
+    MAssertf(AwControl_OwnsTransport(self), "Request 0x%04x sent without owning the transport, see "
+             "AwControl_AcquireTransport()", opCode);
     AwControl_InitDataBuffers(self, (u32)dataInSize, (u32)dataOutSize);
     AwPtpRequestHeader r = {
         .OpCode = opCode,
@@ -3486,6 +3684,141 @@ static AwResult SDIO_Connect(AwControl* self, u32 phase, u32 connectionId) {
     return r.result;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Code & id lookup tables
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+#define AW_CODE_SET_WORDS (0x10000 / 64)
+#define AW_CODE_INDEX_PAGES 0x100
+#define AW_CODE_INDEX_PAGE_SIZE 0x100
+
+static void CodeSet_Add(MAllocator* allocator, AwCodeSet* set, u16 code) {
+    if (!set->bits) {
+        set->bits = MMallocZ(allocator, AW_CODE_SET_WORDS * sizeof(u64));
+    }
+    set->bits[code >> 6] |= (u64)1 << (code & 63);
+}
+
+static b32 CodeSet_Contains(AwCodeSet* set, u16 code) {
+    return set->bits && ((set->bits[code >> 6] >> (code & 63)) & 1);
+}
+
+static void CodeSet_Free(MAllocator* allocator, AwCodeSet* set) {
+    MFree(allocator, set->bits, AW_CODE_SET_WORDS * sizeof(u64));
+}
+
+static void CodeIndex_Set(MAllocator* allocator, AwCodeIndex* index, u16 code, size_t i) {
+    if (!index->pages) {
+        index->pages = MMallocZ(allocator, AW_CODE_INDEX_PAGES * sizeof(u16*));
+    }
+    u16** page = index->pages + (code >> 8);
+    if (!*page) {
+        *page = MMallocZ(allocator, AW_CODE_INDEX_PAGE_SIZE * sizeof(u16));
+    }
+    (*page)[code & 0xff] = (u16)(i + 1);
+}
+
+// Returns -1 if the code isn't in the index
+static i32 CodeIndex_Get(AwCodeIndex* index, u16 code) {
+    if (!index->pages) {
+        return -1;
+    }
+    u16* page = index->pages[code >> 8];
+    if (!page) {
+        return -1;
+    }
+    return (i32)page[code & 0xff] - 1;
+}
+
+// Remove all entries, keeping the allocated pages for reuse
+static void CodeIndex_Clear(AwCodeIndex* index) {
+    if (!index->pages) {
+        return;
+    }
+    for (int i = 0; i < AW_CODE_INDEX_PAGES; i++) {
+        if (index->pages[i]) {
+            memset(index->pages[i], 0, AW_CODE_INDEX_PAGE_SIZE * sizeof(u16));
+        }
+    }
+}
+
+static void CodeIndex_Free(MAllocator* allocator, AwCodeIndex* index) {
+    if (!index->pages) {
+        return;
+    }
+    for (int i = 0; i < AW_CODE_INDEX_PAGES; i++) {
+        MFree(allocator, index->pages[i], AW_CODE_INDEX_PAGE_SIZE * sizeof(u16));
+    }
+    MFree(allocator, index->pages, AW_CODE_INDEX_PAGES * sizeof(u16*));
+}
+
+static u32 PropertyIdHash(const char* id) {
+    // FNV-1a
+    u32 hash = 2166136261u;
+    for (const u8* c = (const u8*)id; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Rebuild the property id hash from the metadata currently assigned to self->properties
+static void PropertyIdIndex_Build(AwControl* self) {
+    AwPropertyIdIndex* index = &self->propertyIdIndex;
+    size_t numProperties = MArraySize(self->properties);
+
+    // Keep the load factor at or below 1/2
+    u32 capacity = 16;
+    while (capacity < numProperties * 2) {
+        capacity <<= 1;
+    }
+    if (capacity > index->capacity) {
+        MFree(self->allocator, index->slots, index->capacity * sizeof(u16));
+        index->slots = MMalloc(self->allocator, capacity * sizeof(u16));
+        index->capacity = capacity;
+    }
+    memset(index->slots, 0, index->capacity * sizeof(u16));
+    index->count = 0;
+
+    u32 mask = index->capacity - 1;
+    MArrayEachPtr(self->properties, it) {
+        if (!it.p->meta || !it.p->meta->id) {
+            continue;
+        }
+        u32 slot = PropertyIdHash(it.p->meta->id) & mask;
+        while (index->slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        index->slots[slot] = (u16)(it.i + 1);
+        index->count++;
+    }
+}
+
+static void PropertyIdIndex_Free(MAllocator* allocator, AwPropertyIdIndex* index) {
+    MFree(allocator, index->slots, index->capacity * sizeof(u16));
+    index->capacity = 0;
+    index->count = 0;
+}
+
+static void AddSupportedCode(AwControl* self, u16** codes, AwCodeSet* set, u16 code) {
+    MArrayAdd(self->allocator, *codes, code);
+    CodeSet_Add(self->allocator, set, code);
+}
+
+static AwPtpProperty* AddProperty(AwControl* self, u16 propCode) {
+    AwPtpProperty* property = MArrayAddPtrZ(self->allocator, self->properties);
+    property->propCode = propCode;
+    CodeIndex_Set(self->allocator, &self->propertyIndex, propCode, MArraySize(self->properties) - 1);
+    return property;
+}
+
+static AwPtpControl* AddControl(AwControl* self, u16 controlCode) {
+    AwPtpControl* control = MArrayAddPtrZ(self->allocator, self->controls);
+    control->controlCode = controlCode;
+    CodeIndex_Set(self->allocator, &self->controlIndex, controlCode, MArraySize(self->controls) - 1);
+    return control;
+}
+
 static AwResult PTP_GetDeviceInfo(AwControl* self) {
     PTPResponse r = DoRequest(self, PTP_OC_GetDeviceInfo, 0, 0x1000, 0);
     RETURN_IF_FAIL(r);
@@ -3520,7 +3853,7 @@ static AwResult PTP_GetDeviceInfo(AwControl* self) {
     for (int i = 0; i < eventsLen; i++) {
         u16 event = 0;
         MMemReadU16LE(&r.memIo, &event);
-        MArrayAdd(self->allocator, self->supportedEvents, event);
+        AddSupportedCode(self, &self->supportedEvents, &self->supportedEventSet, event);
     }
 
     u32 propertiesSupportedLen = 0;
@@ -3528,7 +3861,7 @@ static AwResult PTP_GetDeviceInfo(AwControl* self) {
     for (int i = 0; i < propertiesSupportedLen; i++) {
         u16 devicePropertyCode = 0;
         MMemReadU16LE(&r.memIo, &devicePropertyCode);
-        MArrayAdd(self->allocator, self->supportedProperties, devicePropertyCode);
+        AddSupportedCode(self, &self->supportedProperties, &self->supportedPropertySet, devicePropertyCode);
     }
 
     u32 captureFormatsLen = 0;
@@ -3555,10 +3888,277 @@ static AwResult PTP_GetDeviceInfo(AwControl* self) {
     return r.result;
 }
 
+static b32 PropValueEqual(u16 dataType, AwPtpPropValue* a, AwPtpPropValue* b) {
+    switch (dataType) {
+        case PTP_DT_INT8:
+        case PTP_DT_UINT8:
+            return a->u8 == b->u8;
+        case PTP_DT_INT16:
+        case PTP_DT_UINT16:
+            return a->u16 == b->u16;
+        case PTP_DT_INT32:
+        case PTP_DT_UINT32:
+            return a->u32 == b->u32;
+        case PTP_DT_INT64:
+        case PTP_DT_UINT64:
+            return a->u64 == b->u64;
+        case PTP_DT_STR:
+            return a->str.size == b->str.size && (a->str.size == 0 || memcmp(a->str.str, b->str.str, a->str.size) == 0);
+        default:
+            return TRUE;
+    }
+}
+
+// Read a property value over the top of 'value', reusing its string storage (if any) so nothing is allocated when the
+// value hasn't changed.
+// Returns TRUE if the value read differs from the previous contents of 'value'.
+static b32 ReadPropertyValueInPlace(MAllocator* allocator, MMemIO* memIo, u16 dataType, AwPtpPropValue* value) {
+    if (dataType != PTP_DT_STR) {
+        AwPtpPropValue newValue = *value;
+        ReadPropertyValue(allocator, memIo, dataType, &newValue);
+        b32 changed = !PropValueEqual(dataType, value, &newValue);
+        *value = newValue;
+        return changed;
+    }
+
+    // PTP strings are at most 255 UTF-16 code units, convert to UTF-8 on the stack and compare before copying
+    u8 len = 0;
+    MMemReadU8(memIo, &len);
+    char utf8[255 * 3 + 1];
+    size_t utf8Len = 0;
+    if (len) {
+        u16* buffer = (u16*) MMemReadAdvance(memIo, len * 2);
+        utf8Len = UTF8_ConvertFromUTF16(buffer, len, utf8, sizeof(utf8));
+        // MStr.size must be the length of the string, not including nul terminator
+        if (utf8Len > 0 && utf8[utf8Len - 1] == '\0') {
+            utf8Len--;
+        }
+    }
+
+    MStr* str = &value->str;
+    if (str->size == utf8Len && (utf8Len == 0 || memcmp(str->str, utf8, utf8Len) == 0)) {
+        return FALSE;
+    }
+    if (str->capacity < utf8Len + 1) {
+        str->str = MRealloc(allocator, str->str, str->capacity, utf8Len + 1);
+        str->capacity = utf8Len + 1;
+    }
+    if (str->capacity) {
+        memcpy(str->str, utf8, utf8Len);
+        str->str[utf8Len] = '\0';
+    }
+    str->size = utf8Len;
+    return TRUE;
+}
+
+static void PropValueArrayFree(MAllocator* allocator, u16 dataType, AwPtpPropValue** values) {
+    if (dataType == PTP_DT_STR) {
+        for (int i = 0; i < MArraySize(*values); i++) {
+            PropValueFree(allocator, dataType, *values + i);
+        }
+    }
+    MArrayFree(allocator, *values);
+}
+
+// Read a u16 count followed by that many values into the array, reusing the existing array and its values.
+// Returns TRUE if the set of values differs from the previous contents of the array.
+static b32 ReadPropValueArrayInPlace(MAllocator* allocator, MMemIO* memIo, u16 dataType, AwPtpPropValue** values) {
+    u16 numValues = 0;
+    MMemReadU16LE(memIo, &numValues);
+
+    size_t oldSize = MArraySize(*values);
+    b32 changed = numValues != oldSize;
+    if (!*values) {
+        MArrayInit(allocator, *values, numValues);
+    }
+    for (int i = 0; i < numValues; i++) {
+        AwPtpPropValue* value = (i < oldSize) ? *values + i : MArrayAddPtrZ(allocator, *values);
+        if (ReadPropertyValueInPlace(allocator, memIo, dataType, value)) {
+            changed = TRUE;
+        }
+    }
+    if (numValues < oldSize) {
+        if (dataType == PTP_DT_STR) {
+            for (size_t i = numValues; i < oldSize; i++) {
+                PropValueFree(allocator, dataType, *values + i);
+            }
+        }
+        MArrayResize(allocator, *values, numValues);
+    }
+    return changed;
+}
+
+static void PropertyFormFree(MAllocator* allocator, AwPtpProperty* property) {
+    if (property->formFlag == PTP_FORM_FLAG_ENUM) {
+        PropValueArrayFree(allocator, property->dataType, &property->form.enums.set);
+        PropValueArrayFree(allocator, property->dataType, &property->form.enums.getSet);
+    } else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
+        PropValueFree(allocator, property->dataType, &property->form.range.min);
+        PropValueFree(allocator, property->dataType, &property->form.range.max);
+        PropValueFree(allocator, property->dataType, &property->form.range.step);
+    }
+    memset(&property->form, 0, sizeof(property->form));
+}
+
+static void PropValueCopy(MAllocator* allocator, u16 dataType, AwPtpPropValue* src, AwPtpPropValue* dest) {
+    if (dataType == PTP_DT_STR) {
+        dest->str = MStrMakeEmpty();
+        UpdateStr(allocator, &src->str, &dest->str);
+    } else {
+        *dest = *src;
+    }
+}
+
+static void PropValueArrayCopy(MAllocator* allocator, u16 dataType, AwPtpPropValue* src, AwPtpPropValue** dest) {
+    *dest = NULL;
+    if (!src) {
+        return;
+    }
+    MArrayInit(allocator, *dest, MArraySize(src));
+    for (int i = 0; i < MArraySize(src); i++) {
+        PropValueCopy(allocator, dataType, src + i, MArrayAddPtrZ(allocator, *dest));
+    }
+}
+
+// Deep copy of a property, the copy owns its values and form
+static void PropertyCopy(MAllocator* allocator, AwPtpProperty* property, AwPtpProperty* outProperty) {
+    *outProperty = *property;
+    PropValueCopy(allocator, property->dataType, &property->value, &outProperty->value);
+    PropValueCopy(allocator, property->dataType, &property->defaultValue, &outProperty->defaultValue);
+    if (property->formFlag == PTP_FORM_FLAG_ENUM) {
+        PropValueArrayCopy(allocator, property->dataType, property->form.enums.set, &outProperty->form.enums.set);
+        PropValueArrayCopy(allocator, property->dataType, property->form.enums.getSet, &outProperty->form.enums.getSet);
+    } else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
+        PropValueCopy(allocator, property->dataType, &property->form.range.min, &outProperty->form.range.min);
+        PropValueCopy(allocator, property->dataType, &property->form.range.max, &outProperty->form.range.max);
+        PropValueCopy(allocator, property->dataType, &property->form.range.step, &outProperty->form.range.step);
+    }
+}
+
+static void PropertySnapshot_Free(AwPropertySnapshot* snapshot) {
+    MAllocator* allocator = snapshot->allocator;
+    MArrayEachPtr(snapshot->properties, it) {
+        PropValueFree(allocator, it.p->dataType, &it.p->value);
+        PropValueFree(allocator, it.p->dataType, &it.p->defaultValue);
+        PropertyFormFree(allocator, it.p);
+    }
+    MArrayFree(allocator, snapshot->properties);
+    MArrayFree(allocator, snapshot->changedProperties);
+    CodeIndex_Free(allocator, &snapshot->propertyIndex);
+    MFree(allocator, snapshot, sizeof(AwPropertySnapshot));
+}
+
+// Replace the current snapshot with a copy of the properties, or with nothing if 'publish' is FALSE.  Only called by
+// the thread that owns the transport, so the properties can't change while they're copied.
+static void PublishPropertySnapshot(AwControl* self, b32 publish, u16* changed, size_t numChanged) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return;
+    }
+
+    AwPropertySnapshot* snapshot = NULL;
+    if (publish) {
+        snapshot = MMallocZ(self->allocator, sizeof(AwPropertySnapshot));
+        snapshot->version = ++self->propSnapshotVersion;
+        snapshot->timeMilliseconds = MGetTimeMilliseconds();
+        snapshot->refCount = 1;
+        snapshot->allocator = self->allocator;
+        MArrayInit(self->allocator, snapshot->properties, MArraySize(self->properties));
+        for (int i = 0; i < MArraySize(self->properties); i++) {
+            PropertyCopy(self->allocator, self->properties + i, MArrayAddPtr(self->allocator, snapshot->properties));
+            CodeIndex_Set(self->allocator, &snapshot->propertyIndex, self->properties[i].propCode, i);
+        }
+        MArrayInit(self->allocator, snapshot->changedProperties, numChanged);
+        for (size_t i = 0; i < numChanged; i++) {
+            MArrayAdd(self->allocator, snapshot->changedProperties, changed[i]);
+        }
+    }
+
+    SnapshotLock(sync);
+    AwPropertySnapshot* previous = self->propSnapshot;
+    self->propSnapshot = snapshot;
+    SnapshotUnlock(sync);
+
+    if (previous) {
+        AwPropertySnapshot_Release(previous);
+    }
+}
+
+// Read a SDIExtDevicePropInfo dataset (after the property code) into 'property', updating its values and form in place.
+// 'hasGetSetEnums' is set for protocol 3.0 which follows the enum 'set' values with the 'getSet' values.
+// Returns TRUE if the data type, value, default value, get/set, enabled state or form changed.
+static b32 ReadExtDevicePropInfo(AwControl* self, MMemIO* memIo, AwPtpProperty* property, b32 hasGetSetEnums) {
+    b32 changed = FALSE;
+
+    u16 dataType = 0;
+    MMemReadU16LE(memIo, &dataType);
+    if (dataType != property->dataType) {
+        PropertyFormFree(self->allocator, property);
+        PropValueFree(self->allocator, property->dataType, &property->value);
+        PropValueFree(self->allocator, property->dataType, &property->defaultValue);
+        memset(&property->value, 0, sizeof(property->value));
+        memset(&property->defaultValue, 0, sizeof(property->defaultValue));
+        property->formFlag = PTP_FORM_FLAG_NONE;
+        property->dataType = dataType;
+        changed = TRUE;
+    }
+
+    u8 getSet = 0;
+    MMemReadU8(memIo, &getSet);
+    u8 isEnabled = 0;
+    MMemReadU8(memIo, &isEnabled);
+    if (getSet != property->getSet || isEnabled != property->isEnabled) {
+        property->getSet = getSet;
+        property->isEnabled = isEnabled;
+        changed = TRUE;
+    }
+
+    if (ReadPropertyValueInPlace(self->allocator, memIo, dataType, &property->defaultValue)) {
+        changed = TRUE;
+    }
+    if (ReadPropertyValueInPlace(self->allocator, memIo, dataType, &property->value)) {
+        changed = TRUE;
+    }
+
+    u8 formFlag = 0;
+    MMemReadU8(memIo, &formFlag);
+    if (formFlag != property->formFlag) {
+        // Enum & range share storage, start from an empty form
+        PropertyFormFree(self->allocator, property);
+        property->formFlag = formFlag;
+        changed = TRUE;
+    }
+
+    if (formFlag == PTP_FORM_FLAG_ENUM) {
+        if (ReadPropValueArrayInPlace(self->allocator, memIo, dataType, &property->form.enums.set)) {
+            changed = TRUE;
+        }
+        if (hasGetSetEnums) {
+            if (ReadPropValueArrayInPlace(self->allocator, memIo, dataType, &property->form.enums.getSet)) {
+                changed = TRUE;
+            }
+        }
+    } else if (formFlag == PTP_FORM_FLAG_RANGE) {
+        if (ReadPropertyValueInPlace(self->allocator, memIo, dataType, &property->form.range.min)) {
+            changed = TRUE;
+        }
+        if (ReadPropertyValueInPlace(self->allocator, memIo, dataType, &property->form.range.max)) {
+            changed = TRUE;
+        }
+        if (ReadPropertyValueInPlace(self->allocator, memIo, dataType, &property->form.range.step)) {
+            changed = TRUE;
+        }
+    }
+
+    return changed;
+}
+
 static void SDIO_ProcessDeviceProperties200(AwControl *self, b32 initial, PTPResponse r, u64 numProperties) {
     if (initial) {
         MArrayInit(self->allocator, self->properties, 0);
         MArrayInit(self->allocator, self->controls, 0);
+        CodeIndex_Clear(&self->propertyIndex);
+        CodeIndex_Clear(&self->controlIndex);
     }
 
     for (int i = 0; i < numProperties; i++) {
@@ -3572,18 +4172,8 @@ static void SDIO_ProcessDeviceProperties200(AwControl *self, b32 initial, PTPRes
                 control = AwControl_GetControlByCode(self, propCode);
             }
             if (!control) {
-                control = MArrayAddPtr(self->allocator, self->controls);
-                memset(control, 0, sizeof(AwPtpControl));
-                control->controlCode = propCode;
-
-                size_t numControlsMeta = MStaticArraySize(sAwControlsMetadata);
-                for (int j = 0; j < numControlsMeta; j++) {
-                    AwPtpControl* controlDesc = sAwControlsMetadata + j;
-                    if (controlDesc->controlCode == propCode) {
-                        control->label = controlDesc->label;
-                        break;
-                    }
-                }
+                control = AddControl(self, propCode);
+                control->label = AwGetControlLabel(propCode);
             }
 
             MMemReadU16LE(&r.memIo, &control->dataType);
@@ -3592,19 +4182,23 @@ static void SDIO_ProcessDeviceProperties200(AwControl *self, b32 initial, PTPRes
             u8 isEnabled = 0;
             MMemReadU8(&r.memIo, &isEnabled);
 
-            AwPtpPropValue dummy;
-            ReadPropertyValue(self->allocator, &r.memIo, control->dataType, &dummy);
-            ReadPropertyValue(self->allocator, &r.memIo, control->dataType, &dummy);
+            AwPtpPropValue dummy = {};
+            ReadPropertyValueInPlace(self->allocator, &r.memIo, control->dataType, &dummy);
+            ReadPropertyValueInPlace(self->allocator, &r.memIo, control->dataType, &dummy);
+            PropValueFree(self->allocator, control->dataType, &dummy);
 
             MMemReadU8(&r.memIo, &control->formFlag);
 
             if (control->formFlag == PTP_FORM_FLAG_ENUM) {
                 u16 numEnumSet = 0;
                 MMemReadU16LE(&r.memIo, &numEnumSet);
+                if (!control->form.enums.owned) {
+                    // Values may still point at the static metadata list
+                    control->form.enums.values = NULL;
+                }
                 MArrayInit(self->allocator, control->form.enums.values, numEnumSet);
-                memset(control->form.enums.values, 0, numEnumSet * sizeof(AwPtpControl));
                 for (int j = 0; j < numEnumSet; j++) {
-                    AwPtpPropValueEnum *value = MArrayAddPtr(self->allocator, control->form.enums.values);
+                    AwPtpPropValueEnum *value = MArrayAddPtrZ(self->allocator, control->form.enums.values);
                     ReadPropertyValue(self->allocator, &r.memIo, control->dataType, &value->propValue);
                 }
                 control->form.enums.size = numEnumSet;
@@ -3620,33 +4214,14 @@ static void SDIO_ProcessDeviceProperties200(AwControl *self, b32 initial, PTPRes
             if (!initial) {
                 property = AwControl_GetPropertyByCode(self, propCode);
             }
+            b32 added = FALSE;
             if (!property) {
-                property = MArrayAddPtr(self->allocator, self->properties);
-                memset(property, 0, sizeof(AwPtpProperty));
-                property->propCode = propCode;
+                property = AddProperty(self, propCode);
+                added = TRUE;
             }
 
-            MMemReadU16LE(&r.memIo, &property->dataType);
-            MMemReadU8(&r.memIo, &property->getSet);
-            MMemReadU8(&r.memIo, &property->isEnabled);
-
-            ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->defaultValue);
-            ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->value);
-
-            MMemReadU8(&r.memIo, &property->formFlag);
-
-            if (property->formFlag == PTP_FORM_FLAG_ENUM) {
-                u16 numEnumSet = 0;
-                MMemReadU16LE(&r.memIo, &numEnumSet);
-                MArrayInit(self->allocator, property->form.enums.set, numEnumSet);
-                for (int j = 0; j < numEnumSet; j++) {
-                    AwPtpPropValue* value = MArrayAddPtr(self->allocator, property->form.enums.set);
-                    ReadPropertyValue(self->allocator, &r.memIo, property->dataType, value);
-                }
-            } else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
-                ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.min);
-                ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.max);
-                ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.step);
+            if (ReadExtDevicePropInfo(self, &r.memIo, property, FALSE) || added) {
+                MArrayAdd(self->allocator, self->changedProperties, propCode);
             }
 
             // On older pre-2020 cameras, some properties can only be adjusted up or down, mark them as such with
@@ -3670,7 +4245,7 @@ static void SDIO_ProcessDeviceProperties200(AwControl *self, b32 initial, PTPRes
 static void SDIO_ProcessDeviceProperties300(AwControl *self, b32 initial, PTPResponse r, u64 numProperties) {
     if (initial) {
         MArrayInit(self->allocator, self->properties, numProperties);
-        memset(self->properties, 0, numProperties * sizeof(AwPtpProperty));
+        CodeIndex_Clear(&self->propertyIndex);
     }
 
     for (int i = 0; i < numProperties; i++) {
@@ -3681,56 +4256,32 @@ static void SDIO_ProcessDeviceProperties300(AwControl *self, b32 initial, PTPRes
         if (!initial) {
             property = AwControl_GetPropertyByCode(self, propCode);
         }
+        b32 added = FALSE;
         if (!property) {
-            property = MArrayAddPtrZ(self->allocator, self->properties);
-            property->propCode = propCode;
+            property = AddProperty(self, propCode);
+            added = TRUE;
         }
 
-        MMemReadU16LE(&r.memIo, &property->dataType);
-        MMemReadU8(&r.memIo, &property->getSet);
-        MMemReadU8(&r.memIo, &property->isEnabled);
-
-        ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->defaultValue);
-        ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->value);
-
-        MMemReadU8(&r.memIo, &property->formFlag);
-
-        if (property->formFlag == PTP_FORM_FLAG_ENUM) {
-            u16 numEnumSet = 0;
-            MMemReadU16LE(&r.memIo, &numEnumSet);
-            MArrayInit(self->allocator, property->form.enums.set, numEnumSet);
-            for (int j = 0; j < numEnumSet; j++) {
-                AwPtpPropValue* value = MArrayAddPtr(self->allocator, property->form.enums.set);
-                ReadPropertyValue(self->allocator, &r.memIo, property->dataType, value);
-            }
-            u16 numEnumGetSet = 0;
-            MMemReadU16LE(&r.memIo, &numEnumGetSet);
-            MArrayInit(self->allocator, property->form.enums.getSet, numEnumGetSet);
-            for (int j = 0; j < numEnumGetSet; j++) {
-                AwPtpPropValue* value = MArrayAddPtr(self->allocator, property->form.enums.getSet);
-                ReadPropertyValue(self->allocator, &r.memIo, property->dataType, value);
-            }
-        } else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
-            ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.min);
-            ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.max);
-            ReadPropertyValue(self->allocator, &r.memIo, property->dataType, &property->form.range.step);
+        if (ReadExtDevicePropInfo(self, &r.memIo, property, TRUE) || added) {
+            MArrayAdd(self->allocator, self->changedProperties, propCode);
         }
     }
 }
 
 static void SetMetadataForProperties(AwControl* self) {
+    b32 changed = FALSE;
     MArrayEachPtr(self->properties, i) {
         if (i.p->meta) {
             continue;
         }
-        for (int j = 0; j < MStaticArraySize(sPropertyMetadata); j++) {
-            PTPPropertyMetadata* meta = sPropertyMetadata + j;
-            if (i.p->propCode == meta->propCode && meta->type == i.p->dataType) {
-                i.p->meta = meta;
-                break;
-            }
+        i.p->meta = FindPropertyMetadata(i.p->propCode, i.p->dataType);
+        if (i.p->meta) {
+            changed = TRUE;
         }
     }
+    if (changed || !self->propertyIdIndex.slots) {
+        PropertyIdIndex_Build(self);
+    }
 }
 
 enum GetAllExtDevicePropInfoUpdateMode {
@@ -3752,6 +4303,10 @@ static AwResult SDIO_GetAllExtDevicePropInfo(AwControl* self, b32 initial, b32 i
     PTPResponse r = SendReq(self, &req);
     RETURN_IF_FAIL(r);
 
+    // The transfer is done, only hold the state lock while the response is parsed into the property list
+    StateLockExclusive(self);
+    MArrayClear(self->changedProperties);
+
     u64 numProperties = 0;
     MMemReadU64LE(&r.memIo, &numProperties);
 
@@ -3762,6 +4317,11 @@ static AwResult SDIO_GetAllExtDevicePropInfo(AwControl* self, b32 initial, b32 i
     }
 
     SetMetadataForProperties(self);
+    StateUnlockExclusive(self);
+
+    if (self->propSnapshotsEnabled && (MArraySize(self->changedProperties) || !self->propSnapshot)) {
+        PublishPropertySnapshot(self, TRUE, self->changedProperties, MArraySize(self->changedProperties));
+    }
 
     return r.result;
 }
@@ -3955,7 +4515,7 @@ static AwResult SDIO_GetExtDeviceInfo(AwControl* self, u32 protocolVersion, b32
     for (int i = 0; i < numProperties; i++) {
         u16 propCode = 0;
         MMemReadU16LE(&r.memIo, &propCode);
-        MArrayAdd(self->allocator, self->supportedProperties, propCode);
+        AddSupportedCode(self, &self->supportedProperties, &self->supportedPropertySet, propCode);
     }
 
     u32 numControls = 0;
@@ -3963,7 +4523,7 @@ static AwResult SDIO_GetExtDeviceInfo(AwControl* self, u32 protocolVersion, b32
     for (int i = 0; i < numControls; i++) {
         u16 controlCode = 0;
         MMemReadU16LE(&r.memIo, &controlCode);
-        MArrayAdd(self->allocator, self->supportedControls, controlCode);
+        AddSupportedCode(self, &self->supportedControls, &self->supportedControlSet, controlCode);
     }
 
     return r.result;
@@ -4003,132 +4563,403 @@ static AwResult AwGetObjectInfo(AwControl* self, u32 objectHandle, AwObjectInfo*
     return r.result;
 }
 
-static AwResult PTP_GetLiveViewImage(AwControl* self, size_t objectSize, MMemIO* fileOut, AwLiveViewFrames* liveViewFrames) {
-    fileOut->size = 0;
+// Frame arrays are allocated once with room for AW_LIVE_VIEW_FRAMES_MAX entries and never grown, so parsing frames
+// doesn't allocate once the arrays exist
+#define LIVE_VIEW_FRAMES_RESERVE(allocator, frames) \
+    if (!(frames)) { MArrayInit((allocator), (frames), AW_LIVE_VIEW_FRAMES_MAX); } \
+    MArrayClear(frames)
+
+#define LIVE_VIEW_FRAME_RECORD_SIZE 24
+
+// Read a frame block header, returns the number of frames to read.  Frames that don't fit in 'capacity' are counted
+// in 'outSkip' to be stepped over.
+static u16 ReadLiveViewFrameHeader(MMemIO* memIo, u32* xDenominator, u32* yDenominator, size_t capacity,
+                                   u16* outSkip) {
+    MMemReadU32LE(memIo, xDenominator);
+    MMemReadU32LE(memIo, yDenominator);
+    u16 frameNum = 0;
+    MMemReadU16LE(memIo, &frameNum);
+    MMemReadSkipBytes(memIo, 6);
+    u16 count = frameNum < capacity ? frameNum : (u16)capacity;
+    *outSkip = frameNum - count;
+    return count;
+}
 
-    PTPResponse r = DoRequest(self,
-                              PTP_OC_GetObject,
-                              0,
-                              objectSize + 0x100,
-                              1,
-                              SD_OH_LIVE_VIEW_IMAGE);
+static void ParseLiveViewFocusFrames(MMemIO* memIo, AwFocusFrames* focusFrames) {
+    u16 skip = 0;
+    u16 count = ReadLiveViewFrameHeader(memIo, &focusFrames->xDenominator, &focusFrames->yDenominator,
+                                        MArrayCapacity(focusFrames->frames), &skip);
+    for (int i = 0; i < count; ++i) {
+        AwFocusFrame* focusFrame = focusFrames->frames + i;
+        MMemReadU16LE(memIo, &focusFrame->frameType);
+        MMemReadU16LE(memIo, &focusFrame->focusFrameState);
+        MMemReadU8(memIo, &focusFrame->priority);
+        MMemReadSkipBytes(memIo, 3);
+        MMemReadU32LE(memIo, &focusFrame->x);
+        MMemReadU32LE(memIo, &focusFrame->y);
+        MMemReadU32LE(memIo, &focusFrame->width);
+        MMemReadU32LE(memIo, &focusFrame->height);
+    }
+    M_ArrayHeader(focusFrames->frames)->size = count;
+    MMemReadSkipBytes(memIo, skip * LIVE_VIEW_FRAME_RECORD_SIZE);
+}
 
-    RETURN_IF_FAIL(r);
+static void ParseLiveViewFaceFrames(MMemIO* memIo, AwFaceFrames* faceFrames) {
+    u16 skip = 0;
+    u16 count = ReadLiveViewFrameHeader(memIo, &faceFrames->xDenominator, &faceFrames->yDenominator,
+                                        MArrayCapacity(faceFrames->frames), &skip);
+    for (int i = 0; i < count; ++i) {
+        AwFocusFrameFace* faceFrame = faceFrames->frames + i;
+        u8 selectionState = 0;
+        MMemReadU16LE(memIo, &faceFrame->faceFrameType);
+        MMemReadU16LE(memIo, &faceFrame->faceFocusFrameState);
+        MMemReadU8(memIo, &selectionState);
+        faceFrame->selectionState = selectionState;
+        MMemReadU8(memIo, &faceFrame->priority);
+        MMemReadSkipBytes(memIo, 2);
+        MMemReadU32LE(memIo, &faceFrame->xNumerator);
+        MMemReadU32LE(memIo, &faceFrame->yNumerator);
+        MMemReadU32LE(memIo, &faceFrame->width);
+        MMemReadU32LE(memIo, &faceFrame->height);
+    }
+    M_ArrayHeader(faceFrames->frames)->size = count;
+    MMemReadSkipBytes(memIo, skip * LIVE_VIEW_FRAME_RECORD_SIZE);
+}
 
-    b32 readFocalFrame = FALSE;
-    if (self->protocolVersion >= SDI_EXTENSION_VERSION_300 && liveViewFrames != NULL) {
-        readFocalFrame = TRUE;
-    }
+static void ParseLiveViewTrackingFrames(MMemIO* memIo, AwTrackingFrames* trackingFrames) {
+    u16 skip = 0;
+    u16 count = ReadLiveViewFrameHeader(memIo, &trackingFrames->xDenominator, &trackingFrames->yDenominator,
+                                        MArrayCapacity(trackingFrames->frames), &skip);
+    for (int i = 0; i < count; ++i) {
+        AwFocusFrameTracking* trackingFrame = trackingFrames->frames + i;
+        MMemReadU16LE(memIo, &trackingFrame->trackingFrameType);
+        MMemReadU16LE(memIo, &trackingFrame->trackingFrameState);
+        MMemReadU8(memIo, &trackingFrame->priority);
+        MMemReadSkipBytes(memIo, 3);
+        MMemReadU32LE(memIo, &trackingFrame->xNumerator);
+        MMemReadU32LE(memIo, &trackingFrame->yNumerator);
+        MMemReadU32LE(memIo, &trackingFrame->width);
+        MMemReadU32LE(memIo, &trackingFrame->height);
+    }
+    M_ArrayHeader(trackingFrames->frames)->size = count;
+    MMemReadSkipBytes(memIo, skip * LIVE_VIEW_FRAME_RECORD_SIZE);
+}
 
+// Parse the live view dataset: the focal frame block (if requested) and the location of the JPEG.  'outJpeg' is set
+// to a read view of the JPEG inside 'memIo', nothing is copied.
+static AwResult ParseLiveViewImage(AwControl* self, MMemIO* memIo, MMemIO* outJpeg, AwLiveViewFrames* liveViewFrames) {
     u32 offsetImage = 0;
-    MMemReadU32LE(&r.memIo, &offsetImage);
+    MMemReadU32LE(memIo, &offsetImage);
 
     u32 imageSize = 0;
-    MMemReadU32LE(&r.memIo, &imageSize);
+    MMemReadU32LE(memIo, &imageSize);
+
+    if (offsetImage > memIo->capacity || imageSize > memIo->capacity - offsetImage) {
+        AW_ERROR_F("Live view image out of bounds: %u + %u > %u", offsetImage, imageSize, memIo->capacity);
+        return RESULT_CODE(AW_RESULT_PARAM_ERROR);
+    }
+
+    if (liveViewFrames != NULL) {
+        AwControl_ReserveLiveViewFrames(self, liveViewFrames);
+    }
 
-    if (readFocalFrame) {
+    if (self->protocolVersion >= SDI_EXTENSION_VERSION_300 && liveViewFrames != NULL) {
         u32 focalFrameOffset = 0;
-        MMemReadU32LE(&r.memIo, &focalFrameOffset);
+        MMemReadU32LE(memIo, &focalFrameOffset);
 
         u32 focalFrameSize = 0;
-        MMemReadU32LE(&r.memIo, &focalFrameSize);
+        MMemReadU32LE(memIo, &focalFrameSize);
 
-        if (focalFrameSize) {
-            r.memIo.size = focalFrameOffset;
+        if (focalFrameSize && focalFrameOffset <= memIo->capacity &&
+                focalFrameSize <= memIo->capacity - focalFrameOffset) {
+            MMemIO frameIo;
+            MMemInitRead(&frameIo, memIo->mem + focalFrameOffset, focalFrameSize);
 
-            MMemReadU16LE(&r.memIo, &liveViewFrames->version);
-            MMemReadSkipBytes(&r.memIo, 6 + 40);
+            MMemReadU16LE(&frameIo, &liveViewFrames->version);
+            MMemReadSkipBytes(&frameIo, 6 + 40);
 
             u16 reservedArrayNum = 0;
-            MMemReadU16LE(&r.memIo, &reservedArrayNum);
-            MMemReadSkipBytes(&r.memIo, 6);
+            MMemReadU16LE(&frameIo, &reservedArrayNum);
+            MMemReadSkipBytes(&frameIo, 6);
             if (reservedArrayNum) {
-                MMemReadSkipBytes(&r.memIo, reservedArrayNum * 24);
+                MMemReadSkipBytes(&frameIo, reservedArrayNum * 24);
             }
 
-            AwFocusFrames* focusFrames = &liveViewFrames->focus;
-            MMemReadU32LE(&r.memIo, &focusFrames->xDenominator);
-            MMemReadU32LE(&r.memIo, &focusFrames->yDenominator);
-
-            u16 frameNum = 0;
-            MMemReadU16LE(&r.memIo, &frameNum);
-
-            MMemReadSkipBytes(&r.memIo, 6);
-
-            if (frameNum) {
-                MArrayInit(self->allocator, focusFrames->frames, frameNum);
-                MArrayClear(focusFrames->frames);
-
-                for (int i = 0; i < frameNum; ++i) {
-                    AwFocusFrame* focusFrame = MArrayAddPtr(self->allocator, focusFrames->frames);
-                    MMemReadU16LE(&r.memIo, &focusFrame->frameType);
-                    MMemReadU16LE(&r.memIo, &focusFrame->focusFrameState);
-                    MMemReadU8(&r.memIo, &focusFrame->priority);
-                    MMemReadSkipBytes(&r.memIo, 3);
-                    MMemReadU32LE(&r.memIo, &focusFrame->x);
-                    MMemReadU32LE(&r.memIo, &focusFrame->y);
-                    MMemReadU32LE(&r.memIo, &focusFrame->width);
-                    MMemReadU32LE(&r.memIo, &focusFrame->height);
-                }
-            } else if (focusFrames->frames) {
-                MArrayClear(focusFrames->frames);
+            ParseLiveViewFocusFrames(&frameIo, &liveViewFrames->focus);
+            if (liveViewFrames->version > 101) {
+                ParseLiveViewFaceFrames(&frameIo, &liveViewFrames->face);
+                ParseLiveViewTrackingFrames(&frameIo, &liveViewFrames->tracking);
             }
-
-            // Parse Face & tracking frames
-            // if (liveViewFrames->version > 101) {
-            // }
         }
     }
 
-    fileOut->size = 0;
-    fileOut->allocator = self->allocator;
-    MMemWriteU8CopyN(fileOut, r.memIo.mem + offsetImage, imageSize);
+    MMemInitRead(outJpeg, memIo->mem + offsetImage, imageSize);
+    return RESULT_OK();
+}
+
+// Live view frame size from ObjectInfo, without reading (and allocating) the ObjectInfo strings
+static AwResult Aw_GetLiveViewObjectSize(AwControl* self, u32* outSize) {
+    PTPResponse r = DoRequest(self,
+                              PTP_OC_GetObjectInfo,
+                              0,
+                              0x1000,
+                              1,
+                              SD_OH_LIVE_VIEW_IMAGE);
+
+    RETURN_IF_FAIL(r);
 
+    // StorageID (u32), ObjectFormat (u16), ProtectionStatus (u16) then ObjectCompressedSize
+    MMemReadSkipBytes(&r.memIo, 8);
+    MMemReadU32LE(&r.memIo, outSize);
     return r.result;
 }
 
-static AwResult Aw_GetObject(AwControl* self, u32 objectHandle, size_t objectSize, MMemIO* fileOut) {
-    AW_TRACE("Aw_GetObject");
-    fileOut->size = 0;
-    fileOut->allocator = self->allocator;
-
+static AwResult PTP_GetLiveViewImage(AwControl* self, size_t objectSize, MMemIO* outData) {
     PTPResponse r = DoRequest(self,
                               PTP_OC_GetObject,
                               0,
-                              objectSize,
+                              objectSize + 0x100,
                               1,
-                              objectHandle);
+                              SD_OH_LIVE_VIEW_IMAGE);
 
     RETURN_IF_FAIL(r);
 
-    MMemReadCopy(&r.memIo, fileOut, r.memIo.capacity);
-
+    *outData = r.memIo;
     return r.result;
 }
 
-int AwControl_GetPendingFiles(AwControl* self) {
-    AwPtpProperty* property = AwControl_GetPropertyByCode(self, DPC_PENDING_FILES);
+static void RecordLiveViewFrameSize(AwControl* self, u32 size) {
+    self->liveViewFrameSizes[self->liveViewFrameIndex] = size;
+    self->liveViewFrameIndex = (self->liveViewFrameIndex + 1) % AW_LIVE_VIEW_SIZE_HISTORY;
+}
+
+// Buffer size for the next live view frame, the largest recent frame with a quarter again as headroom, frame sizes
+// vary with scene detail.  0 if no frames have been seen yet.
+static u32 EstimateLiveViewFrameSize(AwControl* self) {
+    u32 largest = 0;
+    for (int i = 0; i < AW_LIVE_VIEW_SIZE_HISTORY; ++i) {
+        if (self->liveViewFrameSizes[i] > largest) {
+            largest = self->liveViewFrameSizes[i];
+        }
+    }
+    if (!largest) {
+        return 0;
+    }
+    return largest + (largest / 4) + 0x1000;
+}
+
+static AwResult SendGetLiveViewImage(AwControl* self, size_t bufferSize, AwDataSink* sink) {
+    AwPtpRequestHeader req = BuildReq(self, 0, bufferSize, PTP_OC_GetObject);
+    req.Params[0] = SD_OH_LIVE_VIEW_IMAGE;
+    req.NumParams = 1;
+    *sink = (AwDataSink){.mem = self->dataOutMem, .capacity = self->dataOutCapacity};
+    AwResult r = self->device->transport.sendAndRecvSink(self->device, &req, self->dataInMem, 0, &self->ptpResponse,
+                                                        sink);
+    if (IS_OK(r)) {
+        r.ptp = self->ptpResponse.ResponseCode;
+        if (r.ptp != PTP_OK) {
+            r.code = AW_RESULT_PTP_FAILURE;
+        }
+    }
+    return r;
+}
+
+// Fetch a live view frame with a single GetObject, skipping the GetObjectInfo round trip
+static AwResult Aw_GetLiveViewImageSingleRequest(AwControl* self, MMemIO* outData) {
+    u32 estimate = EstimateLiveViewFrameSize(self);
+    if (!estimate) {
+        // First frame, learn the size the slow way
+        u32 objectSize = 0;
+        AwResult r = Aw_GetLiveViewObjectSize(self, &objectSize);
+        if (!IS_OK(r)) {
+            return r;
+        }
+        r = PTP_GetLiveViewImage(self, objectSize, outData);
+        if (IS_OK(r)) {
+            RecordLiveViewFrameSize(self, objectSize + 0x100);
+        }
+        return r;
+    }
+
+    AwDataSink sink;
+    AwResult r = SendGetLiveViewImage(self, estimate, &sink);
+    if (r.code == AW_RESULT_BUFFER_TOO_SMALL && sink.required) {
+        // The frame outgrew the estimate, the transport drained it, so ask again for one that fits
+        AW_DEBUG_F("Live view frame %llu > %u, retrying", (u64)sink.required, estimate);
+        self->liveViewRetries++;
+        RecordLiveViewFrameSize(self, (u32)sink.required);
+        r = SendGetLiveViewImage(self, sink.required, &sink);
+    }
+    if (!IS_OK(r)) {
+        return r;
+    }
+
+    RecordLiveViewFrameSize(self, (u32)sink.size);
+
+    MMemInitRead(outData, self->dataOutMem, (u32)sink.size);
+    return r;
+}
+
+// Receive the live view dataset into the transport out buffer, 'outData' is set to a read view of it
+static AwResult Aw_FetchLiveViewImage(AwControl* self, MMemIO* outData) {
+    if (self->liveViewMode == AW_LIVE_VIEW_MODE_SINGLE_REQUEST && self->device->transport.sendAndRecvSink) {
+        return Aw_GetLiveViewImageSingleRequest(self, outData);
+    }
+    u32 objectSize = 0;
+    AwResult r = Aw_GetLiveViewObjectSize(self, &objectSize);
+    if (!IS_OK(r)) {
+        return r;
+    }
+    return PTP_GetLiveViewImage(self, objectSize, outData);
+}
+
+static AwResult SendGetObjectSink(AwControl* self, u32 objectHandle, AwDataSink* sink) {
+    AwPtpRequestHeader req = BuildReq(self, 0, 0, PTP_OC_GetObject);
+    req.Params[0] = objectHandle;
+    req.NumParams = 1;
+    return self->device->transport.sendAndRecvSink(self->device, &req, self->dataInMem, 0, &self->ptpResponse, sink);
+}
+
+// Receive an object straight into 'dest' when the transport supports it, saving the copy out of (and the allocation
+// of) an object sized transport buffer.  'dest' is grown with its allocator if it's too small.
+static AwResult Aw_GetObjectInto(AwControl* self, u32 objectHandle, size_t objectSize, MMemIO* dest) {
+    AW_TRACE("Aw_GetObjectInto");
+    dest->size = 0;
+    if (dest->capacity < objectSize) {
+        if (!dest->allocator) {
+            AW_ERROR_F("Destination too small for object: %d < %d", dest->capacity, (int)objectSize);
+            return RESULT_CODE(AW_RESULT_PARAM_ERROR);
+        }
+        MMemGrowBytes(dest, (u32)objectSize);
+    }
+
+    if (!self->device->transport.sendAndRecvSink) {
+        PTPResponse r = DoRequest(self,
+                                  PTP_OC_GetObject,
+                                  0,
+                                  objectSize,
+                                  1,
+                                  objectHandle);
+
+        RETURN_IF_FAIL(r);
+
+        u32 size = r.memIo.capacity < dest->capacity ? r.memIo.capacity : dest->capacity;
+        MMemReadU8CopyN(&r.memIo, dest->mem, size);
+        dest->size = size;
+        return r.result;
+    }
+
+    AwDataSink sink = {.mem = dest->mem, .capacity = dest->capacity};
+    AwResult r = SendGetObjectSink(self, objectHandle, &sink);
+    dest->size = (u32)sink.size;
+    return r;
+}
+
+// Stream an object to sink->write() in chunks as it's received
+static AwResult Aw_GetObjectStream(AwControl* self, u32 objectHandle, size_t objectSize, AwDataSink* sink) {
+    AW_TRACE("Aw_GetObjectStream");
+    AwResult result;
+    if (self->device->transport.sendAndRecvSink) {
+        result = SendGetObjectSink(self, objectHandle, sink);
+    } else {
+        // Transport can't stream, receive the whole object and then pass it on in chunks
+        PTPResponse r = DoRequest(self,
+                                  PTP_OC_GetObject,
+                                  0,
+                                  objectSize,
+                                  1,
+                                  objectHandle);
+
+        RETURN_IF_FAIL(r);
+
+        size_t chunkSize = AwDataSink_GetChunkSize(sink);
+        for (size_t offset = 0; offset < r.memIo.capacity; offset += chunkSize) {
+            size_t size = r.memIo.capacity - offset;
+            AwDataSink_Write(sink, r.memIo.mem + offset, size < chunkSize ? size : chunkSize);
+        }
+        result = r.result;
+    }
+    if (IS_OK(result) && sink->aborted) {
+        result = RESULT_CODE(AW_RESULT_CANCELLED);
+    }
+    return result;
+}
+
+static int PendingFilesFromProperty(const AwPtpProperty* property) {
     if (property != NULL && property->dataType == PTP_DT_UINT16) {
         u16 value = property->value.u16;
         if (value & 0x8000) {
             value = value & 0x7fff;
         }
-        AW_TRACE_F("AwControl_GetPendingFiles -> %d", value);
         return value;
     }
     return 0;
 }
 
+int AwControl_GetPendingFiles(AwControl* self) {
+    int value = PendingFilesFromProperty(AwControl_GetPropertyByCode(self, DPC_PENDING_FILES));
+    AW_TRACE_F("AwControl_GetPendingFiles -> %d", value);
+    return value;
+}
+
+int AwPropertySnapshot_GetPendingFiles(const AwPropertySnapshot* snapshot) {
+    return PendingFilesFromProperty(AwPropertySnapshot_GetProperty(snapshot, DPC_PENDING_FILES));
+}
+
+void AwControl_SetLiveViewMode(AwControl* self, AwLiveViewMode mode) {
+    self->liveViewMode = mode;
+    memset(self->liveViewFrameSizes, 0, sizeof(self->liveViewFrameSizes));
+    self->liveViewFrameIndex = 0;
+}
+
 AwResult AwControl_GetLiveViewImage(AwControl* self, MMemIO* fileOut, AwLiveViewFrames* liveViewFramesOut) {
     AW_TRACE("AwControl_GetLiveViewImage");
-    AwObjectInfo objectInfo = {};
-    AwResult r = AwGetObjectInfo(self, SD_OH_LIVE_VIEW_IMAGE, &objectInfo);
+    fileOut->size = 0;
+    MMemIO jpeg;
+    AwResult r = AwControl_GetLiveViewImageView(self, &jpeg, liveViewFramesOut);
     if (!IS_OK(r)) {
         return r;
     }
-    // Free strings - we dont use them
-    Aw_FreeObjectInfo(self->allocator, &objectInfo);
-    return PTP_GetLiveViewImage(self, objectInfo.objectCompressedSize, fileOut, liveViewFramesOut);
+    fileOut->allocator = self->allocator;
+    MMemWriteU8CopyN(fileOut, jpeg.mem, jpeg.capacity);
+    return r;
+}
+
+AwResult AwControl_GetLiveViewImageView(AwControl* self, MMemIO* outJpeg, AwLiveViewFrames* liveViewFramesOut) {
+    AW_TRACE("AwControl_GetLiveViewImageView");
+#ifdef M_ASSERT
+    // Once the frame arrays exist and the transport buffer fits the frame nothing should be allocated
+    b32 framesReserved = !liveViewFramesOut || (liveViewFramesOut->focus.frames && liveViewFramesOut->face.frames &&
+                                                liveViewFramesOut->tracking.frames);
+    AwLiveViewFrames framesBefore = liveViewFramesOut ? *liveViewFramesOut : (AwLiveViewFrames){};
+    u32 capacityBefore = self->dataOutCapacity;
+    u32 retriesBefore = self->liveViewRetries;
+    u32 growsBefore = self->dataBufferStats.resizeCount - self->dataBufferStats.shrinkCount;
+#endif
+
+    MMemIO data;
+    AwResult r = Aw_FetchLiveViewImage(self, &data);
+    if (IS_OK(r)) {
+        r = ParseLiveViewImage(self, &data, outJpeg, liveViewFramesOut);
+    }
+
+#ifdef M_ASSERT
+    if (framesReserved && capacityBefore >= self->dataOutSize && retriesBefore == self->liveViewRetries) {
+        MAssertf(self->dataBufferStats.resizeCount - self->dataBufferStats.shrinkCount == growsBefore,
+                 "Live view grew the transport buffer in steady state (%u bytes)", self->dataOutSize);
+        MAssert(!liveViewFramesOut || (framesBefore.focus.frames == liveViewFramesOut->focus.frames &&
+                                       framesBefore.face.frames == liveViewFramesOut->face.frames &&
+                                       framesBefore.tracking.frames == liveViewFramesOut->tracking.frames),
+                "Live view reallocated frame arrays in steady state");
+    }
+#endif
+    return r;
+}
+
+void AwControl_ReserveLiveViewFrames(AwControl* self, AwLiveViewFrames* liveViewFrames) {
+    LIVE_VIEW_FRAMES_RESERVE(self->allocator, liveViewFrames->focus.frames);
+    LIVE_VIEW_FRAMES_RESERVE(self->allocator, liveViewFrames->face.frames);
+    LIVE_VIEW_FRAMES_RESERVE(self->allocator, liveViewFrames->tracking.frames);
 }
 
 AwResult AwControl_GetOSDImage(AwControl* self, MMemIO* fileOut) {
@@ -4163,8 +4994,9 @@ AwResult AwControl_GetOSDImage(AwControl* self, MMemIO* fileOut) {
     return r.result;
 }
 
-AwResult AwControl_GetCapturedImage(AwControl* self, MMemIO* fileOut, AwPtpCapturedImageInfo* ciiOut) {
-    AW_TRACE("AwControl_GetCapturedImage");
+// Download the captured image into 'fileOut', or if 'stream' is set stream it to stream->write()
+static AwResult AwControl_GetCapturedImage_(AwControl* self, MMemIO* fileOut, AwDataSink* stream,
+                                            AwPtpCapturedImageInfo* ciiOut) {
     AwObjectInfo objectInfo = {};
     AwResult r = AwGetObjectInfo(self, SD_OH_CAPTURED_IMAGE, &objectInfo);
     if (!IS_OK(r)) {
@@ -4184,20 +5016,52 @@ AwResult AwControl_GetCapturedImage(AwControl* self, MMemIO* fileOut, AwPtpCaptu
     ciiOut->size = objectInfo.objectCompressedSize;
     MStrZero(&objectInfo.filename); // ownership has passed to ciiOut
     Aw_FreeObjectInfo(self->allocator, &objectInfo); // Free any other strings
-    r = Aw_GetObject(self, SD_OH_CAPTURED_IMAGE, objectInfo.objectCompressedSize, fileOut);
-    AW_DEBUG_F("Downloaded image size: %d", fileOut->size);
+    if (stream) {
+        r = Aw_GetObjectStream(self, SD_OH_CAPTURED_IMAGE, objectInfo.objectCompressedSize, stream);
+        AW_DEBUG_F("Streamed image size: %d", (int)stream->size);
+    } else {
+        r = Aw_GetObjectInto(self, SD_OH_CAPTURED_IMAGE, objectInfo.objectCompressedSize, fileOut);
+        AW_DEBUG_F("Downloaded image size: %d", fileOut->size);
+    }
     return r;
 }
 
+AwResult AwControl_GetCapturedImage(AwControl* self, MMemIO* fileOut, AwPtpCapturedImageInfo* ciiOut) {
+    AW_TRACE("AwControl_GetCapturedImage");
+    fileOut->allocator = self->allocator;
+    return AwControl_GetCapturedImage_(self, fileOut, NULL, ciiOut);
+}
+
+AwResult AwControl_GetCapturedImageInto(AwControl* self, MMemIO* dest, AwPtpCapturedImageInfo* ciiOut) {
+    AW_TRACE("AwControl_GetCapturedImageInto");
+    return AwControl_GetCapturedImage_(self, dest, NULL, ciiOut);
+}
+
+AwResult AwControl_GetCapturedImageStream(AwControl* self, size_t chunkSize, AwDataSink_Write_Func write,
+                                          void* userData, AwPtpCapturedImageInfo* ciiOut) {
+    AW_TRACE("AwControl_GetCapturedImageStream");
+    if (write == NULL) {
+        return RESULT_CODE(AW_RESULT_PARAM_ERROR);
+    }
+    AwDataSink stream = {.write = write, .userData = userData, .chunkSize = chunkSize};
+    return AwControl_GetCapturedImage_(self, NULL, &stream, ciiOut);
+}
+
 AwResult AwControl_GetCameraSettingsFile(AwControl* self, MMemIO* fileOut) {
     AW_TRACE("AwControl_GetCameraSettingsFile");
+    fileOut->allocator = self->allocator;
+    return AwControl_GetCameraSettingsFileInto(self, fileOut);
+}
+
+AwResult AwControl_GetCameraSettingsFileInto(AwControl* self, MMemIO* dest) {
+    AW_TRACE("AwControl_GetCameraSettingsFileInto");
     AwObjectInfo objectInfo = {};
     AwResult r = AwGetObjectInfo(self, SD_OH_CAMERA_SETTINGS, &objectInfo);
     if (!IS_OK(r)) {
         return r;
     }
     Aw_FreeObjectInfo(self->allocator, &objectInfo);
-    return Aw_GetObject(self, SD_OH_CAMERA_SETTINGS, objectInfo.objectCompressedSize, fileOut);
+    return Aw_GetObjectInto(self, SD_OH_CAMERA_SETTINGS, objectInfo.objectCompressedSize, dest);
 }
 
 AwResult AwControl_ReadEvents(AwControl* self, int timeoutMilliseconds, MAllocator* alloc, AwPtpEvent** eventsOut) {
@@ -4211,14 +5075,83 @@ AwResult AwControl_ReadEvents(AwControl* self, int timeoutMilliseconds, MAllocat
         return RESULT_CODE(AW_RESULT_PARAM_ERROR);
     }
 
-    return self->device->transport.readEvents(self->device, timeoutMilliseconds, alloc, eventsOut);
+    AwResult r = self->device->transport.readEvents(self->device, timeoutMilliseconds, alloc, eventsOut);
+    AwControl_HandleEvents(self, *eventsOut);
+    return r;
 }
 
-AwResult AwControl_GetMagnifier(AwControl* self, AwMagnifier* outMagnifier) {
-    AW_TRACE("AwControl_GetMagnifier");
-    AwPtpProperty* propMagPos = AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY_POS);
+void AwControl_HandleEvents(AwControl* self, AwPtpEvent* events) {
+    // May be called from the event dispatcher's thread while another thread syncs, the pending state is only
+    // read and written with the state lock held so an event can't be lost between the check and the clear
+    StateLockExclusive(self);
+    if (self->propSyncEnabled) {
+        MArrayEachPtr(events, it) {
+            if (it.p->code == PTP_DevicePropChanged) {
+                if (!self->propSyncPendingSince) {
+                    self->propSyncPendingSince = MGetTimeMilliseconds();
+                }
+                self->propSyncEventCount++;
+            }
+        }
+    }
+    StateUnlockExclusive(self);
+}
+
+AwResult AwControl_SetPropertySync(AwControl* self, b32 enabled, u32 coalesceMilliseconds) {
+    AW_TRACE("AwControl_SetPropertySync");
+
+    if (enabled) {
+        if (!self->device->transport.readEvents || !AwControl_SupportsEvent(self, PTP_DevicePropChanged)) {
+            return RESULT_CODE(AW_RESULT_NOT_SUPPORTED);
+        }
+        self->propSyncCoalesceMilliseconds = coalesceMilliseconds ? coalesceMilliseconds :
+                                             AW_PROPERTY_SYNC_COALESCE_DEFAULT_MS;
+    }
+    StateLockExclusive(self);
+    self->propSyncEnabled = enabled;
+    self->propSyncPendingSince = 0;
+    self->propSyncEventCount = 0;
+    StateUnlockExclusive(self);
+    return RESULT_OK();
+}
+
+AwResult AwControl_SyncProperties(AwControl* self, b32* outUpdated) {
+    *outUpdated = FALSE;
+
+    // Check and clear in one go, events handled on another thread after this start a new window
+    StateLockExclusive(self);
+    u64 now = MGetTimeMilliseconds();
+    if (!self->propSyncEnabled || !self->propSyncPendingSince ||
+        now - self->propSyncPendingSince < self->propSyncCoalesceMilliseconds) {
+        StateUnlockExclusive(self);
+        return RESULT_OK();
+    }
+
+    AW_TRACE_F("AwControl_SyncProperties: %u change events", self->propSyncEventCount);
+
+    // Events arriving from here on are for changes the refresh may not include, they start a new window
+    self->propSyncPendingSince = 0;
+    self->propSyncEventCount = 0;
+    StateUnlockExclusive(self);
+
+    AwResult r = SDIO_GetAllExtDevicePropInfo(self, FALSE, TRUE, TRUE);
+    if (IS_OK(r)) {
+        *outUpdated = TRUE;
+    } else {
+        StateLockExclusive(self);
+        if (!self->propSyncPendingSince) {
+            // Retry after another window
+            self->propSyncPendingSince = now;
+        }
+        StateUnlockExclusive(self);
+    }
+    return r;
+}
+
+// Shared by the session and snapshot versions, the properties come from whichever is being read
+static AwResult MagnifierFromProperties(const AwPtpProperty* propMagPos, const AwPtpProperty* propMagScale,
+                                        const AwPtpProperty* propMag, AwMagnifier* outMagnifier) {
     if (propMagPos) {
-        AwPtpProperty* propMagScale = AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY_SCALE);
 
         u32 posValue = propMagPos->value.u32;
         i32 x = (i32)((posValue >> 16) & 0xffff);
@@ -4241,7 +5174,6 @@ AwResult AwControl_GetMagnifier(AwControl* self, AwMagnifier* outMagnifier) {
 
         return RESULT_OK();
     } else {
-        AwPtpProperty* propMag = AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY);
         if (propMag) {
             u64 cyrValue = propMag->value.u64;
             i32 curRatio = (i32)((cyrValue >> 32) & 0x7fffffff);
@@ -4286,6 +5218,19 @@ AwResult AwControl_GetMagnifier(AwControl* self, AwMagnifier* outMagnifier) {
     return RESULT_CODE(AW_RESULT_NOT_SUPPORTED);
 }
 
+AwResult AwControl_GetMagnifier(AwControl* self, AwMagnifier* outMagnifier) {
+    AW_TRACE("AwControl_GetMagnifier");
+    return MagnifierFromProperties(AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY_POS),
+                                   AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY_SCALE),
+                                   AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY), outMagnifier);
+}
+
+AwResult AwPropertySnapshot_GetMagnifier(const AwPropertySnapshot* snapshot, AwMagnifier* outMagnifier) {
+    return MagnifierFromProperties(AwPropertySnapshot_GetProperty(snapshot, DPC_FOCUS_MAGNIFY_POS),
+                                   AwPropertySnapshot_GetProperty(snapshot, DPC_FOCUS_MAGNIFY_SCALE),
+                                   AwPropertySnapshot_GetProperty(snapshot, DPC_FOCUS_MAGNIFY), outMagnifier);
+}
+
 AwResult AwControl_SetMagnifier(AwControl* self, AwMagnifierSet magnifier) {
     AW_TRACE("AwControl_SetMagnifier");
     AwPtpProperty* propMag = AwControl_GetPropertyByCode(self, DPC_FOCUS_MAGNIFY);
@@ -4376,6 +5321,25 @@ AwResult AwControl_Init(AwControl* self, AwDevice* device, MAllocator* allocator
     self->device->transport.allocator = allocator;
     self->logger = device->logger;
     self->allocator = allocator;
+#ifdef M_ASSERT
+    CheckCodeTablesSorted();
+#endif
+
+    if (!self->sync) {
+        AwControlSync* sync = MMallocZ(allocator, sizeof(AwControlSync));
+#ifdef _WIN32
+        InitializeSRWLock(&sync->stateLock);
+        InitializeCriticalSection(&sync->transportLock);
+        InitializeConditionVariable(&sync->transportCond);
+        InitializeCriticalSection(&sync->snapshotLock);
+#else
+        pthread_rwlock_init(&sync->stateLock, NULL);
+        pthread_mutex_init(&sync->transportLock, NULL);
+        pthread_cond_init(&sync->transportCond, NULL);
+        pthread_mutex_init(&sync->snapshotLock, NULL);
+#endif
+        self->sync = sync;
+    }
     return RESULT_OK();
 }
 
@@ -4384,21 +5348,11 @@ static void SDIO_InitControlsMetadata200(AwControl *self, size_t numControls) {
         u16 controlCode = self->supportedControls[i];
         AwPtpControl* control = AwControl_GetControlByCode(self, controlCode);
         if (!control) {
-            control = MArrayAddPtr(self->allocator, self->controls);
-
-            b32 found = FALSE;
-            size_t numControlsMeta = MStaticArraySize(sAwControlsMetadata);
-            for (int j = 0; j < numControlsMeta; j++) {
-                AwPtpControl *meta = sAwControlsMetadata + j;
-                if (meta->controlCode == controlCode) {
-                    memcpy(control, meta, sizeof(AwPtpControl));
-                    found = TRUE;
-                    break;
-                }
-            }
-            if (!found) {
-                memset(control, 0, sizeof(AwPtpControl));
-                control->controlCode = controlCode;
+            control = AddControl(self, controlCode);
+
+            AwPtpControl* meta = FindControlMetadata(controlCode);
+            if (meta) {
+                memcpy(control, meta, sizeof(AwPtpControl));
             }
         }
     }
@@ -4406,22 +5360,15 @@ static void SDIO_InitControlsMetadata200(AwControl *self, size_t numControls) {
 
 static void SDIO_InitControlsMetadata300(AwControl *self, size_t numControls) {
     MArrayInit(self->allocator, self->controls, numControls);
+    CodeIndex_Clear(&self->controlIndex);
     for (int i = 0; i < numControls; i++) {
         u16 controlCode = self->supportedControls[i];
 
-        AwPtpControl* control = MArrayAddPtr(self->allocator, self->controls);
-        b32 found = FALSE;
-        size_t numControlsMeta = MStaticArraySize(sAwControlsMetadata);
-        for (int j = 0; j < numControlsMeta; j++) {
-            AwPtpControl* meta = sAwControlsMetadata + j;
-            if (meta->controlCode == controlCode) {
-                memcpy(control, meta, sizeof(AwPtpControl));
-                found = TRUE;
-                break;
-            }
-        }
-        if (!found) {
-            memset(control, 0, sizeof(AwPtpControl));
+        AwPtpControl* control = AddControl(self, controlCode);
+        AwPtpControl* meta = FindControlMetadata(controlCode);
+        if (meta) {
+            memcpy(control, meta, sizeof(AwPtpControl));
+        } else {
             control->dataType = PTP_DT_UINT16;
             control->controlType = SDI_CONTROL_BUTTON;
             control->formFlag = PTP_FORM_FLAG_ENUM;
@@ -4432,8 +5379,7 @@ static void SDIO_InitControlsMetadata300(AwControl *self, size_t numControls) {
     }
 }
 
-AwResult AwControl_Connect(AwControl* self, AwSonyProtocolVersion version) {
-    AW_TRACE_F("AwControl_Connect 0x04%x", version);
+static AwResult Connect(AwControl* self, AwSonyProtocolVersion version) {
     AwResult r;
 
     ////////////////////////////////////////////
@@ -4543,6 +5489,14 @@ AwResult AwControl_Connect(AwControl* self, AwSonyProtocolVersion version) {
     return RESULT_OK();
 }
 
+AwResult AwControl_Connect(AwControl* self, AwSonyProtocolVersion version) {
+    AW_TRACE_F("AwControl_Connect 0x04%x", version);
+    AwControl_AcquireTransport(self, -1);
+    AwResult r = Connect(self, version);
+    AwControl_ReleaseTransport(self);
+    return r;
+}
+
 AwResult AwControl_Cleanup(AwControl* self) {
     AW_TRACE("AwControl_Cleanup");
 
@@ -4551,14 +5505,21 @@ AwResult AwControl_Cleanup(AwControl* self) {
     // Check for self->sessionId to ensure the session was successfully opened
     ////////////////////////////////////////////
     if (self->device->transport.requiresSessionOpenClose && self->sessionId) {
+        AwControl_AcquireTransport(self, -1);
         CloseSession(self);
+        AwControl_ReleaseTransport(self);
         self->sessionId = 0;
         self->transactionId = 0;
     }
 
     AwControl_FreeDataBuffers(self);
 
+    StateLockExclusive(self);
     self->protocolVersion = 0;
+    self->propSyncEnabled = FALSE;
+    self->propSyncPendingSince = 0;
+    memset(self->liveViewFrameSizes, 0, sizeof(self->liveViewFrameSizes));
+    self->liveViewFrameIndex = 0;
     self->standardVersion = 0;
 
     MArrayFree(self->allocator, self->supportedProperties);
@@ -4571,16 +5532,10 @@ AwResult AwControl_Cleanup(AwControl* self) {
         AwPtpProperty* property = self->properties + i;
         PropValueFree(self->allocator, property->dataType, &property->value);
         PropValueFree(self->allocator, property->dataType, &property->defaultValue);
-        if (property->formFlag == PTP_FORM_FLAG_ENUM) {
-            MArrayFree(self->allocator, property->form.enums.set);
-            MArrayFree(self->allocator, property->form.enums.getSet);
-        } else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
-            PropValueFree(self->allocator, property->dataType, &property->form.range.min);
-            PropValueFree(self->allocator, property->dataType, &property->form.range.max);
-            PropValueFree(self->allocator, property->dataType, &property->form.range.step);
-        }
+        PropertyFormFree(self->allocator, property);
     }
     MArrayFree(self->allocator, self->properties);
+    MArrayFree(self->allocator, self->changedProperties);
 
     for (int i = 0; i < MArraySize(self->controls); ++i) {
         AwPtpControl* control = self->controls + i;
@@ -4592,40 +5547,286 @@ AwResult AwControl_Cleanup(AwControl* self) {
     }
     MArrayFree(self->allocator, self->controls);
 
+    CodeSet_Free(self->allocator, &self->supportedEventSet);
+    CodeSet_Free(self->allocator, &self->supportedControlSet);
+    CodeSet_Free(self->allocator, &self->supportedPropertySet);
+    CodeIndex_Free(self->allocator, &self->propertyIndex);
+    CodeIndex_Free(self->allocator, &self->controlIndex);
+    PropertyIdIndex_Free(self->allocator, &self->propertyIdIndex);
+
     MStrFree(self->allocator, self->manufacturer);
     MStrFree(self->allocator, self->model);
     MStrFree(self->allocator, self->deviceVersion);
     MStrFree(self->allocator, self->serialNumber);
     MStrFree(self->allocator, self->vendorExtension);
+    StateUnlockExclusive(self);
+
+    self->propSnapshotsEnabled = FALSE;
+    PublishPropertySnapshot(self, FALSE, NULL, 0);
+
+    AwControlSync* sync = self->sync;
+    if (sync) {
+#ifdef _WIN32
+        DeleteCriticalSection(&sync->transportLock);
+        DeleteCriticalSection(&sync->snapshotLock);
+#else
+        pthread_rwlock_destroy(&sync->stateLock);
+        pthread_mutex_destroy(&sync->transportLock);
+        pthread_cond_destroy(&sync->transportCond);
+        pthread_mutex_destroy(&sync->snapshotLock);
+#endif
+        MFree(self->allocator, sync, sizeof(AwControlSync));
+        self->sync = NULL;
+    }
 
     return RESULT_OK();
 }
 
-b32 AwControl_SupportsEvent(AwControl* self, u16 eventCode) {
-    for (int i = 0; i < MArraySize(self->supportedEvents); ++i) {
-        if (self->supportedEvents[i] == eventCode) {
-            return TRUE;
-        }
+// Called with transportLock held, 0 is kept for 'no owner'
+static void NextTransportToken(AwControlSync* sync) {
+    if (++sync->transportToken == 0) {
+        sync->transportToken = 1;
     }
-    return FALSE;
 }
 
-b32 AwControl_SupportsControl(AwControl* self, u16 controlCode) {
-    for (int i = 0; i < MArraySize(self->supportedControls); ++i) {
-        if (self->supportedControls[i] == controlCode) {
-            return TRUE;
+AwResult AwControl_AcquireTransport(AwControl* self, int timeoutMilliseconds) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return RESULT_CODE(AW_RESULT_PARAM_ERROR);
+    }
+    u64 deadline = MGetTimeMilliseconds() + (timeoutMilliseconds > 0 ? timeoutMilliseconds : 0);
+    b32 acquired = FALSE;
+#ifdef _WIN32
+    EnterCriticalSection(&sync->transportLock);
+    if (CurrentThreadOwnsTransport(sync)) {
+        sync->transportDepth++;
+        LeaveCriticalSection(&sync->transportLock);
+        return RESULT_OK();
+    }
+    while (sync->transportDepth) {
+        u64 now = MGetTimeMilliseconds();
+        if (timeoutMilliseconds >= 0 && now >= deadline) {
+            break;
         }
+        SleepConditionVariableCS(&sync->transportCond, &sync->transportLock,
+                                 timeoutMilliseconds < 0 ? INFINITE : (DWORD)(deadline - now));
+    }
+    if (!sync->transportDepth) {
+        sync->transportDepth = 1;
+        sync->transportOwner = GetCurrentThreadId();
+        NextTransportToken(sync);
+        acquired = TRUE;
+    }
+    LeaveCriticalSection(&sync->transportLock);
+#else
+    pthread_mutex_lock(&sync->transportLock);
+    if (CurrentThreadOwnsTransport(sync)) {
+        sync->transportDepth++;
+        pthread_mutex_unlock(&sync->transportLock);
+        return RESULT_OK();
     }
-    return FALSE;
+    while (sync->transportDepth) {
+        if (timeoutMilliseconds < 0) {
+            pthread_cond_wait(&sync->transportCond, &sync->transportLock);
+            continue;
+        }
+        u64 now = MGetTimeMilliseconds();
+        if (now >= deadline) {
+            break;
+        }
+        u64 waitMs = deadline - now;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += (time_t)(waitMs / 1000);
+        ts.tv_nsec += (long)(waitMs % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&sync->transportCond, &sync->transportLock, &ts);
+    }
+    if (!sync->transportDepth) {
+        sync->transportDepth = 1;
+        sync->transportOwner = pthread_self();
+        NextTransportToken(sync);
+        acquired = TRUE;
+    }
+    pthread_mutex_unlock(&sync->transportLock);
+#endif
+    return acquired ? RESULT_OK() : RESULT_CODE(AW_RESULT_TIMEOUT);
 }
 
-b32 AwControl_SupportsProperty(AwControl* self, u16 propCode) {
-    for (int i = 0; i < MArraySize(self->supportedProperties); ++i) {
-        if (self->supportedProperties[i] == propCode) {
-            return TRUE;
-        }
+void AwControl_ReleaseTransport(AwControl* self) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return;
     }
-    return FALSE;
+#ifdef _WIN32
+    EnterCriticalSection(&sync->transportLock);
+    MAssert(CurrentThreadOwnsTransport(sync), "AwControl_ReleaseTransport() called by a thread that doesn't own it");
+    b32 released = sync->transportDepth && --sync->transportDepth == 0;
+    LeaveCriticalSection(&sync->transportLock);
+    if (released) {
+        WakeConditionVariable(&sync->transportCond);
+    }
+#else
+    pthread_mutex_lock(&sync->transportLock);
+    MAssert(CurrentThreadOwnsTransport(sync), "AwControl_ReleaseTransport() called by a thread that doesn't own it");
+    b32 released = sync->transportDepth && --sync->transportDepth == 0;
+    pthread_mutex_unlock(&sync->transportLock);
+    if (released) {
+        pthread_cond_signal(&sync->transportCond);
+    }
+#endif
+}
+
+b32 AwControl_OwnsTransport(AwControl* self) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return FALSE;
+    }
+#ifdef _WIN32
+    EnterCriticalSection(&sync->transportLock);
+    b32 owned = CurrentThreadOwnsTransport(sync);
+    LeaveCriticalSection(&sync->transportLock);
+#else
+    pthread_mutex_lock(&sync->transportLock);
+    b32 owned = CurrentThreadOwnsTransport(sync);
+    pthread_mutex_unlock(&sync->transportLock);
+#endif
+    return owned;
+}
+
+u32 AwControl_GetTransportToken(AwControl* self) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return 0;
+    }
+#ifdef _WIN32
+    EnterCriticalSection(&sync->transportLock);
+    u32 token = CurrentThreadOwnsTransport(sync) ? sync->transportToken : 0;
+    LeaveCriticalSection(&sync->transportLock);
+#else
+    pthread_mutex_lock(&sync->transportLock);
+    u32 token = CurrentThreadOwnsTransport(sync) ? sync->transportToken : 0;
+    pthread_mutex_unlock(&sync->transportLock);
+#endif
+    return token;
+}
+
+AwResult AwControl_CancelTransaction(AwControl* self) {
+    if (!self->device || !self->device->transport.cancel) {
+        return RESULT_CODE(AW_RESULT_NOT_SUPPORTED);
+    }
+    return self->device->transport.cancel(self->device);
+}
+
+AwResult AwControl_CancelTransactionForToken(AwControl* self, u32 transportToken) {
+    AwControlSync* sync = self->sync;
+    if (!sync || !self->device || !self->device->transport.cancel) {
+        return RESULT_CODE(AW_RESULT_NOT_SUPPORTED);
+    }
+    // Ownership can't change while the lock is held, the backend's cancel only sends the request and doesn't wait
+    // for the running transfer
+    AwResult r = RESULT_OK();
+#ifdef _WIN32
+    EnterCriticalSection(&sync->transportLock);
+    if (transportToken && sync->transportDepth && sync->transportToken == transportToken) {
+        r = self->device->transport.cancel(self->device);
+    }
+    LeaveCriticalSection(&sync->transportLock);
+#else
+    pthread_mutex_lock(&sync->transportLock);
+    if (transportToken && sync->transportDepth && sync->transportToken == transportToken) {
+        r = self->device->transport.cancel(self->device);
+    }
+    pthread_mutex_unlock(&sync->transportLock);
+#endif
+    return r;
+}
+
+void AwControl_LockPropertyState(AwControl* self) {
+    if (!self->sync) {
+        return;
+    }
+#ifdef _WIN32
+    AcquireSRWLockShared(&self->sync->stateLock);
+#else
+    pthread_rwlock_rdlock(&self->sync->stateLock);
+#endif
+}
+
+void AwControl_UnlockPropertyState(AwControl* self) {
+    if (!self->sync) {
+        return;
+    }
+#ifdef _WIN32
+    ReleaseSRWLockShared(&self->sync->stateLock);
+#else
+    pthread_rwlock_unlock(&self->sync->stateLock);
+#endif
+}
+
+b32 AwControl_CopyProperty(AwControl* self, u16 propCode, MAllocator* allocator, AwPtpProperty* outProperty) {
+    AwControl_LockPropertyState(self);
+    AwPtpProperty* property = AwControl_GetPropertyByCode(self, propCode);
+    if (property) {
+        PropertyCopy(allocator, property, outProperty);
+    }
+    AwControl_UnlockPropertyState(self);
+    return property != NULL;
+}
+
+void AwPtp_FreePropertyCopy(MAllocator* allocator, AwPtpProperty* property) {
+    PropValueFree(allocator, property->dataType, &property->value);
+    PropValueFree(allocator, property->dataType, &property->defaultValue);
+    PropertyFormFree(allocator, property);
+}
+
+void AwControl_SetPropertySnapshots(AwControl* self, b32 enabled) {
+    self->propSnapshotsEnabled = enabled;
+    PublishPropertySnapshot(self, enabled && self->properties, self->changedProperties,
+                            MArraySize(self->changedProperties));
+}
+
+AwPropertySnapshot* AwControl_AcquirePropertySnapshot(AwControl* self) {
+    AwControlSync* sync = self->sync;
+    if (!sync) {
+        return NULL;
+    }
+    SnapshotLock(sync);
+    AwPropertySnapshot* snapshot = self->propSnapshot;
+    if (snapshot) {
+        ATOMIC_ADD_FETCH_U32(&snapshot->refCount, 1);
+    }
+    SnapshotUnlock(sync);
+    return snapshot;
+}
+
+void AwPropertySnapshot_Release(AwPropertySnapshot* snapshot) {
+    if (snapshot && ATOMIC_SUB_FETCH_U32(&snapshot->refCount, 1) == 0) {
+        PropertySnapshot_Free(snapshot);
+    }
+}
+
+const AwPtpProperty* AwPropertySnapshot_GetProperty(const AwPropertySnapshot* snapshot, u16 propCode) {
+    i32 i = CodeIndex_Get((AwCodeIndex*)&snapshot->propertyIndex, propCode);
+    if (i < 0) {
+        return NULL;
+    }
+    return snapshot->properties + i;
+}
+
+b32 AwControl_SupportsEvent(AwControl* self, u16 eventCode) {
+    return CodeSet_Contains(&self->supportedEventSet, eventCode);
+}
+
+b32 AwControl_SupportsControl(AwControl* self, u16 controlCode) {
+    return CodeSet_Contains(&self->supportedControlSet, controlCode);
+}
+
+b32 AwControl_SupportsProperty(AwControl* self, u16 propCode) {
+    return CodeSet_Contains(&self->supportedPropertySet, propCode);
 }
 
 b32 AwControl_PropertyEnabled(AwControl* self, AwPtpProperty* property) {
@@ -4650,22 +5851,23 @@ b32 AwControl_PropertyEnabledByCode(AwControl* self, u16 propCode) {
 }
 
 AwPtpProperty* AwControl_GetPropertyByCode(AwControl* self, u16 propertyCode) {
-    for (int i = 0; i < MArraySize(self->properties); ++i) {
-        if (self->properties[i].propCode == propertyCode) {
-            return self->properties + i;
-        }
+    i32 i = CodeIndex_Get(&self->propertyIndex, propertyCode);
+    if (i < 0) {
+        return NULL;
     }
-    return NULL;
+    return self->properties + i;
 }
 
 AwPtpProperty* AwControl_GetPropertyById(AwControl* self, const char* id) {
-    MArrayEachPtr(self->properties, it) {
-        if (!it.p->meta) {
-            continue;
-        }
-        char* propId = it.p->meta->id;
-        if (propId && MCStrCmp(propId, id) == 0) {
-            return it.p;
+    AwPropertyIdIndex* index = &self->propertyIdIndex;
+    if (!index->count) {
+        return NULL;
+    }
+    u32 mask = index->capacity - 1;
+    for (u32 slot = PropertyIdHash(id) & mask; index->slots[slot]; slot = (slot + 1) & mask) {
+        AwPtpProperty* property = self->properties + index->slots[slot] - 1;
+        if (MCStrCmp(property->meta->id, id) == 0) {
+            return property;
         }
     }
     return NULL;
@@ -4684,6 +5886,11 @@ AwResult AwControl_UpdateProperties(AwControl* self, b32 fullRefresh) {
     return SDIO_GetAllExtDevicePropInfo(self, FALSE, !fullRefresh, TRUE);
 }
 
+u16* AwControl_GetChangedProperties(AwControl* self, size_t* outCount) {
+    *outCount = MArraySize(self->changedProperties);
+    return self->changedProperties;
+}
+
 static char* EnumValue8_Lookup(EnumValueU8* enumValues, size_t numEnumValues, u8 lookupValue) {
     for (int j = 0; j < numEnumValues; j++) {
         u8 enumValue = enumValues[j].value;
@@ -5006,28 +6213,23 @@ b32 AwControl_GetPropertyValueAsStr(AwControl* self, AwPtpProperty* property, MA
     return strOut->str != NULL;
 }
 
-static void UpdateStr(MAllocator* allocator, MStr* strIn, MStr* strOut) {
-    size_t size = strIn->size + 1;
-    if (strOut->capacity < size) {
-        strOut->str = MRealloc(allocator, strOut->str, strOut->capacity, size);
-        strOut->capacity = size;
-    }
-    memcpy(strOut->str, strIn->str, strIn->size);
-    strOut->str[strIn->size] = '\0';
-    strOut->size = strIn->size;
-}
-
 AwResult AwControl_SetPropertyValue(AwControl* self, AwPtpProperty* property, AwPtpPropValue value) {
     if (!property) {
         return RESULT_CODE(AW_RESULT_PARAM_ERROR);
     }
     AwResult r = SDIO_SetExtDevicePropValue(self, property->propCode, property->dataType, value);
-    if (!IS_OK(r)) {
+    if (IS_OK(r)) {
+        // Camera accepted the value, readers see it without waiting for the next property refresh
+        StateLockExclusive(self);
         if (property->dataType == PTP_DT_STR) {
             UpdateStr(self->allocator, &value.str, &property->value.str);
         } else {
             property->value = value;
         }
+        StateUnlockExclusive(self);
+        if (self->propSnapshotsEnabled) {
+            PublishPropertySnapshot(self, TRUE, &property->propCode, 1);
+        }
     }
     return r;
 }
@@ -5262,12 +6464,11 @@ AwPtpControl* AwControl_GetControlByIndex(AwControl* self, u16 index) {
 }
 
 AwPtpControl* AwControl_GetControlByCode(AwControl* self, u16 controlCode) {
-    for (int i = 0; i < MArraySize(self->controls); ++i) {
-        if (self->controls[i].controlCode == controlCode) {
-            return self->controls + i;
-        }
+    i32 i = CodeIndex_Get(&self->controlIndex, controlCode);
+    if (i < 0) {
+        return NULL;
     }
-    return NULL;
+    return self->controls + i;
 }
 
 AwResult AwControl_SetControlValue(AwControl* self, u16 controlCode, AwPtpPropValue value) {
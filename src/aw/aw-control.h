@@ -10,6 +10,64 @@
 extern "C" {
 #endif
 
+/**
+ * Usage statistics for the transport data buffers, see AwControl_GetDataBufferStats()
+ */
+typedef struct AwDataBufferStats {
+    u32 inCapacity; // Current capacity of the data in buffer
+    u32 outCapacity; // Current capacity of the data out buffer
+    u32 inPeakCapacity;
+    u32 outPeakCapacity;
+    u32 inPeakSize; // Largest request made of the data in buffer
+    u32 outPeakSize; // Largest request made of the data out buffer
+    u32 resizeCount; // Number of times either buffer was reallocated (grown or shrunk)
+    u32 shrinkCount; // Number of times either buffer was shrunk
+} AwDataBufferStats;
+
+// Bitset over the 16-bit PTP code space, for constant time 'is this code supported' checks
+typedef struct AwCodeSet {
+    u64* bits; // 0x10000 bits, allocated on first add
+} AwCodeSet;
+
+// Maps a 16-bit PTP code to an index into an array, split into 256 pages of 256 entries that are only allocated when
+// a code in that range is added (Sony codes cluster into a handful of pages)
+typedef struct AwCodeIndex {
+    u16** pages; // Entries hold index + 1, 0 when the code isn't present
+} AwCodeIndex;
+
+// Open addressing hash table from property id string (see AwControl_GetPropertyById()) to property index
+typedef struct AwPropertyIdIndex {
+    u16* slots; // Entries hold index + 1, 0 for an empty slot
+    u32 capacity; // Power of 2
+    u32 count;
+} AwPropertyIdIndex;
+
+/**
+ * How AwControl_GetLiveViewImage() fetches a frame, see AwControl_SetLiveViewMode().
+ */
+typedef enum {
+    AW_LIVE_VIEW_MODE_OBJECT_INFO,    // GetObjectInfo for the frame size, then GetObject (two round trips)
+    AW_LIVE_VIEW_MODE_SINGLE_REQUEST, // GetObject into a buffer sized from recent frames, retried on overflow
+} AwLiveViewMode;
+
+#define AW_LIVE_VIEW_SIZE_HISTORY 8
+
+/**
+ * Immutable copy of every property as of a refresh, see AwControl_SetPropertySnapshots().
+ * Nothing in a published snapshot is modified, hold a reference and read it from any thread without locking.
+ */
+typedef struct AwPropertySnapshot {
+    u64 version; // Increases by one with each snapshot published by the session
+    u64 timeMilliseconds; // MGetTimeMilliseconds() when published
+    AwPtpProperty* properties; // Deep copies of the session's properties, same order
+    u16* changedProperties; // Codes of the properties changed since the previous snapshot
+    AwCodeIndex propertyIndex;
+    u32 refCount; // Session + readers, the last AwPropertySnapshot_Release() frees the snapshot
+    MAllocator* allocator;
+} AwPropertySnapshot;
+
+struct AwControlSync;
+
 /**
  * Struct to manage and control a Sony PTP (Picture Transfer Protocol) session.
  *
@@ -47,6 +105,15 @@ typedef struct {
 
     AwPtpProperty* properties;
     AwPtpControl* controls;
+    u16* changedProperties; // Codes of the properties changed by the last property refresh
+
+    // Lookup tables for the arrays above, kept up to date as codes, properties and controls are added
+    AwCodeSet supportedEventSet;
+    AwCodeSet supportedControlSet;
+    AwCodeSet supportedPropertySet;
+    AwCodeIndex propertyIndex;
+    AwCodeIndex controlIndex;
+    AwPropertyIdIndex propertyIdIndex;
 
     u32 sessionId;
     u32 transactionId;
@@ -57,11 +124,34 @@ typedef struct {
     u8* dataOutMem;
     u32 dataOutSize;
     u32 dataOutCapacity;
+    u32 dataInSmallRequests; // Consecutive requests that would fit a much smaller buffer
+    u32 dataOutSmallRequests;
+    AwDataBufferStats dataBufferStats;
     AwPtpRequestHeader ptpRequest;
     AwPtpResponseHeader ptpResponse;
 
     AwPtpEvent* eventQueue;  // Array of queued events
 
+    // Event driven property sync, see AwControl_SetPropertySync()
+    b32 propSyncEnabled;
+    u32 propSyncCoalesceMilliseconds;
+    u64 propSyncPendingSince; // Time (ms) of the first unsynced property change event, 0 if none are pending
+    u32 propSyncEventCount; // Property change events coalesced into the pending sync
+
+    // Live view, see AwControl_SetLiveViewMode()
+    AwLiveViewMode liveViewMode;
+    u32 liveViewFrameSizes[AW_LIVE_VIEW_SIZE_HISTORY]; // Sizes of the most recent frames, 0 for unused slots
+    u32 liveViewFrameIndex;
+    u32 liveViewRetries; // Frames that overflowed the estimated buffer and had to be fetched again
+
+    // Transport ownership and property state lock, see AwControl_AcquireTransport() and AwControl_LockPropertyState()
+    struct AwControlSync* sync;
+
+    // Published property snapshots, see AwControl_SetPropertySnapshots()
+    b32 propSnapshotsEnabled;
+    u64 propSnapshotVersion;
+    AwPropertySnapshot* propSnapshot; // Current snapshot, swapped under the sync snapshot lock
+
     MAllocator* allocator;
     AwLog logger;
 } AwControl;
@@ -126,6 +216,147 @@ AW_EXPORT AwResult AwControl_Connect(AwControl* self, AwSonyProtocolVersion vers
  */
 AW_EXPORT AwResult AwControl_Cleanup(AwControl* self);
 
+/**
+ * Get usage statistics for the transport data buffers.
+ *
+ * Buffers are allocated in size classes and grown as needed.  After a large transfer (e.g. an image download) an
+ * oversized buffer is shrunk back down once a run of smaller requests (e.g. live view) has been made.
+ */
+AW_EXPORT void AwControl_GetDataBufferStats(AwControl* self, AwDataBufferStats* outStats);
+
+/**
+ * Release transport data buffer memory above the minimum size, e.g. after a large download when no further large
+ * transfers are expected soon.  Buffers are grown again on demand.
+ */
+AW_EXPORT void AwControl_TrimDataBuffers(AwControl* self);
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Concurrency
+//
+// An AwControl session can be shared between threads, with two rules:
+//
+// - Transactions: the transaction id, data buffers and response header are shared by every request, so only one call
+//   that talks to the device (property refresh / set, controls, live view, downloads, ...) may run at a time.  Callers
+//   must own the transport while making those calls, see AwControl_AcquireTransport(), debug builds assert it on every
+//   request.  Ownership is a flag, no lock is held while a transfer runs, so waiting callers can time out and property
+//   state reads are never blocked by a long download.  AwCommandQueue, AwLiveViewStream and AwEventDispatcher take the
+//   transport for each command, frame and event dispatch, so they can be mixed with each other and with direct calls.
+//   The one exception is AwControl_CancelTransaction(), any thread can use it to stop the owner's running transfer.
+//
+// - Property state: the property list is only modified after a transfer completes, while a refresh response is parsed
+//   or a property set is applied, under a short exclusive lock.  Any thread can read the last known state without
+//   owning the transport with AwControl_CopyProperty(), or by reading properties in place between
+//   AwControl_LockPropertyState() / AwControl_UnlockPropertyState().  AwPtpProperty pointers from the other getters are
+//   only safe to use on the thread that owns the transport.
+//
+// AwControl_Connect() and AwControl_Cleanup() take the transport themselves, but must not overlap with any other call.
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Take ownership of the transport before making calls that talk to the device, blocks while another thread owns it.
+ * The owning thread can acquire again, each call must be matched by an AwControl_ReleaseTransport().
+ * @param timeoutMilliseconds Max time to wait, 0 to try without waiting, -1 to wait forever
+ * @return AW_RESULT_OK once owned, AW_RESULT_TIMEOUT if still owned by another thread after the timeout.
+ */
+AW_EXPORT AwResult AwControl_AcquireTransport(AwControl* self, int timeoutMilliseconds);
+
+/**
+ * Give up ownership of the transport taken with AwControl_AcquireTransport(), waking the next waiting thread once the
+ * outermost acquire is released.
+ */
+AW_EXPORT void AwControl_ReleaseTransport(AwControl* self);
+
+/**
+ * Check if the calling thread owns the transport.
+ */
+AW_EXPORT b32 AwControl_OwnsTransport(AwControl* self);
+
+/**
+ * Ask the device to cancel the transaction currently running on the thread that owns the transport, e.g. a long image
+ * or settings file download.  Call from any other thread, without owning the transport.  The running call returns
+ * AW_RESULT_CANCELLED once the device has stopped and the session stays usable for the next request.  If the
+ * transaction finishes before the device sees the cancel its result is returned as normal.
+ * @return AW_RESULT_OK if a cancel was sent or nothing is running, AW_RESULT_NOT_SUPPORTED if the transport can't
+ *         cancel transactions.
+ */
+AW_EXPORT AwResult AwControl_CancelTransaction(AwControl* self);
+
+/**
+ * Token for the calling thread's hold on the transport, a new one is issued each time a thread takes it.  Pass it to
+ * AwControl_CancelTransactionForToken() from another thread.
+ * @return 0 if the calling thread doesn't own the transport
+ */
+AW_EXPORT u32 AwControl_GetTransportToken(AwControl* self);
+
+/**
+ * AwControl_CancelTransaction(), but only while the transport is still held under 'transportToken'.  A cancel meant
+ * for one owner's transfer is dropped once that owner has released the transport, instead of stopping the next one.
+ * @return AW_RESULT_OK if a cancel was sent or the owner has moved on
+ */
+AW_EXPORT AwResult AwControl_CancelTransactionForToken(AwControl* self, u32 transportToken);
+
+/**
+ * Hold the property state for reading, the property list is not modified until AwControl_UnlockPropertyState().
+ * Multiple readers may hold the state at once.  Keep it short, a refresh parsing its response waits for readers.
+ */
+AW_EXPORT void AwControl_LockPropertyState(AwControl* self);
+AW_EXPORT void AwControl_UnlockPropertyState(AwControl* self);
+
+/**
+ * Copy the last known state of a property, safe to call while another thread owns the transport.
+ * The copy has its own value, default value and form, free it with AwPtp_FreePropertyCopy().
+ * @param outProperty Filled in with the copy
+ * @return TRUE if the property was found
+ */
+AW_EXPORT b32 AwControl_CopyProperty(AwControl* self, u16 propCode, MAllocator* allocator, AwPtpProperty* outProperty);
+
+/**
+ * Free a property copy made by AwControl_CopyProperty().
+ */
+AW_EXPORT void AwPtp_FreePropertyCopy(MAllocator* allocator, AwPtpProperty* property);
+
+/**
+ * Enable or disable publishing property snapshots.
+ *
+ * When enabled, each property refresh that changes something (and each local property set) publishes a new
+ * AwPropertySnapshot, replacing the previous one.  Threads that want to watch camera state at their own rate (UI,
+ * logging, automation) take a reference to the current snapshot and read it without touching the session:
+ *
+ * @code{.c}
+ *    AwPropertySnapshot* snapshot = AwControl_AcquirePropertySnapshot(&aw);
+ *    if (snapshot) {
+ *        if (snapshot->version != lastVersion) {
+ *            const AwPtpProperty* iso = AwPropertySnapshot_GetProperty(snapshot, DPC_ISO);
+ *            ...
+ *        }
+ *        AwPropertySnapshot_Release(snapshot);
+ *    }
+ * @endcode
+ *
+ * Snapshots are freed with the session's allocator by whichever thread releases them last, so it must be safe to use
+ * from those threads.  Release all references before AwControl_Cleanup().
+ * Call while owning the transport, enabling while connected publishes a snapshot of the current properties straight
+ * away.
+ */
+AW_EXPORT void AwControl_SetPropertySnapshots(AwControl* self, b32 enabled);
+
+/**
+ * Take a reference to the most recently published snapshot, constant time and never waits on a transfer.
+ * @return The snapshot, release it with AwPropertySnapshot_Release(). NULL if none has been published.
+ */
+AW_EXPORT AwPropertySnapshot* AwControl_AcquirePropertySnapshot(AwControl* self);
+
+/**
+ * Release a reference taken with AwControl_AcquirePropertySnapshot().
+ */
+AW_EXPORT void AwPropertySnapshot_Release(AwPropertySnapshot* snapshot);
+
+/**
+ * Get a property from a snapshot by property code.
+ * @return The property, or NULL if the snapshot doesn't have it.
+ */
+AW_EXPORT const AwPtpProperty* AwPropertySnapshot_GetProperty(const AwPropertySnapshot* snapshot, u16 propCode);
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Check support for various events, controls, and properties
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -194,6 +425,14 @@ AW_EXPORT AwPtpProperty* AwControl_GetPropertyByIndex(AwControl* self, u16 index
  */
 AW_EXPORT AwResult AwControl_UpdateProperties(AwControl* self, b32 fullRefresh);
 
+/**
+ * Get the codes of properties whose value, enabled state or form changed (or that were first seen) in the last call to
+ * AwControl_UpdateProperties(). After connecting this contains every property.
+ * @param outCount Number of codes in the returned list
+ * @return List of property codes, owned by AwControl and valid until the next property refresh
+ */
+AW_EXPORT u16* AwControl_GetChangedProperties(AwControl* self, size_t* outCount);
+
 /**
  * Get property by property code
  * @param propertyCode
@@ -387,6 +626,11 @@ AW_EXPORT b32 AwControl_GetEnumsForControl(AwControl* self, u16 controlCode, AwP
  */
 AW_EXPORT int AwControl_GetPendingFiles(AwControl* self);
 
+/**
+ * AwControl_GetPendingFiles() for a property snapshot, read without touching the session.
+ */
+AW_EXPORT int AwPropertySnapshot_GetPendingFiles(const AwPropertySnapshot* snapshot);
+
 /**
  * Downloads an image from the cameras buffer.
  *
@@ -399,6 +643,34 @@ AW_EXPORT int AwControl_GetPendingFiles(AwControl* self);
  */
 AW_EXPORT AwResult AwControl_GetCapturedImage(AwControl* self, MMemIO* outFile, AwPtpCapturedImageInfo* outCii);
 
+/**
+ * Same as AwControl_GetCapturedImage() but the image is received directly into caller owned memory, without being
+ * buffered and copied by the transport.
+ *
+ * If dest has enough capacity the image is written into dest->mem in place, e.g. a buffer reused between shots or
+ * memory wrapped with MMemInit().  Otherwise dest is grown using dest->allocator and the caller adopts the new memory
+ * (free with MMemFree()).  If dest is too small and has no allocator AW_RESULT_PARAM_ERROR is returned.
+ *
+ * @param dest Destination for the image contents, dest->size is set to the downloaded size
+ * @param outCii Info about the downloaded image
+ * @return
+ */
+AW_EXPORT AwResult AwControl_GetCapturedImageInto(AwControl* self, MMemIO* dest, AwPtpCapturedImageInfo* outCii);
+
+/**
+ * Same as AwControl_GetCapturedImage() but streams the image to 'write' in chunks as it's received, so writing to disk,
+ * hashing or forwarding the data overlaps with the rest of the transfer.  The whole image is never held in memory.
+ *
+ * @param chunkSize Maximum number of bytes passed to each write() call, 0 for AW_DATA_SINK_CHUNK_SIZE_DEFAULT
+ * @param write Called with each chunk in order, return FALSE to stop receiving chunks.  The transfer still runs to
+ *              completion (keeping the session in sync) and AW_RESULT_CANCELLED is returned.
+ * @param userData Passed to write()
+ * @param outCii Info about the downloaded image
+ * @return
+ */
+AW_EXPORT AwResult AwControl_GetCapturedImageStream(AwControl* self, size_t chunkSize, AwDataSink_Write_Func write,
+                                                    void* userData, AwPtpCapturedImageInfo* outCii);
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Live View
@@ -415,6 +687,34 @@ AW_EXPORT AwResult AwControl_GetCapturedImage(AwControl* self, MMemIO* outFile,
  */
 AW_EXPORT AwResult AwControl_GetLiveViewImage(AwControl* self, MMemIO* outFile, AwLiveViewFrames* outLiveViewFrames);
 
+/**
+ * Get the live view image without copying it, for callers that decode every frame.
+ *
+ * Nothing is allocated once the frame arrays are reserved (see AwControl_ReserveLiveViewFrames()) and the transport
+ * buffer has grown to fit the frames, debug builds (M_ASSERT) assert on this.
+ *
+ * @param outJpeg Set to a read view of the JPEG in the transport buffer, only valid until the next request made with
+ *                this AwControl.
+ * @param outLiveViewFrames NULL or output pointer to the focus, face & tracking frames
+ */
+AW_EXPORT AwResult AwControl_GetLiveViewImageView(AwControl* self, MMemIO* outJpeg, AwLiveViewFrames* outLiveViewFrames);
+
+/**
+ * Allocate the live view frame arrays up front with AW_LIVE_VIEW_FRAMES_MAX capacity, they are never grown after
+ * this.  Optional, AwControl_GetLiveViewImage() reserves them on first use.
+ */
+AW_EXPORT void AwControl_ReserveLiveViewFrames(AwControl* self, AwLiveViewFrames* liveViewFrames);
+
+/**
+ * Choose how AwControl_GetLiveViewImage() fetches frames.
+ *
+ * AW_LIVE_VIEW_MODE_SINGLE_REQUEST skips the GetObjectInfo round trip per frame, the frame is requested straight away
+ * into a buffer sized from the largest of the last AW_LIVE_VIEW_SIZE_HISTORY frames plus headroom.  A frame that
+ * doesn't fit is fetched again with the size the camera reported.  Falls back to AW_LIVE_VIEW_MODE_OBJECT_INFO on
+ * transports that can't report an overflow.
+ */
+AW_EXPORT void AwControl_SetLiveViewMode(AwControl* self, AwLiveViewMode mode);
+
 /**
  * Free live view frames returned by AwControl_GetLiveViewImage()
  * @param liveViewFrames the live view frames to free
@@ -440,6 +740,14 @@ AW_EXPORT AwResult AwControl_GetOSDImage(AwControl* self, MMemIO* outFile);
  */
 AW_EXPORT AwResult AwControl_GetCameraSettingsFile(AwControl* self, MMemIO* outFile);
 
+/**
+ * Download camera settings file directly into caller owned memory, see AwControl_GetCapturedImageInto() for how dest
+ * is used.
+ * @param dest Destination for the settings file, dest->size is set to the file size.
+ * @return Returns AW_RESULT_OK on success, or an appropriate error code on failure.
+ */
+AW_EXPORT AwResult AwControl_GetCameraSettingsFileInto(AwControl* self, MMemIO* dest);
+
 /**
  * Upload camera settings file to the device.
  * @param file MemIO containing the settings file data.
@@ -461,6 +769,37 @@ AW_EXPORT AwResult AwControl_PutCameraSettingsFile(AwControl* self, MMemIO* file
  */
 AW_EXPORT AwResult AwControl_ReadEvents(AwControl* self, int timeoutMilliseconds, MAllocator* alloc, AwPtpEvent** outEvents);
 
+/**
+ * Update the session state (e.g. property sync) for events read straight from the transport, AwControl_ReadEvents()
+ * already does this.
+ * @param events MArray of events
+ */
+AW_EXPORT void AwControl_HandleEvents(AwControl* self, AwPtpEvent* events);
+
+#define AW_PROPERTY_SYNC_COALESCE_DEFAULT_MS 50
+
+/**
+ * Enable or disable event driven property sync.
+ *
+ * When enabled, PTP_DevicePropChanged events seen by AwControl_ReadEvents() mark the properties as out of date, and
+ * AwControl_SyncProperties() fetches the changes with a single incremental refresh once 'coalesceMilliseconds' have
+ * passed since the first event in a burst.  This replaces polling with
+ * AwControl_UpdateProperties() on a timer, the bus is left alone while nothing changes.
+ *
+ * @param coalesceMilliseconds Window to gather a burst of change events into one refresh, 0 for
+ *                             AW_PROPERTY_SYNC_COALESCE_DEFAULT_MS
+ * @return AW_RESULT_NOT_SUPPORTED if the device or transport can't report property change events
+ */
+AW_EXPORT AwResult AwControl_SetPropertySync(AwControl* self, b32 enabled, u32 coalesceMilliseconds);
+
+/**
+ * Fetch pending property changes if property sync is enabled and the coalesce window of the pending change events has
+ * passed.  Call regularly after AwControl_ReadEvents(), e.g. once per frame.
+ * @param outUpdated Set to TRUE if properties were refreshed, see AwControl_GetChangedProperties() for what changed
+ * @return Returns AW_RESULT_OK if nothing was pending or the refresh succeeded, or an error code from the refresh.
+ */
+AW_EXPORT AwResult AwControl_SyncProperties(AwControl* self, b32* outUpdated);
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Magnifier
@@ -515,6 +854,11 @@ typedef struct AwPosInt2 {
  */
 AW_EXPORT AwResult AwControl_GetMagnifier(AwControl* self, AwMagnifier* outMagnifier);
 
+/**
+ * AwControl_GetMagnifier() for a property snapshot, read without touching the session.
+ */
+AW_EXPORT AwResult AwPropertySnapshot_GetMagnifier(const AwPropertySnapshot* snapshot, AwMagnifier* outMagnifier);
+
 /**
  * Set magnifier position and zoom level.
  * @param magnifier Magnifier parameters to set.
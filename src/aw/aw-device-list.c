@@ -204,6 +204,19 @@ b32 AwDeviceList_IsRefreshingList(AwDeviceList* self) {
     return FALSE;
 }
 
+AwResult AwDeviceList_ServiceDevices(AwDeviceList* self, int timeoutMilliseconds) {
+    AwResult r = {.code=AW_RESULT_NOT_SUPPORTED};
+    MArrayEachPtr(self->backends, backend) {
+        if (backend.p->serviceDevices) {
+            AwResult br = backend.p->serviceDevices(backend.p, timeoutMilliseconds);
+            if (r.code != AW_RESULT_OK) {
+                r = br;
+            }
+        }
+    }
+    return r;
+}
+
 AwResult AwDeviceList_OpenDevice(AwDeviceList* self, AwDeviceInfo* deviceInfo, AwDevice** deviceOut) {
     AW_TRACE("AwDeviceList_OpenDevice");
     AW_INFO_F("Opening device %.*s (%.*s)...", deviceInfo->product.size, deviceInfo->product.str,
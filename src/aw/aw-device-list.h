@@ -150,6 +150,25 @@ AW_EXPORT AwResult AwDeviceList_OpenDevice(AwDeviceList* self, AwDeviceInfo* dev
  */
 AW_EXPORT AwResult AwDeviceList_CloseDevice(AwDeviceList* self, AwDevice* device);
 
+/**
+ * Runs one iteration of the multi-device event loop: waits on the event and data channels of every open device
+ * (PTP/IP only) and queues any events that arrive.  Call it in a loop from a single thread to service many network
+ * cameras without a thread per camera.  Events are queued as soon as the camera sends them, rather than when the
+ * next command or AwControl_ReadEvents() call happens to read the socket.
+ *
+ * Once called, AwControl_ReadEvents() on IP devices no longer blocks and returns the queued events.
+ *
+ * Unless AwBackendConfig.disallowSpawnEventThread is set, the IP backend already runs this loop on its own thread once
+ * a device is opened.  AwControl_ReadEvents() then waits up to its timeout for queued events, and this call only
+ * waits for the thread to queue some.
+ *
+ * @param self Pointer to the AwDeviceList instance.
+ * @param timeoutMilliseconds Max time to wait for activity, -1 to wait forever.
+ * @return AwResult.code == AW_RESULT_OK if any device had activity, AW_RESULT_TIMEOUT if none did, or
+ *         AW_RESULT_NOT_SUPPORTED if no backend has an event loop.
+ */
+AW_EXPORT AwResult AwDeviceList_ServiceDevices(AwDeviceList* self, int timeoutMilliseconds);
+
 /**
  * Retrieves the backend of the specified type from the given AwDeviceList.
  *
@@ -0,0 +1,279 @@
+﻿#include "aw-event-dispatch.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+#define ATOMIC_LOAD_U32(p) ((u32)InterlockedCompareExchange((volatile LONG*)(p), 0, 0))
+#define ATOMIC_STORE_U32(p, v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#define ATOMIC_ADD_U32(p, v) InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v))
+#else
+#define ATOMIC_LOAD_U32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_U32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_ADD_U32(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#endif
+
+typedef struct AwEventDispatchThread {
+#ifdef _WIN32
+    HANDLE handle;
+    CRITICAL_SECTION subscriptionLock; // Recursive, so handlers can (un)subscribe
+#else
+    pthread_t handle;
+    pthread_mutex_t subscriptionLock; // Recursive, so handlers can (un)subscribe
+#endif
+    b32 stop; // Only accessed atomically
+} AwEventDispatchThread;
+
+// Guards the subscriptions while the thread is running, held for a whole dispatch so a handler is never called after
+// AwEventDispatcher_Unsubscribe() returns
+static void LockSubscriptions(AwEventDispatcher* self) {
+    if (!self->thread) {
+        return;
+    }
+#ifdef _WIN32
+    EnterCriticalSection(&self->thread->subscriptionLock);
+#else
+    pthread_mutex_lock(&self->thread->subscriptionLock);
+#endif
+}
+
+static void UnlockSubscriptions(AwEventDispatcher* self) {
+    if (!self->thread) {
+        return;
+    }
+#ifdef _WIN32
+    LeaveCriticalSection(&self->thread->subscriptionLock);
+#else
+    pthread_mutex_unlock(&self->thread->subscriptionLock);
+#endif
+}
+
+void AwEventDispatcher_Init(AwEventDispatcher* self, AwControl* control) {
+    memset(self, 0, sizeof(AwEventDispatcher));
+    self->control = control;
+    self->nextId = 1;
+}
+
+void AwEventDispatcher_Free(AwEventDispatcher* self) {
+    AwEventDispatcher_Stop(self);
+    MArrayFree(self->control->allocator, self->subscriptions);
+    MArrayFree(self->control->allocator, self->events);
+}
+
+u32 AwEventDispatcher_Subscribe(AwEventDispatcher* self, u16 code, AwEventHandler handler, void* userData) {
+    LockSubscriptions(self);
+    AwEventSubscription* sub = MArrayAddPtr(self->control->allocator, self->subscriptions);
+    sub->id = self->nextId++;
+    sub->code = code;
+    sub->handler = handler;
+    sub->userData = userData;
+    u32 id = sub->id;
+    UnlockSubscriptions(self);
+    return id;
+}
+
+static void RemoveUnsubscribed(AwEventDispatcher* self) {
+    for (int i = (int)MArraySize(self->subscriptions) - 1; i >= 0; --i) {
+        if (!self->subscriptions[i].handler) {
+            MArrayRemoveIndex(self->subscriptions, i);
+        }
+    }
+}
+
+void AwEventDispatcher_Unsubscribe(AwEventDispatcher* self, u32 id) {
+    LockSubscriptions(self);
+    MArrayEachPtr(self->subscriptions, it) {
+        if (it.p->id == id) {
+            it.p->handler = NULL;
+            break;
+        }
+    }
+    if (!self->dispatching) {
+        RemoveUnsubscribed(self);
+    }
+    UnlockSubscriptions(self);
+}
+
+// Called owning the transport, and with the subscription lock held when the thread is running
+static void DispatchEvents(AwEventDispatcher* self) {
+    u64 now = MGetTimeMicroseconds();
+    self->dispatching = TRUE;
+    MArrayEachPtr(self->events, event) {
+        if (!event.p->timestampMicroseconds) {
+            event.p->timestampMicroseconds = now;
+        }
+        b32 handled = FALSE;
+        // Indexed as handlers may subscribe and grow the array
+        for (int i = 0; i < MArraySize(self->subscriptions); ++i) {
+            AwEventSubscription sub = self->subscriptions[i];
+            if (sub.handler && (sub.code == AW_EVENT_CODE_ALL || sub.code == event.p->code)) {
+                sub.handler(self->control, event.p, sub.userData);
+                handled = TRUE;
+            }
+        }
+
+        if (handled) {
+            u64 latency = MGetTimeMicroseconds() - event.p->timestampMicroseconds;
+            u32 latencyUs = latency > 0xffffffff ? 0xffffffff : (u32)latency;
+            ATOMIC_STORE_U32(&self->stats.lastLatencyUs, latencyUs);
+            if (latencyUs > ATOMIC_LOAD_U32(&self->stats.maxLatencyUs)) {
+                ATOMIC_STORE_U32(&self->stats.maxLatencyUs, latencyUs);
+            }
+            ATOMIC_ADD_U32(&self->stats.eventsDispatched, 1);
+        } else {
+            ATOMIC_ADD_U32(&self->stats.eventsUnhandled, 1);
+        }
+    }
+    self->dispatching = FALSE;
+    RemoveUnsubscribed(self);
+    MArrayClear(self->events);
+}
+
+AwResult AwEventDispatcher_Pump(AwEventDispatcher* self, int timeoutMilliseconds, u32* outDispatched) {
+    if (outDispatched) {
+        *outDispatched = 0;
+    }
+    if (self->running) {
+        return (AwResult){.code = AW_RESULT_PARAM_ERROR};
+    }
+    MArrayClear(self->events);
+    AwResult r = AwControl_ReadEvents(self->control, timeoutMilliseconds, self->control->allocator, &self->events);
+    if (outDispatched) {
+        *outDispatched = MArraySize(self->events);
+    }
+    if (MArraySize(self->events)) {
+        // Handlers can use the AwControl, a caller already owning the transport just nests
+        AwControl_AcquireTransport(self->control, -1);
+        DispatchEvents(self);
+        AwControl_ReleaseTransport(self->control);
+    }
+    return r;
+}
+
+static void SleepMs(u32 ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void DispatchThreadRun(AwEventDispatcher* self) {
+    AwControl* control = self->control;
+    AwDevice* device = control->device;
+    while (!ATOMIC_LOAD_U32(&self->thread->stop)) {
+        if (!MArraySize(self->events)) {
+            // Events arrive on their own pipe (interrupt endpoint / event socket) and don't touch the transaction
+            // state, so the wait doesn't need the transport and other threads keep using the device meanwhile
+            AwResult r = device->transport.readEvents(device, AW_EVENT_DISPATCH_WAIT_MS, control->allocator,
+                                                      &self->events);
+            if (!MArraySize(self->events)) {
+                if (r.code != AW_RESULT_OK && r.code != AW_RESULT_TIMEOUT) {
+                    // Transport error or the camera went away, don't spin
+                    SleepMs(AW_EVENT_DISPATCH_WAIT_MS);
+                }
+                continue;
+            }
+        }
+
+        // Bounded wait so Stop() isn't held up by a long transfer on another thread, the events are kept and
+        // dispatched on the next attempt
+        if (AwControl_AcquireTransport(control, AW_EVENT_DISPATCH_WAIT_MS).code != AW_RESULT_OK) {
+            continue;
+        }
+        LockSubscriptions(self);
+        AwControl_HandleEvents(control, self->events);
+        DispatchEvents(self);
+        UnlockSubscriptions(self);
+        AwControl_ReleaseTransport(control);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI DispatchThreadProc(LPVOID param) {
+    DispatchThreadRun((AwEventDispatcher*)param);
+    return 0;
+}
+#else
+static void* DispatchThreadProc(void* param) {
+    DispatchThreadRun((AwEventDispatcher*)param);
+    return NULL;
+}
+#endif
+
+AwResult AwEventDispatcher_Start(AwEventDispatcher* self) {
+    if (self->running) {
+        return (AwResult){.code = AW_RESULT_OK};
+    }
+    AwControl* control = self->control;
+    if (!control->device->transport.readEvents) {
+        return (AwResult){.code = AW_RESULT_NOT_SUPPORTED};
+    }
+
+    AwEventDispatchThread* thread = MMallocZ(control->allocator, sizeof(AwEventDispatchThread));
+#ifdef _WIN32
+    InitializeCriticalSection(&thread->subscriptionLock);
+#else
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&thread->subscriptionLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
+    // Subscribe() and friends lock as soon as the thread is assigned, before it starts
+    self->thread = thread;
+    self->running = TRUE;
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, DispatchThreadProc, self, 0, NULL);
+    b32 started = thread->handle != NULL;
+    if (!started) {
+        DeleteCriticalSection(&thread->subscriptionLock);
+    }
+#else
+    b32 started = pthread_create(&thread->handle, NULL, DispatchThreadProc, self) == 0;
+    if (!started) {
+        pthread_mutex_destroy(&thread->subscriptionLock);
+    }
+#endif
+    if (!started) {
+        AW_LOG_ERROR(&control->logger, "Failed to start event dispatch thread");
+        self->thread = NULL;
+        self->running = FALSE;
+        MFree(control->allocator, thread, sizeof(AwEventDispatchThread));
+        return (AwResult){.code = AW_RESULT_NOT_SUPPORTED};
+    }
+    return (AwResult){.code = AW_RESULT_OK};
+}
+
+void AwEventDispatcher_Stop(AwEventDispatcher* self) {
+    if (!self->running) {
+        return;
+    }
+    AW_LOG_TRACE(&self->control->logger, "AwEventDispatcher_Stop");
+
+    AwEventDispatchThread* thread = self->thread;
+    ATOMIC_STORE_U32(&thread->stop, TRUE);
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    DeleteCriticalSection(&thread->subscriptionLock);
+#else
+    pthread_join(thread->handle, NULL);
+    pthread_mutex_destroy(&thread->subscriptionLock);
+#endif
+    MFree(self->control->allocator, thread, sizeof(AwEventDispatchThread));
+    self->thread = NULL;
+    self->running = FALSE;
+}
+
+void AwEventDispatcher_GetStats(AwEventDispatcher* self, AwEventDispatchStats* outStats) {
+    outStats->eventsDispatched = ATOMIC_LOAD_U32(&self->stats.eventsDispatched);
+    outStats->eventsUnhandled = ATOMIC_LOAD_U32(&self->stats.eventsUnhandled);
+    outStats->lastLatencyUs = ATOMIC_LOAD_U32(&self->stats.lastLatencyUs);
+    outStats->maxLatencyUs = ATOMIC_LOAD_U32(&self->stats.maxLatencyUs);
+}
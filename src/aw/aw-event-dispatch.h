@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include "mlib/mlib.h"
+
+#include "aw/aw-const.h"
+#include "aw/aw-control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AW_EVENT_CODE_ALL 0 // Subscribe to every event code
+#define AW_EVENT_DISPATCH_WAIT_MS 100 // Max time the dispatch thread waits for events, bounds how long Stop() takes
+
+/**
+ * Called for each event matching a subscription.  event->timestampMicroseconds is when the transport received the
+ * event (MGetTimeMicroseconds()), or when it was read if the backend doesn't record arrival times.
+ */
+typedef void (*AwEventHandler)(AwControl* control, const AwPtpEvent* event, void* userData);
+
+typedef struct AwEventSubscription {
+    u32 id;
+    u16 code; // AwPtpEventCode or AW_EVENT_CODE_ALL
+    AwEventHandler handler; // NULL once unsubscribed during a dispatch, removed afterwards
+    void* userData;
+} AwEventSubscription;
+
+/**
+ * Counters for AwEventDispatcher, see AwEventDispatcher_GetStats()
+ */
+typedef struct AwEventDispatchStats {
+    u32 eventsDispatched;
+    u32 eventsUnhandled; // Events no subscription matched
+    u32 lastLatencyUs; // Arrival to handler call time of the newest event
+    u32 maxLatencyUs;
+} AwEventDispatchStats;
+
+struct AwEventDispatchThread;
+
+/**
+ * Delivers camera events to registered handlers instead of the caller switching over AwControl_ReadEvents() results.
+ *
+ * Events are dispatched either on a library owned thread (AwEventDispatcher_Start()), which blocks on the transport
+ * and calls handlers as soon as events arrive, or on the caller's thread from AwEventDispatcher_Pump().
+ *
+ * Handlers are called owning the AwControl transport so they can talk to the device, other threads take turns with
+ * the dispatcher through AwControl_AcquireTransport(), see 'Concurrency' in aw-control.h.
+ *
+ * @code{.c}
+ *    static void OnCaptured(AwControl* control, const AwPtpEvent* event, void* userData) {
+ *        // Fetch the image...
+ *    }
+ *
+ *    AwEventDispatcher dispatcher = {};
+ *    AwEventDispatcher_Init(&dispatcher, &aw);
+ *    AwEventDispatcher_Subscribe(&dispatcher, PTP_CapturedEvent, OnCaptured, NULL);
+ *    AwEventDispatcher_Start(&dispatcher);
+ *    ...
+ *    AwEventDispatcher_Free(&dispatcher);
+ * @endcode
+ */
+typedef struct AwEventDispatcher {
+    AwControl* control;
+    AwEventSubscription* subscriptions; // MArray
+    u32 nextId;
+    b32 dispatching; // Subscriptions are only compacted outside of a dispatch
+    b32 running;
+    AwPtpEvent* events; // MArray, reused for each read
+    AwEventDispatchStats stats; // Fields only accessed atomically while running
+    struct AwEventDispatchThread* thread;
+} AwEventDispatcher;
+
+AW_EXPORT void AwEventDispatcher_Init(AwEventDispatcher* self, AwControl* control);
+
+/**
+ * Stop the thread if running and free the subscriptions.
+ */
+AW_EXPORT void AwEventDispatcher_Free(AwEventDispatcher* self);
+
+/**
+ * Register a handler, handlers for the same event are called in the order they were subscribed.  Safe to call from a
+ * handler, the new handler only sees later events.
+ * @param code Event code to handle or AW_EVENT_CODE_ALL
+ * @return Subscription id for AwEventDispatcher_Unsubscribe(), never 0
+ */
+AW_EXPORT u32 AwEventDispatcher_Subscribe(AwEventDispatcher* self, u16 code, AwEventHandler handler, void* userData);
+
+/**
+ * Remove a handler, safe to call from a handler.
+ */
+AW_EXPORT void AwEventDispatcher_Unsubscribe(AwEventDispatcher* self, u32 id);
+
+/**
+ * Read and dispatch events on a new thread.
+ * @return AW_RESULT_NOT_SUPPORTED if the transport can't read events or threads can't be created on this platform
+ */
+AW_EXPORT AwResult AwEventDispatcher_Start(AwEventDispatcher* self);
+
+/**
+ * Stop the dispatch thread.  Waits for handlers to return, at most AW_EVENT_DISPATCH_WAIT_MS longer.
+ */
+AW_EXPORT void AwEventDispatcher_Stop(AwEventDispatcher* self);
+
+/**
+ * Read events, waiting up to timeoutMilliseconds for the first one, and dispatch them on the calling thread.  For
+ * callers running their own loop instead of AwEventDispatcher_Start().
+ * @param outDispatched Optional, number of events read
+ */
+AW_EXPORT AwResult AwEventDispatcher_Pump(AwEventDispatcher* self, int timeoutMilliseconds, u32* outDispatched);
+
+/**
+ * Snapshot of the dispatch counters.
+ */
+AW_EXPORT void AwEventDispatcher_GetStats(AwEventDispatcher* self, AwEventDispatchStats* outStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,260 @@
+﻿#include "aw-live-view.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#endif
+
+// Atomics for the slot exchange and counters shared between the stream thread and the consumer
+#ifdef _WIN32
+#define ATOMIC_EXCHANGE_U32(p, v) ((u32)InterlockedExchange((volatile LONG*)(p), (LONG)(v)))
+#define ATOMIC_LOAD_U32(p) ((u32)InterlockedCompareExchange((volatile LONG*)(p), 0, 0))
+#define ATOMIC_STORE_U32(p, v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+#define ATOMIC_ADD_U32(p, v) InterlockedExchangeAdd((volatile LONG*)(p), (LONG)(v))
+#define ATOMIC_LOAD_U64(p) ((u64)InterlockedCompareExchange64((volatile LONG64*)(p), 0, 0))
+#define ATOMIC_ADD_U64(p, v) InterlockedExchangeAdd64((volatile LONG64*)(p), (LONG64)(v))
+#else
+#define ATOMIC_EXCHANGE_U32(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_LOAD_U32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_U32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_ADD_U32(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD_U64(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_ADD_U64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#endif
+
+#define SLOT_INDEX_MASK 0x3
+
+typedef struct AwLiveViewThread {
+#ifdef _WIN32
+    HANDLE handle;
+    HANDLE stopEvent;
+#else
+    pthread_t handle;
+    pthread_mutex_t stopLock;
+    pthread_cond_t stopCond;
+#endif
+    b32 stop;
+} AwLiveViewThread;
+
+static u32 FrameIntervalMs(AwLiveViewStream* self) {
+    u32 fps = ATOMIC_LOAD_U32(&self->targetFps);
+    return 1000 / (fps ? fps : AW_LIVE_VIEW_STREAM_FPS_DEFAULT);
+}
+
+// Wait until the next frame is due, returns FALSE if the stream was stopped while waiting
+static b32 WaitForNextFrame(AwLiveViewStream* self, u32 waitMs) {
+    AwLiveViewThread* thread = self->thread;
+#ifdef _WIN32
+    return WaitForSingleObject(thread->stopEvent, waitMs) != WAIT_OBJECT_0;
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += waitMs / 1000;
+    deadline.tv_nsec += (long)(waitMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&thread->stopLock);
+    while (!thread->stop) {
+        if (pthread_cond_timedwait(&thread->stopCond, &thread->stopLock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    b32 running = !thread->stop;
+    pthread_mutex_unlock(&thread->stopLock);
+    return running;
+#endif
+}
+
+// Swap the filled back slot into the middle, picking up whatever was there as the new back slot
+static void PublishFrame(AwLiveViewStream* self) {
+    u32 previous = ATOMIC_EXCHANGE_U32(&self->middle, self->back | AW_LIVE_VIEW_STREAM_SLOT_NEW);
+    if (previous & AW_LIVE_VIEW_STREAM_SLOT_NEW) {
+        ATOMIC_ADD_U32(&self->stats.framesDropped, 1);
+    }
+    self->back = previous & SLOT_INDEX_MASK;
+}
+
+static void FetchFrame(AwLiveViewStream* self) {
+    AwLiveViewFrame* frame = self->slots + self->back;
+    u64 requestTime = MGetTimeMilliseconds();
+
+    // Bounded wait, so a long transfer on another thread (or a caller owning the transport while it stops the stream)
+    // skips frames instead of holding up the thread
+    if (AwControl_AcquireTransport(self->control, (int)FrameIntervalMs(self)).code != AW_RESULT_OK) {
+        return;
+    }
+    AwResult r = AwControl_GetLiveViewImage(self->control, &frame->jpeg, &frame->frames);
+    AwControl_ReleaseTransport(self->control);
+
+    if (r.code != AW_RESULT_OK) {
+        ATOMIC_ADD_U32(&self->stats.framesFailed, 1);
+        return;
+    }
+
+    frame->sequence = ++self->sequence;
+    frame->requestTimeMs = requestTime;
+    frame->publishTimeMs = MGetTimeMilliseconds();
+
+    u32 latency = (u32)(frame->publishTimeMs - requestTime);
+    ATOMIC_STORE_U32(&self->stats.lastLatencyMs, latency);
+    if (latency > ATOMIC_LOAD_U32(&self->stats.maxLatencyMs)) {
+        ATOMIC_STORE_U32(&self->stats.maxLatencyMs, latency);
+    }
+    ATOMIC_ADD_U64(&self->stats.totalLatencyMs, latency);
+    ATOMIC_ADD_U32(&self->stats.framesPublished, 1);
+
+    PublishFrame(self);
+}
+
+static void StreamThreadRun(AwLiveViewStream* self) {
+    u64 nextFrameTime = MGetTimeMilliseconds();
+    for (;;) {
+        FetchFrame(self);
+
+        u32 interval = FrameIntervalMs(self);
+        u64 now = MGetTimeMilliseconds();
+        nextFrameTime += interval;
+        u32 waitMs = 0;
+        if (nextFrameTime > now) {
+            waitMs = (u32)(nextFrameTime - now);
+        } else {
+            // Behind schedule, don't try to catch up with a burst of requests
+            ATOMIC_ADD_U32(&self->stats.framesLate, 1);
+            nextFrameTime = now;
+        }
+        if (!WaitForNextFrame(self, waitMs)) {
+            break;
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI StreamThreadProc(LPVOID param) {
+    StreamThreadRun((AwLiveViewStream*)param);
+    return 0;
+}
+#else
+static void* StreamThreadProc(void* param) {
+    StreamThreadRun((AwLiveViewStream*)param);
+    return NULL;
+}
+#endif
+
+AwResult AwLiveViewStream_Start(AwLiveViewStream* self, AwControl* control, u32 targetFps) {
+    if (!self || !control) {
+        return (AwResult){.code = AW_RESULT_PARAM_ERROR};
+    }
+    if (self->running) {
+        AwLiveViewStream_SetTargetFps(self, targetFps);
+        return (AwResult){.code = AW_RESULT_OK};
+    }
+
+    self->control = control;
+    self->back = 0;
+    self->middle = 1;
+    self->front = 2;
+    self->sequence = 0;
+    self->targetFps = targetFps;
+    memset(&self->stats, 0, sizeof(self->stats));
+
+    for (int i = 0; i < 3; ++i) {
+        AwControl_ReserveLiveViewFrames(control, &self->slots[i].frames);
+    }
+
+    AwLiveViewThread* thread = MMallocZ(control->allocator, sizeof(AwLiveViewThread));
+    self->thread = thread;
+#ifdef _WIN32
+    // The thread waits on the stop event, so it's only started once the event exists
+    thread->stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (thread->stopEvent) {
+        thread->handle = CreateThread(NULL, 0, StreamThreadProc, self, 0, NULL);
+    }
+    b32 started = thread->stopEvent && thread->handle;
+    if (!started && thread->stopEvent) {
+        CloseHandle(thread->stopEvent);
+    }
+#else
+    pthread_mutex_init(&thread->stopLock, NULL);
+    pthread_cond_init(&thread->stopCond, NULL);
+    b32 started = pthread_create(&thread->handle, NULL, StreamThreadProc, self) == 0;
+    if (!started) {
+        pthread_cond_destroy(&thread->stopCond);
+        pthread_mutex_destroy(&thread->stopLock);
+    }
+#endif
+    if (!started) {
+        AW_LOG_ERROR(&control->logger, "Failed to start live view thread");
+        for (int i = 0; i < 3; ++i) {
+            AwControl_FreeLiveViewFrames(control, &self->slots[i].frames);
+        }
+        MFree(control->allocator, self->thread, sizeof(AwLiveViewThread));
+        self->thread = NULL;
+        return (AwResult){.code = AW_RESULT_NOT_SUPPORTED};
+    }
+
+    self->running = TRUE;
+    return (AwResult){.code = AW_RESULT_OK};
+}
+
+void AwLiveViewStream_Stop(AwLiveViewStream* self) {
+    if (!self->running) {
+        return;
+    }
+    AW_LOG_TRACE(&self->control->logger, "AwLiveViewStream_Stop");
+
+    AwLiveViewThread* thread = self->thread;
+#ifdef _WIN32
+    thread->stop = TRUE;
+    SetEvent(thread->stopEvent);
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    CloseHandle(thread->stopEvent);
+#else
+    pthread_mutex_lock(&thread->stopLock);
+    thread->stop = TRUE;
+    pthread_cond_signal(&thread->stopCond);
+    pthread_mutex_unlock(&thread->stopLock);
+    pthread_join(thread->handle, NULL);
+    pthread_cond_destroy(&thread->stopCond);
+    pthread_mutex_destroy(&thread->stopLock);
+#endif
+
+    for (int i = 0; i < 3; ++i) {
+        AwLiveViewFrame* frame = self->slots + i;
+        MMemFree(&frame->jpeg);
+        AwControl_FreeLiveViewFrames(self->control, &frame->frames);
+        memset(frame, 0, sizeof(AwLiveViewFrame));
+    }
+
+    MFree(self->control->allocator, self->thread, sizeof(AwLiveViewThread));
+    self->thread = NULL;
+    self->running = FALSE;
+}
+
+void AwLiveViewStream_SetTargetFps(AwLiveViewStream* self, u32 targetFps) {
+    ATOMIC_STORE_U32(&self->targetFps, targetFps);
+}
+
+AwLiveViewFrame* AwLiveViewStream_GetLatestFrame(AwLiveViewStream* self) {
+    if (!self->running || !(ATOMIC_LOAD_U32(&self->middle) & AW_LIVE_VIEW_STREAM_SLOT_NEW)) {
+        return NULL;
+    }
+    u32 previous = ATOMIC_EXCHANGE_U32(&self->middle, self->front);
+    self->front = previous & SLOT_INDEX_MASK;
+    return self->slots + self->front;
+}
+
+void AwLiveViewStream_GetStats(AwLiveViewStream* self, AwLiveViewStreamStats* outStats) {
+    outStats->framesPublished = ATOMIC_LOAD_U32(&self->stats.framesPublished);
+    outStats->framesDropped = ATOMIC_LOAD_U32(&self->stats.framesDropped);
+    outStats->framesFailed = ATOMIC_LOAD_U32(&self->stats.framesFailed);
+    outStats->framesLate = ATOMIC_LOAD_U32(&self->stats.framesLate);
+    outStats->lastLatencyMs = ATOMIC_LOAD_U32(&self->stats.lastLatencyMs);
+    outStats->maxLatencyMs = ATOMIC_LOAD_U32(&self->stats.maxLatencyMs);
+    outStats->totalLatencyMs = ATOMIC_LOAD_U64(&self->stats.totalLatencyMs);
+}
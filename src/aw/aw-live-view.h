@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include "mlib/mlib.h"
+
+#include "aw/aw-const.h"
+#include "aw/aw-control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AW_LIVE_VIEW_STREAM_FPS_DEFAULT 30
+#define AW_LIVE_VIEW_STREAM_SLOT_NEW 0x4 // Flag on AwLiveViewStream.middle, a frame was published and not yet taken
+
+/**
+ * A live view frame published by AwLiveViewStream.
+ */
+typedef struct AwLiveViewFrame {
+    MMemIO jpeg;
+    AwLiveViewFrames frames;
+    u32 sequence; // Increments for each published frame, gaps are frames the consumer never saw
+    u64 requestTimeMs; // MGetTimeMilliseconds() when the frame was requested
+    u64 publishTimeMs; // MGetTimeMilliseconds() when the frame was published to the consumer
+} AwLiveViewFrame;
+
+/**
+ * Counters for AwLiveViewStream, see AwLiveViewStream_GetStats()
+ */
+typedef struct AwLiveViewStreamStats {
+    u32 framesPublished;
+    u32 framesDropped; // Published frames replaced by a newer one before the consumer took them
+    u32 framesFailed; // Live view requests that failed
+    u32 framesLate; // Frames that took longer than the target frame interval to fetch
+    u32 lastLatencyMs; // Request to publish time of the newest frame
+    u32 maxLatencyMs;
+    u64 totalLatencyMs; // Sum over all published frames, divide by framesPublished for the average
+} AwLiveViewStreamStats;
+
+struct AwLiveViewThread;
+
+/**
+ * Fetches live view frames on a background thread so transport stalls don't hold up the caller.
+ *
+ * Frames are handed over through a triple buffer: the thread fills the back slot while the consumer reads the front
+ * slot, and a finished frame is swapped into the middle slot with a single atomic exchange.  Neither side ever waits
+ * on the other, the consumer always gets the newest frame and older unread frames are dropped.
+ *
+ * The thread owns the AwControl transport for each frame request, other threads making calls that talk to the device
+ * take turns with it through AwControl_AcquireTransport(), see 'Concurrency' in aw-control.h.
+ *
+ * @code{.c}
+ *    AwLiveViewStream stream = {};
+ *    AwLiveViewStream_Start(&stream, &aw, 30);
+ *    ...
+ *    // Each UI frame
+ *    AwLiveViewFrame* frame = AwLiveViewStream_GetLatestFrame(&stream);
+ *    if (frame) {
+ *        // Decode frame->jpeg, valid until the next AwLiveViewStream_GetLatestFrame()
+ *    }
+ *    ...
+ *    AwLiveViewStream_Stop(&stream);
+ * @endcode
+ */
+typedef struct AwLiveViewStream {
+    AwControl* control;
+    AwLiveViewFrame slots[3];
+    u32 back; // Slot the thread is filling, owned by the thread
+    u32 middle; // Slot index | AW_LIVE_VIEW_STREAM_SLOT_NEW, only accessed atomically
+    u32 front; // Slot last returned to the consumer, owned by the consumer
+    u32 sequence;
+    u32 targetFps;
+    b32 running;
+    AwLiveViewStreamStats stats; // Fields only accessed atomically while running
+    struct AwLiveViewThread* thread;
+} AwLiveViewStream;
+
+/**
+ * Start fetching live view frames on a new thread.
+ * @param targetFps Frames per second to request, 0 for AW_LIVE_VIEW_STREAM_FPS_DEFAULT.  The thread doesn't pace
+ *                  faster than the camera can deliver, a slow transport lowers the rate.
+ * @return AW_RESULT_NOT_SUPPORTED if threads can't be created on this platform
+ */
+AW_EXPORT AwResult AwLiveViewStream_Start(AwLiveViewStream* self, AwControl* control, u32 targetFps);
+
+/**
+ * Stop the thread and free the frames.  Waits for an in flight request to complete.
+ */
+AW_EXPORT void AwLiveViewStream_Stop(AwLiveViewStream* self);
+
+/**
+ * Change the frame rate of a running stream.
+ * @param targetFps Frames per second, 0 for AW_LIVE_VIEW_STREAM_FPS_DEFAULT
+ */
+AW_EXPORT void AwLiveViewStream_SetTargetFps(AwLiveViewStream* self, u32 targetFps);
+
+/**
+ * Take the newest frame without blocking.
+ * @return The newest frame if one was published since the last call, NULL otherwise.  The frame is owned by the
+ *         stream and stays valid until the next call or AwLiveViewStream_Stop().
+ */
+AW_EXPORT AwLiveViewFrame* AwLiveViewStream_GetLatestFrame(AwLiveViewStream* self);
+
+/**
+ * Snapshot of the stream counters.
+ */
+AW_EXPORT void AwLiveViewStream_GetStats(AwLiveViewStream* self, AwLiveViewStreamStats* outStats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -15,8 +15,88 @@
     #include <arpa/inet.h>
     #include <netdb.h>
     #include <unistd.h>
+    #include <pthread.h>
+    #include <time.h>
 #endif
 
+// Guards the serviced device list and per device event queues, shared with the thread calling
+// AwDeviceList_ServiceDevices()
+#ifdef _WIN32
+    typedef CRITICAL_SECTION PTPIpLock;
+    #define PTPIpLock_Init(l) InitializeCriticalSection(l)
+    #define PTPIpLock_Destroy(l) DeleteCriticalSection(l)
+    #define PTPIpLock_Lock(l) EnterCriticalSection(l)
+    #define PTPIpLock_Unlock(l) LeaveCriticalSection(l)
+#else
+    typedef pthread_mutex_t PTPIpLock;
+    #define PTPIpLock_Init(l) pthread_mutex_init(l, NULL)
+    #define PTPIpLock_Destroy(l) pthread_mutex_destroy(l)
+    #define PTPIpLock_Lock(l) pthread_mutex_lock(l)
+    #define PTPIpLock_Unlock(l) pthread_mutex_unlock(l)
+#endif
+
+// Signalled when serviced events are queued, waits are bounded as wakeups can be spurious
+#ifdef _WIN32
+    typedef CONDITION_VARIABLE PTPIpCond;
+    #define PTPIpCond_Init(c) InitializeConditionVariable(c)
+    #define PTPIpCond_Destroy(c)
+    #define PTPIpCond_Broadcast(c) WakeAllConditionVariable(c)
+    #define PTPIpCond_Wait(c, l, ms) SleepConditionVariableCS(c, l, (DWORD)(ms))
+#else
+    typedef pthread_cond_t PTPIpCond;
+    #define PTPIpCond_Init(c) pthread_cond_init(c, NULL)
+    #define PTPIpCond_Destroy(c) pthread_cond_destroy(c)
+    #define PTPIpCond_Broadcast(c) pthread_cond_broadcast(c)
+    #define PTPIpCond_Wait(c, l, ms) PTPIpCond_TimedWait(c, l, ms)
+
+static void PTPIpCond_TimedWait(pthread_cond_t* cond, pthread_mutex_t* lock, u32 waitMs) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += waitMs / 1000;
+    deadline.tv_nsec += (long)(waitMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, lock, &deadline);
+}
+#endif
+
+// Max time the event thread waits in the poller, bounds how long closing the backend takes
+#define PTPIP_EVENT_THREAD_WAIT_MILLISECONDS 100
+
+// Transaction cancellation state, set from the thread calling AwDeviceIp_Cancel()
+#ifdef _WIN32
+    #define ATOMIC_LOAD_U32(p) ((u32)InterlockedCompareExchange((volatile LONG*)(p), 0, 0))
+    #define ATOMIC_STORE_U32(p, v) InterlockedExchange((volatile LONG*)(p), (LONG)(v))
+    #define ATOMIC_CAS_U32(p, expected, v) \
+        ((u32)InterlockedCompareExchange((volatile LONG*)(p), (LONG)(v), (LONG)(expected)) == (u32)(expected))
+#else
+    #define ATOMIC_LOAD_U32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+    #define ATOMIC_STORE_U32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+    #define ATOMIC_CAS_U32(p, expected, v) \
+        ({ u32 expected_ = (expected); \
+           __atomic_compare_exchange_n((p), &expected_, (v), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+#endif
+
+// Cancel state holds the id + 1 of the transaction it's for, so a cancel racing with the end of its transaction
+// never affects the next one
+#define PTPIP_CANCEL_TOKEN(transactionId) ((transactionId) + 1)
+
+// CancelTransaction event code, sent by the initiator on the event connection
+#define PTPIP_EVENT_CANCEL_TRANSACTION 0x4001
+
+// Receive / send timeout of the data socket
+#define PTPIP_DATA_TIMEOUT_MILLISECONDS 60000
+
+// Largest data packet payload sent to the camera, a cancel can stop the data phase between packets
+#define PTPIP_SEND_PACKET_MAX_SIZE (1024 * 1024)
+
+// How long the camera gets to answer a cancel with its own cancel packet or the response before the transaction
+// gives up on it, waiting for packets is polled in PTPIP_CANCEL_POLL_MILLISECONDS steps to notice the cancel
+#define PTPIP_CANCEL_WAIT_MILLISECONDS 2000
+#define PTPIP_CANCEL_POLL_MILLISECONDS 100
+
 typedef enum PTPIpPacketTypes {
     PTPIP_TYPE_INIT_COMMAND_REQUEST = 0x1,
     PTPIP_TYPE_INIT_COMMAND_ACK = 0x2,
@@ -43,6 +123,8 @@ typedef enum PTPIpInitFailError {
 
 // SSDP Multicast IP address is 239.255.255.250
 #define SSDP_MULTICAST_ADDR 0xEFFFFFFA
+#define SSDP_MULTICAST_ADDR_STR "239.255.255.250"
+#define SSDP_PORT 1900
 
 static const char * AwIp_GetInitFailErrorString(u32 failureCode) {
     switch (failureCode) {
@@ -59,24 +141,98 @@ static const char * AwIp_GetInitFailErrorString(u32 failureCode) {
     }
 }
 
+typedef struct {
+    u8* mem;
+    u32 capacity;
+    u32 start; // Next unparsed byte
+    u32 end; // End of the received bytes
+    MAllocator* allocator;
+} PTPIpRecvBuffer;
+
+struct AwPtpIpBackend;
+
 typedef struct {
     MSock dataSock;
+    PTPIpRecvBuffer recvBuffer; // Data socket receive buffer, allocated on the first transaction
     u32 sessionId; // Session id for device connection
     u32 transactionId; // Next requestion transaction id
+    u32 inTransaction; // Set while a transaction is running on the data socket
+    u32 activeTransactionId; // Transaction id of the running transaction
+    u32 cancelClaimed; // PTPIP_CANCEL_TOKEN() of the transaction a cancel is being sent for
+    u32 cancelRequested; // PTPIP_CANCEL_TOKEN() once the cancel was sent, remaining data is discarded
 
     // Event socket
     MSock eventSock;
     MMemIO eventMem; // Event buffer for reading and parsing events (reused across calls)
     u32 eventSockTimeoutMilliseconds; // Cached timeout for event socket operations in milliseconds
+
+    // Serviced mode, filled by AwIp_ServiceDevices() under backend->serviceLock
+    AwPtpEvent* eventList; // MArray of events waiting for AwDeviceIp_ReadEvents()
+    b32 closed; // Camera closed the connection
+    u32 serviceId; // Poller userData, never reused so a stale poll result can't reach a device opened in its place
+    struct AwPtpIpBackend* backend;
 } PTPIpDevice;
 
+// SSDP advertisements without a max-age are cached for the UPnP recommended minimum
+#define SSDP_MAX_AGE_DEFAULT_SECONDS 1800
+#define PTPIP_DESCRIPTION_TIMEOUT_MILLISECONDS 5000
+
+// UPnP device description of a camera, cached by SSDP USN
 typedef struct {
+    MStr usn;
+    MStr location; // Description URL, refetched if it changes
+    MStr product;
+    MStr manufacturer;
+    MStr ipAddress;
+    u64 expireTime; // From CACHE-CONTROL max-age of the latest SSDP response
+    b32 listed; // Added to the device list during the current refresh
+} PTPIpDescription;
+
+typedef struct {
+    HttpRequest request;
+    MStr usn;
+    MStr location;
+    u32 maxAgeSeconds;
+} PTPIpDescriptionFetch;
+
+typedef struct AwPtpIpBackend {
     AwDeviceInfo* deviceList;
-    PTPIpDevice* openDevices;
+    PTPIpDevice** openDevices; // Individually allocated so AwDevice::device stays valid as devices come and go
     MSock discoverySock;
     u64 discoveryStartTime;
     b32 isDiscoveryInProgress;
     u32 timeoutMilliseconds;
+
+    // Device descriptions are fetched concurrently, without blocking discovery
+    PTPIpDescription* descriptions; // MArray
+    PTPIpDescriptionFetch* descriptionFetches; // MArray of requests in flight
+    MSockPoller discoveryPoller;
+    b32 discoveryPollerInit;
+
+    // Passive discovery, listens for ssdp:alive / ssdp:byebye NOTIFY messages from cameras
+    MSock notifySock;
+    b32 needsRefresh; // A camera joined or left since the last refresh
+
+    // Serviced mode, one loop waits on the sockets of every open device, see AwIp_ServiceDevices()
+    MSockPoller poller;
+    PTPIpLock serviceLock;
+    PTPIpCond eventCond; // Broadcast under serviceLock when events are queued or a device closes
+    u32 eventSignals; // Bumped with each eventCond broadcast, tells a wakeup from a spurious one
+    b32 serviceMode;
+    b32 pollerDirty; // openDevices changed since the poller was last synced
+    b32 pollerWaiting; // The service loop is in MSockPollerWait(), the poller is only changed while it isn't
+    u32 nextServiceId;
+
+    // Background thread running the service loop, started with the first device unless disallowSpawnEventThread
+    b32 spawnEventThread;
+    b32 eventThreadStarted;
+    b32 eventThreadStop; // Guarded by serviceLock
+#ifdef _WIN32
+    HANDLE eventThread;
+#else
+    pthread_t eventThread;
+#endif
+
     MAllocator* allocator;
     AwLog logger;
 } AwPtpIpBackend;
@@ -85,8 +241,22 @@ static AwResult AwIp_ReleaseList(AwPtpIpBackend* backend) {
     return (AwResult){.code=AW_RESULT_OK};
 }
 
-static b32 AwIp_NeedsRefresh(AwPtpIpBackend* backend) {
-    return FALSE;
+static void AwIp_FreeDescription(AwPtpIpBackend* self, PTPIpDescription* desc) {
+    MStrFree(self->allocator, desc->usn);
+    MStrFree(self->allocator, desc->location);
+    MStrFree(self->allocator, desc->product);
+    MStrFree(self->allocator, desc->manufacturer);
+    MStrFree(self->allocator, desc->ipAddress);
+}
+
+// The request socket is still open here, even for a finished fetch, so it always leaves the poller before it's closed
+static void AwIp_FreeDescriptionFetch(AwPtpIpBackend* self, PTPIpDescriptionFetch* fetch) {
+    if (fetch->request.sock != MSOCK_INVALID) {
+        MSockPollerRemove(&self->discoveryPoller, fetch->request.sock);
+    }
+    Http_FreeRequest(&fetch->request);
+    MStrFree(self->allocator, fetch->usn);
+    MStrFree(self->allocator, fetch->location);
 }
 
 static AwResult AwIp_Close(AwPtpIpBackend* backend) {
@@ -95,6 +265,24 @@ static AwResult AwIp_Close(AwPtpIpBackend* backend) {
     if (backend->openDevices) {
         MArrayFree(backend->allocator, backend->openDevices);
     }
+    if (backend->serviceMode) {
+        MSockPollerFree(&backend->poller);
+    }
+    MArrayEachPtr(backend->descriptionFetches, it) {
+        AwIp_FreeDescriptionFetch(backend, it.p);
+    }
+    MArrayFree(backend->allocator, backend->descriptionFetches);
+    MArrayEachPtr(backend->descriptions, it) {
+        AwIp_FreeDescription(backend, it.p);
+    }
+    MArrayFree(backend->allocator, backend->descriptions);
+    if (backend->discoveryPollerInit) {
+        MSockPollerFree(&backend->discoveryPoller);
+    }
+    MSockClose(backend->discoverySock);
+    MSockClose(backend->notifySock);
+    PTPIpCond_Destroy(&backend->eventCond);
+    PTPIpLock_Destroy(&backend->serviceLock);
     MSockDeinit();
     return (AwResult){.code=AW_RESULT_OK};
 }
@@ -106,7 +294,7 @@ static void* AwDeviceIp_ReallocBuffer(AwDevice* self, AwBufferType type, void* d
         u8* mem = ((u8*)dataMem)-headerSize;
         MFree(self->transport.allocator, mem, dataOldSize + headerSize); dataMem = NULL;
     }
-    dataMem = MMallocZ(self->transport.allocator, dataSize);
+    dataMem = MMalloc(self->transport.allocator, dataSize);
     return ((u8*)dataMem) + headerSize;
 }
 
@@ -152,6 +340,143 @@ static int TcpSendAllBytes(MSock socket, const void* data, size_t dataSize) {
     return totalSent;
 }
 
+// Data socket receive buffer.  Large recvs are made into it and packets are parsed in place, only data packet payloads
+// bypass it and are received straight into their destination.
+#define PTPIP_RECV_BUFFER_SIZE (64 * 1024)
+
+// Make at least 'minBytes' available from buf->start, returns > 0 on success, 0 if the connection closed or
+// MSOCK_ERROR
+static int RecvBufferFill(MSock socket, PTPIpRecvBuffer* buf, u32 minBytes) {
+    u32 buffered = buf->end - buf->start;
+    if (buffered >= minBytes) {
+        return 1;
+    }
+    if (buf->start + minBytes > buf->capacity) {
+        // Move the partial packet to the front to make room for the rest of it
+        memmove(buf->mem, buf->mem + buf->start, buffered);
+        buf->start = 0;
+        buf->end = buffered;
+        if (minBytes > buf->capacity) {
+            u32 newCapacity = (u32)MSizeAlign(minBytes, PTPIP_RECV_BUFFER_SIZE);
+            buf->mem = MRealloc(buf->allocator, buf->mem, buf->capacity, newCapacity);
+            buf->capacity = newCapacity;
+        }
+    }
+    while (buf->end - buf->start < minBytes) {
+        int r = recv(socket, (char*)buf->mem + buf->end, (int)(buf->capacity - buf->end), 0);
+        if (r == -1 || r == 0) {
+            return r;
+        }
+        buf->end += r;
+    }
+    return 1;
+}
+
+// Take up to 'size' already received bytes out of the buffer
+static u32 RecvBufferTake(PTPIpRecvBuffer* buf, u8* dest, u32 size) {
+    u32 buffered = buf->end - buf->start;
+    u32 n = buffered < size ? buffered : size;
+    if (dest) {
+        memcpy(dest, buf->mem + buf->start, n);
+    }
+    buf->start += n;
+    if (buf->start == buf->end) {
+        buf->start = 0;
+        buf->end = 0;
+    }
+    return n;
+}
+
+// Receive a payload into 'dest', bytes already buffered are copied and the rest is received in place
+static int RecvPayloadInto(MSock socket, PTPIpRecvBuffer* buf, u8* dest, u32 size) {
+    u32 received = RecvBufferTake(buf, dest, size);
+    while (received < size) {
+#ifdef MSG_WAITALL
+        int r = recv(socket, (char*)dest + received, (int)(size - received), MSG_WAITALL);
+#else
+        int r = recv(socket, (char*)dest + received, (int)(size - received), 0);
+#endif
+        if (r == -1 || r == 0) {
+            return r;
+        }
+        received += r;
+    }
+    return 1;
+}
+
+// Receive and drop a payload
+static int RecvPayloadDiscard(MSock socket, PTPIpRecvBuffer* buf, u32 size) {
+    u32 remaining = size - RecvBufferTake(buf, NULL, size);
+    while (remaining) {
+        u32 chunk = remaining < buf->capacity ? remaining : buf->capacity;
+        int r = RecvBufferFill(socket, buf, chunk);
+        if (r == -1 || r == 0) {
+            return r;
+        }
+        remaining -= RecvBufferTake(buf, NULL, chunk);
+    }
+    return 1;
+}
+
+// Stream a data packet payload to 'sink' in chunk sized pieces.  Bytes already buffered are used first, the rest is
+// received straight into the staging buffer, so large data packets are never buffered whole.
+static int RecvPayloadStream(MSock socket, PTPIpRecvBuffer* buf, u32 payloadLen, MMemIO* staging, AwDataSink* sink) {
+    u32 remaining = payloadLen;
+    while (remaining) {
+        u32 space = staging->capacity - staging->size;
+        u32 wanted = remaining < space ? remaining : space;
+        u32 n = RecvBufferTake(buf, staging->mem + staging->size, wanted);
+        if (!n) {
+            int r = recv(socket, (char*)staging->mem + staging->size, (int)wanted, 0);
+            if (r == -1 || r == 0) {
+                return r;
+            }
+            n = r;
+        }
+        staging->size += n;
+        remaining -= n;
+        if (staging->size == staging->capacity) {
+            AwDataSink_Write(sink, staging->mem, staging->size);
+            staging->size = 0;
+        }
+    }
+    return 1;
+}
+
+// Wait for the data socket to have the next packet, returns like recv().  Once the transaction is cancelled the camera
+// has until 'cancelDeadline' to answer, so one that never does doesn't hold the transaction until the socket timeout.
+static int PTPIp_WaitForPacket(PTPIpDevice* dev, u32 cancelToken, u64* cancelDeadline) {
+    PTPIpRecvBuffer* in = &dev->recvBuffer;
+    if (in->end - in->start >= 8) {
+        return 1;
+    }
+    u64 deadline = MGetTimeMilliseconds() + PTPIP_DATA_TIMEOUT_MILLISECONDS;
+    while (TRUE) {
+        u64 now = MGetTimeMilliseconds();
+        if (!*cancelDeadline && ATOMIC_LOAD_U32(&dev->cancelRequested) == cancelToken) {
+            *cancelDeadline = now + PTPIP_CANCEL_WAIT_MILLISECONDS;
+        }
+        if (*cancelDeadline && *cancelDeadline < deadline) {
+            deadline = *cancelDeadline;
+        }
+        if (now >= deadline) {
+            return MSOCK_ERROR;
+        }
+        u64 wait = deadline - now;
+        int r = MSockWaitReadable(dev->dataSock,
+                                  (int)(wait < PTPIP_CANCEL_POLL_MILLISECONDS ? wait : PTPIP_CANCEL_POLL_MILLISECONDS));
+        if (r != 0) {
+            return r;
+        }
+    }
+}
+
+static void PTPIp_WriteDataPacketHeader(MMemIO* out, u32 transactionId, size_t payloadSize) {
+    MMemWriteU32LE(out, 4 + 4 + 4 + (u32)payloadSize);
+    MMemWriteU32LE(out, PTPIP_TYPE_DATA_PACKET);
+    MMemWriteU32LE(out, transactionId);
+}
+
 // PTP IP example packets:
 //
 // Send1: SDIO_Connect request
@@ -167,99 +492,177 @@ static int TcpSendAllBytes(MSock socket, const void* data, size_t dataSize) {
 // <len      > <data more> <tid      > <data       |           > <len      > <data end > <tid      > | <len      > <cmd   res> <res> <tid      >
 //
 
-static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
-                                        AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize,
-                                        size_t* actualDataOutSize) {
+// Largest command request packet: length, type, data phase, opcode, transaction id & 5 params
+#define PTPIP_CMD_REQUEST_MAX_SIZE (4 + 4 + 4 + 2 + 4 + (5 * 4))
+
+#define PTPIP_RECV_CHECK(r) \
+    if ((r) == MSOCK_ERROR) { error.code = AW_RESULT_TIMEOUT; goto exitWithError; } \
+    else if ((r) == 0) { error.code = AW_RESULT_CONNECTION_CLOSED; goto exitWithError; }
+
+// Run a transaction, data packets are received into 'dataOut' or if 'stream' is set passed to stream->write().
+// 'outDataLength' (optional) is set to the data phase length announced by the device.
+static AwResult AwDeviceIp_Transaction(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                                       AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize,
+                                       AwDataSink* stream, size_t* actualDataOutSize, u64* outDataLength) {
     PTPIpDevice* dev = (PTPIpDevice*)self->device;
     MAllocator* allocator = self->transport.allocator;
     AwResult error = {AW_RESULT_OK, PTP_OK};
+    PTPIpRecvBuffer* in = &dev->recvBuffer;
+    MMemIO staging = {0};
 
-    MMemIO in = {0};
+    // 1. Request packet, and the data phase packets if there is data to send, are sent with gather writes:
+    //    [request + data start + data packet header] [dataIn] ... [data packet header] [dataIn] [data end]
+    u8 headerMem[PTPIP_CMD_REQUEST_MAX_SIZE + 20 + 12];
+    u8 endMem[12];
     MMemIO out;
-    MMemInitEmpty(&out, allocator);
-
-    // 1. Send request packet
-    u32 packetLen = 4 + 4 + 4 + 2 + 4 + (request->NumParams * 4);
+    MMemInit(&out, NULL, headerMem, sizeof(headerMem));
+    u32 numParams = request->NumParams < 5 ? request->NumParams : 5;
+    u32 packetLen = 4 + 4 + 4 + 2 + 4 + (numParams * 4);
     MMemWriteU32LE(&out, packetLen);
     MMemWriteU32LE(&out, PTPIP_TYPE_CMD_REQUEST);
     MMemWriteU32LE(&out, dataInSize == 0 ? 1 : 2);
     MMemWriteU16LE(&out, request->OpCode);
     MMemWriteU32LE(&out, request->TransactionId);
-    for (int i = 0; i < request->NumParams; ++i) {
+    for (int i = 0; i < numParams; ++i) {
         MMemWriteU32LE(&out, request->Params[i]);
     }
-    int s = TcpSendAllBytes(dev->dataSock, out.mem, out.size);
-    if (s == MSOCK_ERROR) {
-        error.code = AW_RESULT_TIMEOUT;
-        goto exitWithError;
-    } else if (s == 0) {
-        error.code = AW_RESULT_CONNECTION_CLOSED;
-        goto exitWithError;
-    }
 
-    // 2. Send data packets if needed
+    u32 cancelToken = PTPIP_CANCEL_TOKEN(request->TransactionId);
+    b32 discarded = FALSE; // Part of the data phase was dropped after a cancel
+
+    u64 cancelDeadline = 0;
+
+    MSockBuffer buffers[3];
+    int bufferCount = 1;
+    MSockBuffer endBuffer = {endMem, sizeof(endMem)};
+    size_t dataSent = dataInSize < PTPIP_SEND_PACKET_MAX_SIZE ? dataInSize : PTPIP_SEND_PACKET_MAX_SIZE;
     if (dataInSize > 0) {
-        // Send data packet start, data / end
-        MMemReset(&out);
         MMemWriteU32LE(&out, 4 + 4 + 4 + 8);
         MMemWriteU32LE(&out, PTPIP_TYPE_DATA_PACKET_START);
         MMemWriteU32LE(&out, request->TransactionId);
         MMemWriteU64LE(&out, dataInSize);
-        MMemWriteU32LE(&out, 4 + 4 + 4 + dataInSize);
-        MMemWriteU32LE(&out, PTPIP_TYPE_DATA_PACKET);
-        MMemWriteU32LE(&out, request->TransactionId);
-        MMemWriteU8CopyN(&out, dataIn, (u32)dataInSize);
-        MMemWriteU32LE(&out, 4 + 4 + 4);
-        MMemWriteU32LE(&out, PTPIP_TYPE_DATA_PACKET_END);
-        MMemWriteU32LE(&out, request->TransactionId);
-        s = TcpSendAllBytes(dev->dataSock, out.mem, out.size);
-        if (s == MSOCK_ERROR) {
-            goto exitWithError;
-        } else if (s == 0) {
-            goto exitWithError;
-        }
-    }
+        PTPIp_WriteDataPacketHeader(&out, request->TransactionId, dataSent);
 
-    MMemFree(&out);
+        MMemIO end;
+        MMemInit(&end, NULL, endMem, sizeof(endMem));
+        MMemWriteU32LE(&end, 4 + 4 + 4);
+        MMemWriteU32LE(&end, PTPIP_TYPE_DATA_PACKET_END);
+        MMemWriteU32LE(&end, request->TransactionId);
 
-    // 3. Receive Response(s)
-    MMemInitAlloc(&in, allocator, 1024);
+        buffers[bufferCount++] = (MSockBuffer){dataIn, dataSent};
+        if (dataSent == dataInSize) {
+            buffers[bufferCount++] = endBuffer;
+        }
+    }
+    buffers[0] = (MSockBuffer){headerMem, out.size};
+
+    int s = MSockSendBuffersAll(dev->dataSock, buffers, bufferCount);
+    PTPIP_RECV_CHECK(s);
+
+    while (dataSent < dataInSize) {
+        u8 packetMem[12];
+        MMemIO packet;
+        MMemInit(&packet, NULL, packetMem, sizeof(packetMem));
+        if (ATOMIC_LOAD_U32(&dev->cancelRequested) == cancelToken) {
+            // The host is sending the data phase, so it's the one to stop it with a cancel packet in place of the
+            // rest of the data
+            MMemWriteU32LE(&packet, sizeof(packetMem));
+            MMemWriteU32LE(&packet, PTPIP_TYPE_DATA_PACKET_CANCEL);
+            MMemWriteU32LE(&packet, request->TransactionId);
+            s = TcpSendAllBytes(dev->dataSock, packet.mem, packet.size);
+            PTPIP_RECV_CHECK(s);
+            discarded = TRUE;
+            break;
+        }
+        size_t remaining = dataInSize - dataSent;
+        size_t packetSize = remaining < PTPIP_SEND_PACKET_MAX_SIZE ? remaining : PTPIP_SEND_PACKET_MAX_SIZE;
+        PTPIp_WriteDataPacketHeader(&packet, request->TransactionId, packetSize);
+        buffers[0] = (MSockBuffer){packetMem, packet.size};
+        buffers[1] = (MSockBuffer){dataIn + dataSent, packetSize};
+        bufferCount = 2;
+        dataSent += packetSize;
+        if (dataSent == dataInSize) {
+            buffers[bufferCount++] = endBuffer;
+        }
+        s = MSockSendBuffersAll(dev->dataSock, buffers, bufferCount);
+        PTPIP_RECV_CHECK(s);
+    }
 
-    MMemIO inRead = {in.mem, 0, in.capacity};
+    // 2. Receive Response(s)
+    if (!in->mem) {
+        in->allocator = allocator;
+        in->mem = MMalloc(allocator, PTPIP_RECV_BUFFER_SIZE);
+        in->capacity = PTPIP_RECV_BUFFER_SIZE;
+    }
+    if (stream) {
+        MMemInitAlloc(&staging, allocator, (u32)AwDataSink_GetChunkSize(stream));
+    }
     u64 transferLen = 0;
     u8* dataOutCurrent = dataOut;
-    i64 dataRemaining = (i64)dataOutSize;
+    size_t dataRemaining = dataOutSize;
 
     while (TRUE) {
-        int r = TcpReadBytesIntoBuffer(dev->dataSock, &in, &inRead, 8);
-        if (r == MSOCK_ERROR) {
-            error.code = AW_RESULT_TIMEOUT;
-            goto exitWithError;
-        } else if (r == 0) {
-            error.code = AW_RESULT_CONNECTION_CLOSED;
-            goto exitWithError;
-        }
+        int r = PTPIp_WaitForPacket(dev, cancelToken, &cancelDeadline);
+        PTPIP_RECV_CHECK(r);
+        r = RecvBufferFill(dev->dataSock, in, 8);
+        PTPIP_RECV_CHECK(r);
 
         u32 responseLen, responseType;
-        MMemReadU32LE(&inRead, &responseLen);
-        MMemReadU32LE(&inRead, &responseType);
+        MMemIO header;
+        MMemInitRead(&header, in->mem + in->start, 8);
+        MMemReadU32LE(&header, &responseLen);
+        MMemReadU32LE(&header, &responseType);
         if (responseLen < 8) {
             error.code = AW_RESULT_MALFORMED_RESPONSE;
             goto exitWithError;
         }
 
         u32 payloadLen = responseLen - 8;
-        r = TcpReadBytesIntoBuffer(dev->dataSock, &in, &inRead, payloadLen);
-        inRead.mem = in.mem;
-        if (r == MSOCK_ERROR) {
-            error.code = AW_RESULT_TIMEOUT;
-            goto exitWithError;
-        } else if (r == 0) {
-            error.code = AW_RESULT_CONNECTION_CLOSED;
-            goto exitWithError;
+        if (responseType == PTPIP_TYPE_DATA_PACKET && payloadLen >= 4) {
+            // Only the header and transaction id are parsed from the buffer, the payload goes straight to its
+            // destination
+            r = RecvBufferFill(dev->dataSock, in, 12);
+            PTPIP_RECV_CHECK(r);
+            u32 transactionId;
+            MMemIO idRead;
+            MMemInitRead(&idRead, in->mem + in->start + 8, 4);
+            MMemReadU32LE(&idRead, &transactionId);
+            RecvBufferTake(in, NULL, 12);
+            payloadLen -= 4;
+            if (payloadLen == 0) {
+                continue;
+            }
+
+            if (transactionId != request->TransactionId) {
+                // Left over from an earlier cancelled transaction
+                r = RecvPayloadDiscard(dev->dataSock, in, payloadLen);
+            } else if (ATOMIC_LOAD_U32(&dev->cancelRequested) == cancelToken) {
+                // Rest of the data phase being cancelled, the caller's data is incomplete
+                r = RecvPayloadDiscard(dev->dataSock, in, payloadLen);
+                discarded = TRUE;
+            } else if (stream) {
+                r = RecvPayloadStream(dev->dataSock, in, payloadLen, &staging, stream);
+            } else {
+                // Receive what fits in 'dataOut', anything more is dropped
+                u32 fits = dataRemaining < payloadLen ? (u32)dataRemaining : payloadLen;
+                r = RecvPayloadInto(dev->dataSock, in, dataOutCurrent, fits);
+                dataOutCurrent += fits;
+                dataRemaining -= fits;
+                if (r > 0 && fits < payloadLen) {
+                    r = RecvPayloadDiscard(dev->dataSock, in, payloadLen - fits);
+                }
+            }
+            PTPIP_RECV_CHECK(r);
+            continue;
         }
 
-        i32 bytesReadAfterPacket = in.size - responseLen;  // could be partial PTP packet
+        r = RecvBufferFill(dev->dataSock, in, responseLen);
+        PTPIP_RECV_CHECK(r);
+
+        MMemIO inRead;
+        MMemInitRead(&inRead, in->mem + in->start + 8, payloadLen);
+        RecvBufferTake(in, NULL, responseLen);
+
         if (responseType == PTPIP_TYPE_CMD_RESPONSE) {
             // Read u16 OpCode and u32 transaction id
             if (payloadLen >= 6) {
@@ -267,11 +670,15 @@ static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* reque
                 u32 transactionId;
                 MMemReadU16LE(&inRead, &responseCode);
                 MMemReadU32LE(&inRead, &transactionId);
+                if (transactionId != request->TransactionId) {
+                    // Response to an earlier cancelled transaction
+                    continue;
+                }
                 response->ResponseCode = responseCode;
                 // Read any params as well
                 if (payloadLen > 6) {
-                    u32 numParams = (payloadLen - 6) / 4;
-                    for (int i = 0; i < numParams; ++i) {
+                    u32 numResponseParams = (payloadLen - 6) / 4;
+                    for (int i = 0; i < numResponseParams && i < 5; ++i) {
                         u32 param = 0;
                         MMemReadU32LE(&inRead, &param);
                         response->Params[i] = param;
@@ -285,37 +692,39 @@ static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* reque
         } else if (responseType == PTPIP_TYPE_DATA_PACKET_START) {
             if (payloadLen >= 12) {
                 u32 transactionId;
+                u64 length;
                 MMemReadU32LE(&inRead, &transactionId);
-                MMemReadU64LE(&inRead, &transferLen);
+                MMemReadU64LE(&inRead, &length);
+                if (transactionId != request->TransactionId) {
+                    continue;
+                }
+                transferLen = length;
 
-                if (transferLen > (u64)dataOutSize) {
+                if (!stream && transferLen > (u64)dataOutSize) {
                     AW_WARNING_F("Response data size: %llu but buffer out only: %llu", transferLen, (u64)dataOutSize);
                 }
             } else {
                 error.code = AW_RESULT_MALFORMED_RESPONSE;
                 goto exitWithError;
             }
-        } else if (responseType == PTPIP_TYPE_DATA_PACKET) {
-            if (payloadLen >= 4) {
+        } else if (responseType == PTPIP_TYPE_DATA_PACKET_END) {
+            if (payloadLen == 4) {
                 u32 transactionId;
                 MMemReadU32LE(&inRead, &transactionId);
-                payloadLen -= 4;
-
-                if (payloadLen > 0) {
-                    if (dataRemaining >= payloadLen) {
-                        MMemReadU8CopyN(&inRead, (u8*)dataOutCurrent, payloadLen);
-                        dataRemaining -= payloadLen;
-                        dataOutCurrent += payloadLen;
-                    }
-                }
             } else {
                 error.code = AW_RESULT_MALFORMED_RESPONSE;
                 goto exitWithError;
             }
-        } else if (responseType == PTPIP_TYPE_DATA_PACKET_END) {
+        } else if (responseType == PTPIP_TYPE_DATA_PACKET_CANCEL) {
+            // Responder stopped the data phase, no response follows
             if (payloadLen == 4) {
                 u32 transactionId;
                 MMemReadU32LE(&inRead, &transactionId);
+                if (transactionId == request->TransactionId) {
+                    error.code = AW_RESULT_CANCELLED;
+                    MMemFree(&staging);
+                    return error;
+                }
             } else {
                 error.code = AW_RESULT_MALFORMED_RESPONSE;
                 goto exitWithError;
@@ -324,21 +733,21 @@ static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* reque
             error.code = AW_RESULT_MALFORMED_RESPONSE;
             goto exitWithError;
         }
+    }
 
-        // Copy partial packet
-        if (bytesReadAfterPacket > 0) {
-            memcpy(in.mem, (u8*)in.mem + responseLen, bytesReadAfterPacket);
-            in.size = bytesReadAfterPacket;
-            inRead.size = 0;
-        } else if (in.size == inRead.size) {
-            in.size = 0;
-            inRead.size = 0;
-        }
+    if (stream && staging.size) {
+        AwDataSink_Write(stream, staging.mem, staging.size);
     }
 
     *actualDataOutSize = dataOutCurrent - dataOut;
-    MMemFree(&in);
+    if (outDataLength) {
+        *outDataLength = transferLen;
+    }
+    MMemFree(&staging);
 
+    if (discarded) {
+        return (AwResult){.code=AW_RESULT_CANCELLED,.ptp=response->ResponseCode};
+    }
     if (response->ResponseCode == PTP_OK) {
         return (AwResult){.code=AW_RESULT_OK,.ptp=PTP_OK};
     } else {
@@ -346,11 +755,165 @@ static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* reque
     }
 
 exitWithError:
-    MMemFree(&out);
-    MMemFree(&in);
+    // The stream is out of sync with the packet boundaries, drop whatever was buffered
+    in->start = 0;
+    in->end = 0;
+    MMemFree(&staging);
     return error;
 }
 
+// Track the running transaction for AwDeviceIp_Cancel(), a failed transaction that was cancelled is reported as
+// cancelled, if it completed with all of its data its result stands
+static AwResult AwDeviceIp_CancellableTransaction(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn,
+                                                  size_t dataInSize, AwPtpResponseHeader* response, u8* dataOut,
+                                                  size_t dataOutSize, AwDataSink* stream, size_t* actualDataOutSize,
+                                                  u64* outDataLength) {
+    PTPIpDevice* dev = (PTPIpDevice*)self->device;
+    ATOMIC_STORE_U32(&dev->cancelClaimed, 0);
+    ATOMIC_STORE_U32(&dev->cancelRequested, 0);
+    ATOMIC_STORE_U32(&dev->activeTransactionId, request->TransactionId);
+    ATOMIC_STORE_U32(&dev->inTransaction, 1);
+    AwResult result = AwDeviceIp_Transaction(self, request, dataIn, dataInSize, response, dataOut, dataOutSize,
+                                             stream, actualDataOutSize, outDataLength);
+    ATOMIC_STORE_U32(&dev->inTransaction, 0);
+    if (result.code != AW_RESULT_OK &&
+            ATOMIC_LOAD_U32(&dev->cancelRequested) == PTPIP_CANCEL_TOKEN(request->TransactionId)) {
+        result = (AwResult){.code=AW_RESULT_CANCELLED};
+    }
+    if (result.code == AW_RESULT_CANCELLED) {
+        AW_DEBUG_F("Transaction %u cancelled", request->TransactionId);
+    }
+    return result;
+}
+
+// CancelTransaction event on the event connection, cancels the operation itself.  The data connection cancel packet is
+// only sent by the side sending the data phase, for the host that's the transaction itself.
+static AwResult AwDeviceIp_SendCancel(AwDevice* self, u32 transactionId) {
+    PTPIpDevice* dev = (PTPIpDevice*)self->device;
+    u8 eventMem[14];
+    MMemIO out;
+    MMemInit(&out, NULL, eventMem, sizeof(eventMem));
+    MMemWriteU32LE(&out, sizeof(eventMem));
+    MMemWriteU32LE(&out, PTPIP_TYPE_EVENT);
+    MMemWriteU16LE(&out, PTPIP_EVENT_CANCEL_TRANSACTION);
+    MMemWriteU32LE(&out, transactionId);
+    int s = TcpSendAllBytes(dev->eventSock, out.mem, out.size);
+    if (s <= 0) {
+        AW_ERROR("Failed to send cancel transaction event");
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+    return (AwResult){.code=AW_RESULT_OK};
+}
+
+// The camera answers with a cancel packet of its own in place of the rest of the data phase, or the response.  Sending
+// data to the camera stops at the next data packet.
+static AwResult AwDeviceIp_Cancel(AwDevice* self) {
+    PTPIpDevice* dev = (PTPIpDevice*)self->device;
+    u32 transactionId = ATOMIC_LOAD_U32(&dev->activeTransactionId);
+    u32 token = PTPIP_CANCEL_TOKEN(transactionId);
+    if (!ATOMIC_LOAD_U32(&dev->inTransaction)) {
+        return (AwResult){.code=AW_RESULT_OK};
+    }
+
+    // Claim the cancel for this transaction, only the first caller sends it
+    for (;;) {
+        u32 claimed = ATOMIC_LOAD_U32(&dev->cancelClaimed);
+        if (claimed == token) {
+            return (AwResult){.code=AW_RESULT_OK};
+        }
+        if (ATOMIC_CAS_U32(&dev->cancelClaimed, claimed, token)) {
+            break;
+        }
+    }
+    // The transaction may have ended while claiming, never cancel the one after it
+    if (!ATOMIC_LOAD_U32(&dev->inTransaction) || ATOMIC_LOAD_U32(&dev->activeTransactionId) != transactionId) {
+        return (AwResult){.code=AW_RESULT_OK};
+    }
+
+    AwResult r = AwDeviceIp_SendCancel(self, transactionId);
+    if (r.code != AW_RESULT_OK) {
+        // Let a later call try again
+        ATOMIC_CAS_U32(&dev->cancelClaimed, token, 0);
+        return r;
+    }
+    ATOMIC_STORE_U32(&dev->cancelRequested, token);
+    return r;
+}
+
+static AwResult AwDeviceIp_SendAndRecv(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                                        AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize,
+                                        size_t* actualDataOutSize) {
+    return AwDeviceIp_CancellableTransaction(self, request, dataIn, dataInSize, response, dataOut, dataOutSize, NULL,
+                                  actualDataOutSize, NULL);
+}
+
+static AwResult AwDeviceIp_SendAndRecvSink(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                                            AwPtpResponseHeader* response, AwDataSink* sink) {
+    sink->size = 0;
+    sink->aborted = FALSE;
+    sink->required = 0;
+    if (sink->write) {
+        size_t unused = 0;
+        return AwDeviceIp_CancellableTransaction(self, request, dataIn, dataInSize, response, NULL, 0, sink, &unused,
+                                                 NULL);
+    }
+    // Data packet payloads are already copied out of the packet buffer, so they can go straight to the sink
+    u64 dataLength = 0;
+    AwResult r = AwDeviceIp_CancellableTransaction(self, request, dataIn, dataInSize, response, sink->mem,
+                                                   sink->capacity, NULL, &sink->size, &dataLength);
+    if (r.code == AW_RESULT_OK && dataLength > sink->capacity) {
+        sink->required = dataLength;
+        r.code = AW_RESULT_BUFFER_TOO_SMALL;
+    }
+    return r;
+}
+
+// Parse the payload of a PTPIP_TYPE_EVENT packet
+static void PTPIp_ParseEvent(u8* payload, u32 payloadSize, AwPtpEvent* outEvent) {
+    MMemIO payloadRead;
+    MMemInitRead(&payloadRead, payload, payloadSize);
+    u16 eventCode = 0;
+    MMemReadU16LE(&payloadRead, &eventCode);
+    outEvent->code = (u32)eventCode;
+    outEvent->size = payloadSize;
+
+    u32 transactionId = 0;
+    MMemReadU32LE(&payloadRead, &transactionId);
+    MMemReadU32LE(&payloadRead, &outEvent->param1);
+    MMemReadU32LE(&payloadRead, &outEvent->param2);
+    MMemReadU32LE(&payloadRead, &outEvent->param3);
+}
+
+// Serviced mode, hand over the events queued by AwIp_ServiceDevices().  With the event thread running, waits up to
+// timeoutMilliseconds for an event to arrive.
+static AwResult AwDeviceIp_TakeQueuedEvents(PTPIpDevice* dev, int timeoutMilliseconds, MAllocator* alloc,
+                                            AwPtpEvent** outEvents) {
+    AwPtpIpBackend* backend = dev->backend;
+    PTPIpLock_Lock(&backend->serviceLock);
+    if (backend->eventThreadStarted && timeoutMilliseconds > 0) {
+        u64 deadline = MGetTimeMilliseconds() + timeoutMilliseconds;
+        while (MArraySize(dev->eventList) == 0 && !dev->closed) {
+            u64 now = MGetTimeMilliseconds();
+            if (now >= deadline) {
+                break;
+            }
+            PTPIpCond_Wait(&backend->eventCond, &backend->serviceLock, (u32)(deadline - now));
+        }
+    }
+    MArrayEachPtr(dev->eventList, it) {
+        MArrayAdd(alloc, *outEvents, *it.p);
+    }
+    b32 gotEvent = MArraySize(dev->eventList) > 0;
+    MArrayClear(dev->eventList);
+    b32 closed = dev->closed;
+    PTPIpLock_Unlock(&backend->serviceLock);
+
+    if (closed && !gotEvent) {
+        return (AwResult){.code=AW_RESULT_CONNECTION_CLOSED};
+    }
+    return (AwResult){.code=AW_RESULT_OK};
+}
+
 // TODO fix PtpResult it's really two things AW error + PTP error code
 static AwResult AwDeviceIp_ReadEvents(AwDevice* self, int timeoutMilliseconds, MAllocator* alloc, AwPtpEvent** outEvents) {
     if (!outEvents) {
@@ -363,6 +926,10 @@ static AwResult AwDeviceIp_ReadEvents(AwDevice* self, int timeoutMilliseconds, M
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
 
+    if (dev->backend->serviceMode) {
+        return AwDeviceIp_TakeQueuedEvents(dev, timeoutMilliseconds, alloc, outEvents);
+    }
+
     // Initialize event buffer on first use
     if (dev->eventMem.allocator == NULL) {
         MMemInitAlloc(&dev->eventMem, self->transport.allocator, 4096);
@@ -410,20 +977,8 @@ static AwResult AwDeviceIp_ReadEvents(AwDevice* self, int timeoutMilliseconds, M
                 }
                 if (packetType == PTPIP_TYPE_EVENT) {
                     AwPtpEvent* outEvent = MArrayAddPtrZ(alloc, *outEvents);
-
-                    MMemIO payloadRead;
-                    MMemInitRead(&payloadRead, inRead.mem + inRead.size, packetLen - 8);
-                    u16 eventCode = 0;
-                    MMemReadU16LE(&payloadRead, &eventCode);
-                    outEvent->code = (u32)eventCode;
-                    outEvent->size = packetLen - 8;
-
-                    u32 transactionId = 0;
-                    MMemReadU32LE(&payloadRead, &transactionId);
-                    MMemReadU32LE(&payloadRead, &outEvent->param1);
-                    MMemReadU32LE(&payloadRead, &outEvent->param2);
-                    MMemReadU32LE(&payloadRead, &outEvent->param3);
-
+                    PTPIp_ParseEvent(inRead.mem + inRead.size, packetLen - 8, outEvent);
+                    outEvent->timestampMicroseconds = MGetTimeMicroseconds();
                     gotEvent = TRUE;
                 }
                 // Skip the rest if the packet
@@ -464,7 +1019,7 @@ static AwResult AwIp_OpenDevice(AwPtpIpBackend* self, AwDeviceInfo* deviceInfo,
     dev.eventSock = MSOCK_INVALID;
     dev.dataSock = MSockMakeTcpSocket();
 
-    MSockSetSocketTimeout(dev.dataSock, 60000);
+    MSockSetSocketTimeout(dev.dataSock, PTPIP_DATA_TIMEOUT_MILLISECONDS);
     MSockAddress socketAddr = {};
     if (MSockConnectHost(dev.dataSock, MStrViewFromStr(deviceInfo->ipAddress), 15740, &socketAddr)
             == MSOCK_ERROR) {
@@ -608,18 +1163,28 @@ static AwResult AwIp_OpenDevice(AwPtpIpBackend* self, AwDeviceInfo* deviceInfo,
 
     MMemFree(&in);
 
-    PTPIpDevice* newDev = MArrayAddPtr(self->allocator, self->openDevices);
-    memset(newDev, 0, sizeof(PTPIpDevice));
+    PTPIpDevice* newDev = MMallocZ(self->allocator, sizeof(PTPIpDevice));
     *newDev = dev;
+    newDev->backend = self;
+    PTPIpLock_Lock(&self->serviceLock);
+    if (++self->nextServiceId == 0) {
+        self->nextServiceId = 1;
+    }
+    newDev->serviceId = self->nextServiceId;
+    MArrayAdd(self->allocator, self->openDevices, newDev);
+    self->pollerDirty = TRUE;
+    PTPIpLock_Unlock(&self->serviceLock);
     AwDevice* device = *deviceOut;
     device->backendType = AW_BACKEND_IP;
     device->device = newDev;
     device->transport.allocator = self->allocator;
     device->transport.sendAndRecv = AwDeviceIp_SendAndRecv;
+    device->transport.sendAndRecvSink = AwDeviceIp_SendAndRecvSink;
     device->transport.reallocBuffer = AwDeviceIp_ReallocBuffer;
     device->transport.freeBuffer = AwDeviceIp_FreeBuffer;
     device->transport.readEvents = AwDeviceIp_ReadEvents;
     device->transport.reset = NULL;
+    device->transport.cancel = AwDeviceIp_Cancel;
     device->transport.requiresSessionOpenClose = TRUE;
     device->logger = self->logger;
     device->disconnected = FALSE;
@@ -637,28 +1202,279 @@ exitWithError:
 static AwResult AwIp_CloseDevice(AwPtpIpBackend* backend, AwDevice* device) {
     AW_TRACE("AwIp_CloseDevice");
     PTPIpDevice* dev = (PTPIpDevice*)device->device;
+
+    // Remove from the serviced list and the poller before closing, so the service loop never reads a closed socket
+    // or a freed device.  A wait already in progress only returns the device's id, which no longer matches.
+    PTPIpLock_Lock(&backend->serviceLock);
+    MArrayEachPtr(backend->openDevices, it) {
+        if (*it.p == dev) {
+            MArrayRemoveIndex(backend->openDevices, it.i);
+            break;
+        }
+    }
+    if (backend->serviceMode && !backend->pollerWaiting) {
+        MSockPollerRemove(&backend->poller, dev->eventSock);
+        MSockPollerRemove(&backend->poller, dev->dataSock);
+    } else {
+        // Resynced before the next wait
+        backend->pollerDirty = TRUE;
+    }
     MSockClose(dev->dataSock);
     MSockClose(dev->eventSock);
+    PTPIpLock_Unlock(&backend->serviceLock);
 
-    // Free event buffer if allocated
+    // Free event & receive buffers if allocated
     MMemFree(&dev->eventMem);
+    MArrayFree(backend->allocator, dev->eventList);
+    if (dev->recvBuffer.mem) {
+        MFree(dev->recvBuffer.allocator, dev->recvBuffer.mem, dev->recvBuffer.capacity);
+    }
+    MFree(backend->allocator, dev, sizeof(PTPIpDevice));
+    device->device = NULL;
+    return (AwResult){.code=AW_RESULT_OK};
+}
 
-    MArrayEachPtr(backend->openDevices, it) {
-        if (it.p == dev) {
-            MArrayRemoveIndex(backend->openDevices, it.i);
+// Read everything waiting on a serviced device's event socket and queue the complete event packets.
+// Returns FALSE if the camera closed the connection.
+static b32 PTPIp_DrainEventSock(AwPtpIpBackend* self, PTPIpDevice* dev) {
+    if (dev->eventMem.allocator == NULL) {
+        MMemInitAlloc(&dev->eventMem, self->allocator, 4096);
+    }
+
+    b32 open = TRUE;
+    for (;;) {
+        if (dev->eventMem.size + 1024 > dev->eventMem.capacity) {
+            MMemGrowBytes(&dev->eventMem, 4096);
+        }
+        int r = MSockRecv(dev->eventSock, dev->eventMem.mem + dev->eventMem.size,
+                          (int)(dev->eventMem.capacity - dev->eventMem.size));
+        if (r > 0) {
+            dev->eventMem.size += r;
+            continue;
+        }
+        if (r == 0 || !MSockGetLastError().timeout) {
+            open = FALSE;
+        }
+        break;
+    }
+
+    u64 arrivalTime = MGetTimeMicroseconds();
+    u32 offset = 0;
+    while (dev->eventMem.size - offset >= 8) {
+        MMemIO inRead;
+        MMemInitRead(&inRead, dev->eventMem.mem + offset, dev->eventMem.size - offset);
+        u32 packetLen = 0;
+        u32 packetType = 0;
+        MMemReadU32LE(&inRead, &packetLen);
+        MMemReadU32LE(&inRead, &packetType);
+        if (packetLen < 8) {
+            AW_ERROR_F("Malformed PTP/IP event packet length: %u", packetLen);
+            offset = dev->eventMem.size;
+            open = FALSE;
+            break;
+        }
+        if (dev->eventMem.size - offset < packetLen) {
             break;
         }
+        if (packetType == PTPIP_TYPE_EVENT) {
+            AwPtpEvent* event = MArrayAddPtrZ(self->allocator, dev->eventList);
+            PTPIp_ParseEvent(dev->eventMem.mem + offset + 8, packetLen - 8, event);
+            event->timestampMicroseconds = arrivalTime;
+        }
+        offset += packetLen;
+    }
+
+    // Keep any partial packet for next time
+    dev->eventMem.size -= offset;
+    if (dev->eventMem.size) {
+        memmove(dev->eventMem.mem, dev->eventMem.mem + offset, dev->eventMem.size);
+    }
+    return open;
+}
+
+// Called with serviceLock held, NULL if the device has been closed
+static PTPIpDevice* AwIp_FindServicedDevice(AwPtpIpBackend* self, u32 serviceId) {
+    MArrayEachPtr(self->openDevices, it) {
+        if ((*it.p)->serviceId == serviceId) {
+            return *it.p;
+        }
+    }
+    return NULL;
+}
+
+// Match the poller to the open devices, event sockets are polled for reads and data sockets for hangups only (the
+// data socket is read by whichever thread is running a transaction).
+static void AwIp_SyncPoller(AwPtpIpBackend* self) {
+    MSockPollerClear(&self->poller);
+    MArrayEachPtr(self->openDevices, it) {
+        PTPIpDevice* dev = *it.p;
+        if (dev->closed) {
+            continue;
+        }
+        MSockSetNonBlocking(dev->eventSock, TRUE);
+        void* userData = (void*)(uintptr_t)dev->serviceId;
+        MSockPollerAdd(&self->poller, dev->eventSock, MSOCK_POLL_READ, userData);
+        MSockPollerAdd(&self->poller, dev->dataSock, 0, userData);
+    }
+    self->pollerDirty = FALSE;
+}
+
+// Called with serviceLock held
+static b32 AwIp_EnterServiceMode(AwPtpIpBackend* self) {
+    if (self->serviceMode) {
+        return TRUE;
+    }
+    if (MSockPollerInit(&self->poller, self->allocator) != 0) {
+        AW_ERROR("Failed to create PTP/IP socket poller");
+        return FALSE;
+    }
+    self->serviceMode = TRUE;
+    self->pollerDirty = TRUE;
+    return TRUE;
+}
+
+// Wait on the sockets of every open device at once and queue the events that arrive.  Events are picked up as soon
+// as the camera sends them, even while other threads are blocked in transactions.
+// The first call switches the backend to serviced mode, after which AwDeviceIp_ReadEvents() returns queued events
+// without touching the socket.  Only one thread should service the backend.
+static AwResult AwIp_ServiceDevices(AwPtpIpBackend* self, int timeoutMilliseconds) {
+    PTPIpLock_Lock(&self->serviceLock);
+    if (!AwIp_EnterServiceMode(self)) {
+        PTPIpLock_Unlock(&self->serviceLock);
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+    if (self->pollerDirty) {
+        AwIp_SyncPoller(self);
+    }
+    self->pollerWaiting = TRUE;
+    PTPIpLock_Unlock(&self->serviceLock);
+
+    MSockPollEvent ready[MSOCK_POLLER_WAIT_MAX];
+    int n = MSockPollerWait(&self->poller, timeoutMilliseconds, ready, MSOCK_POLLER_WAIT_MAX);
+
+    PTPIpLock_Lock(&self->serviceLock);
+    self->pollerWaiting = FALSE;
+    if (n <= 0) {
+        if (n < 0) {
+            // Usually a device was closed while waiting, resync next time around
+            self->pollerDirty = TRUE;
+        }
+        PTPIpLock_Unlock(&self->serviceLock);
+        return (AwResult){.code=n < 0 ? AW_RESULT_TRANSPORT_ERROR : AW_RESULT_TIMEOUT};
+    }
+
+    b32 signal = FALSE;
+    for (int i = 0; i < n; ++i) {
+        // Skip devices closed while waiting
+        PTPIpDevice* dev = AwIp_FindServicedDevice(self, (u32)(uintptr_t)ready[i].userData);
+        if (!dev || dev->closed) {
+            continue;
+        }
+        b32 open = TRUE;
+        if (ready[i].sock == dev->eventSock) {
+            open = PTPIp_DrainEventSock(self, dev);
+            signal |= MArraySize(dev->eventList) > 0;
+        } else if (ready[i].events & MSOCK_POLL_HANGUP) {
+            open = FALSE;
+        }
+        if (!open) {
+            AW_DEBUG("PTP/IP camera closed the connection");
+            dev->closed = TRUE;
+            self->pollerDirty = TRUE;
+            signal = TRUE;
+        }
+    }
+    if (signal) {
+        self->eventSignals++;
+        PTPIpCond_Broadcast(&self->eventCond);
     }
+    PTPIpLock_Unlock(&self->serviceLock);
     return (AwResult){.code=AW_RESULT_OK};
 }
 
+#ifdef _WIN32
+static DWORD WINAPI AwIp_EventThreadProc(LPVOID param) {
+#else
+static void* AwIp_EventThreadProc(void* param) {
+#endif
+    AwPtpIpBackend* self = param;
+    for (;;) {
+        PTPIpLock_Lock(&self->serviceLock);
+        b32 stop = self->eventThreadStop;
+        PTPIpLock_Unlock(&self->serviceLock);
+        if (stop) {
+            break;
+        }
+        AwIp_ServiceDevices(self, PTPIP_EVENT_THREAD_WAIT_MILLISECONDS);
+    }
+    return 0;
+}
+
+static void AwIp_StartEventThread(AwPtpIpBackend* self) {
+    if (!self->spawnEventThread || self->eventThreadStarted) {
+        return;
+    }
+    // Switch over before returning, so ReadEvents() never reads the event socket alongside the thread
+    PTPIpLock_Lock(&self->serviceLock);
+    b32 serviced = AwIp_EnterServiceMode(self);
+    self->eventThreadStop = FALSE;
+    PTPIpLock_Unlock(&self->serviceLock);
+    if (!serviced) {
+        self->spawnEventThread = FALSE;
+        return;
+    }
+#ifdef _WIN32
+    self->eventThread = CreateThread(NULL, 0, AwIp_EventThreadProc, self, 0, NULL);
+    b32 started = self->eventThread != NULL;
+#else
+    b32 started = pthread_create(&self->eventThread, NULL, AwIp_EventThreadProc, self) == 0;
+#endif
+    if (!started) {
+        AW_WARNING("Failed to create PTP/IP event thread, events are read when polled");
+        // Don't retry for every device
+        self->spawnEventThread = FALSE;
+        return;
+    }
+    self->eventThreadStarted = TRUE;
+    AW_DEBUG("Started PTP/IP event thread");
+}
+
+static void AwIp_StopEventThread(AwPtpIpBackend* self) {
+    if (!self->eventThreadStarted) {
+        return;
+    }
+    PTPIpLock_Lock(&self->serviceLock);
+    self->eventThreadStop = TRUE;
+    PTPIpLock_Unlock(&self->serviceLock);
+#ifdef _WIN32
+    WaitForSingleObject(self->eventThread, INFINITE);
+    CloseHandle(self->eventThread);
+#else
+    pthread_join(self->eventThread, NULL);
+#endif
+    self->eventThreadStarted = FALSE;
+}
+
 static AwResult AwIp_RefreshList(AwPtpIpBackend* self, AwDeviceInfo** deviceList) {
     AW_TRACE("AwIp_RefreshList");
 
     self->isDiscoveryInProgress = TRUE;
+    self->needsRefresh = FALSE;
     self->discoveryStartTime = MGetTimeMilliseconds();
     MSockClose(self->discoverySock);
 
+    // Cached descriptions are listed again as their cameras respond, expired ones are dropped
+    for (u32 i = 0; i < MArraySize(self->descriptions);) {
+        PTPIpDescription* desc = self->descriptions + i;
+        if (desc->expireTime <= self->discoveryStartTime) {
+            AwIp_FreeDescription(self, desc);
+            MArrayRemoveIndex(self->descriptions, i);
+        } else {
+            desc->listed = FALSE;
+            i++;
+        }
+    }
+
     // SSDP Discovery
     self->discoverySock = MSockMakeUdpSocket();
     int broadcast = 1;
@@ -719,6 +1535,273 @@ exitWithError:
     return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
 }
 
+// Find a header in an SSDP message, header names are case-insensitive
+static b32 Ssdp_GetHeader(MStrView message, const char* name, MStrView* outValue) {
+    u32 nameLen = MCStrLen(name);
+    while (!MStrViewIsEmpty(message)) {
+        i32 lineEnd = MStrViewFindC(message, "\r\n");
+        MStrView line = lineEnd >= 0 ? MStrViewLeft(message, lineEnd) : message;
+        if (line.size > nameLen && line.str[nameLen] == ':') {
+            b32 match = TRUE;
+            for (u32 i = 0; i < nameLen && match; ++i) {
+                char c = line.str[i];
+                if (c >= 'A' && c <= 'Z') {
+                    c = (char)(c - 'A' + 'a');
+                }
+                match = (c == name[i]);
+            }
+            if (match) {
+                MStrView value = MStrViewSub(line, (i32)nameLen + 1, -1);
+                while (!MStrViewIsEmpty(value) && MCharIsWhitespace(value.str[0])) {
+                    MStrViewAdvance(&value, 1);
+                }
+                *outValue = value;
+                return TRUE;
+            }
+        }
+        if (lineEnd < 0) {
+            break;
+        }
+        MStrViewAdvance(&message, lineEnd + 2);
+    }
+    return FALSE;
+}
+
+static b32 Ssdp_IsSonyImaging(MStrView usn) {
+    return MStrViewFindC(usn, ":urn:schemas-sony-com:service:DigitalImaging") != -1;
+}
+
+// Seconds the advertisement is valid for, from 'CACHE-CONTROL: max-age=N'
+static u32 Ssdp_GetMaxAge(MStrView message) {
+    MStrView cacheControl = {0};
+    if (Ssdp_GetHeader(message, "cache-control", &cacheControl)) {
+        i32 maxAgePos = MStrViewFindC(cacheControl, "max-age");
+        if (maxAgePos >= 0) {
+            MStrView value = MStrViewSub(cacheControl, maxAgePos + 7, -1);
+            while (!MStrViewIsEmpty(value) && (value.str[0] == '=' || MCharIsWhitespace(value.str[0]))) {
+                MStrViewAdvance(&value, 1);
+            }
+            i32 maxAge = 0;
+            MParseResult r = MParseI32(value.str, MStrViewEnd(value), &maxAge);
+            if (r.result == MParse_SUCCESS && maxAge > 0) {
+                return (u32)maxAge;
+            }
+        }
+    }
+    return SSDP_MAX_AGE_DEFAULT_SECONDS;
+}
+
+static PTPIpDescription* AwIp_FindDescription(AwPtpIpBackend* self, MStrView usn) {
+    MArrayEachPtr(self->descriptions, it) {
+        if (MStrViewCmp(MStrViewFromStr(it.p->usn), usn) == 0) {
+            return it.p;
+        }
+    }
+    return NULL;
+}
+
+static b32 AwIp_IsFetchingDescription(AwPtpIpBackend* self, MStrView usn) {
+    MArrayEachPtr(self->descriptionFetches, it) {
+        if (MStrViewCmp(MStrViewFromStr(it.p->usn), usn) == 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// Add a cached description to the device list, once per refresh
+static b32 AwIp_ListDescription(AwPtpIpBackend* self, PTPIpDescription* desc, AwDeviceInfo** deviceList) {
+    if (desc->listed) {
+        return FALSE;
+    }
+    AwDeviceInfo* info = MArrayAddPtrZ(self->allocator, *deviceList);
+    info->backendType = AW_BACKEND_IP;
+    info->product = MStrMakeCopyStr(self->allocator, desc->product);
+    info->manufacturer = MStrMakeCopyStr(self->allocator, desc->manufacturer);
+    info->ipAddress = MStrMakeCopyStr(self->allocator, desc->ipAddress);
+    info->device = (void*)info->ipAddress.str; // Store host as device data
+    desc->listed = TRUE;
+    return TRUE;
+}
+
+// Pull the camera model and manufacturer out of a UPnP device description
+static b32 AwIp_ParseDescription(AwPtpIpBackend* self, MStrView body, MStr* outProduct, MStr* outManufacturer) {
+    MXml parser;
+    MXml_Init(&parser, body);
+
+    MStrView cameraModelTag = MStrViewFromCStr("friendlyName");
+    MStrView manufacturerTag = MStrViewFromCStr("manufacturer");
+    MStrView currentTag = {0};
+    MStr cameraModel = {0};
+    MStr manufacturer = {0};
+
+    MXmlToken token;
+    while ((token = MXml_NextToken(&parser)).type != MXmlTokenType_EOF && token.type != MXmlTokenType_ERROR) {
+        if (token.type == MXmlTokenType_TAG_START) {
+            currentTag = token.name;
+        } else if (token.type == MXmlTokenType_TEXT) {
+            if (MStrIsEmpty(cameraModel) && MStrViewEq(&cameraModelTag, &currentTag)) {
+                cameraModel = MStrMakeCopyLen(self->allocator, token.value.str, token.value.size);
+            } else if (MStrIsEmpty(manufacturer) && MStrViewEq(&manufacturerTag, &currentTag)) {
+                manufacturer = MStrMakeCopyLen(self->allocator, token.value.str, token.value.size);
+            }
+        } else if (token.type == MXmlTokenType_TAG_CLOSE) {
+            currentTag = (MStrView){0};
+        }
+
+        if (!MStrIsEmpty(cameraModel) && !MStrIsEmpty(manufacturer)) {
+            break;
+        }
+    }
+
+    if (MStrIsEmpty(cameraModel)) {
+        MStrFree(self->allocator, manufacturer);
+        return FALSE;
+    }
+    *outProduct = cameraModel;
+    *outManufacturer = manufacturer;
+    return TRUE;
+}
+
+// Cache hit if the description is unexpired and still at the same location, the expiry is pushed out to maxAgeSeconds
+static PTPIpDescription* AwIp_FindValidDescription(AwPtpIpBackend* self, MStrView usn, MStrView location,
+                                                   u32 maxAgeSeconds) {
+    u64 now = MGetTimeMilliseconds();
+    PTPIpDescription* desc = AwIp_FindDescription(self, usn);
+    if (desc && desc->expireTime > now && MStrViewCmp(MStrViewFromStr(desc->location), location) == 0) {
+        desc->expireTime = now + (u64)maxAgeSeconds * 1000;
+        return desc;
+    }
+    return NULL;
+}
+
+static void AwIp_StartDescriptionFetch(AwPtpIpBackend* self, MStrView usn, MStrView location, u32 maxAgeSeconds) {
+    if (AwIp_IsFetchingDescription(self, usn)) {
+        return;
+    }
+
+    AW_INFO_F("Found Sony Imaging device at location: %.*s", location.size, location.str);
+    if (!self->discoveryPollerInit) {
+        if (MSockPollerInit(&self->discoveryPoller, self->allocator) != 0) {
+            AW_ERROR("Failed to create SSDP description poller");
+            return;
+        }
+        self->discoveryPollerInit = TRUE;
+    }
+
+    PTPIpDescriptionFetch fetch = {0};
+    if (!Http_GetStart(self->allocator, location, PTPIP_DESCRIPTION_TIMEOUT_MILLISECONDS, &fetch.request)) {
+        AW_ERROR_F("Failed to request device description: %.*s", location.size, location.str);
+        Http_FreeRequest(&fetch.request);
+        return;
+    }
+    fetch.usn = MStrMakeCopyLen(self->allocator, usn.str, usn.size);
+    fetch.location = MStrMakeCopyLen(self->allocator, location.str, location.size);
+    fetch.maxAgeSeconds = maxAgeSeconds;
+    MSockPollerAdd(&self->discoveryPoller, fetch.request.sock, Http_RequestWaitEvents(&fetch.request), NULL);
+    MArrayAdd(self->allocator, self->descriptionFetches, fetch);
+}
+
+// A camera answered the M-SEARCH, list it straight from the cache when its description is still valid, otherwise
+// start fetching the description alongside any other fetches in flight
+static b32 AwIp_HandleSsdpResponse(AwPtpIpBackend* self, MStrView usn, MStrView location, u32 maxAgeSeconds,
+                                   AwDeviceInfo** deviceList) {
+    PTPIpDescription* desc = AwIp_FindValidDescription(self, usn, location, maxAgeSeconds);
+    if (desc) {
+        return AwIp_ListDescription(self, desc, deviceList);
+    }
+    AwIp_StartDescriptionFetch(self, usn, location, maxAgeSeconds);
+    return FALSE;
+}
+
+// Cache the fetched description and list the device, deviceList is NULL when not refreshing
+static b32 AwIp_CompleteDescriptionFetch(AwPtpIpBackend* self, PTPIpDescriptionFetch* fetch,
+                                         AwDeviceInfo** deviceList) {
+    HttpResponse* resp = &fetch->request.response;
+    if (fetch->request.state != HttpRequestState_Done || resp->statusCode != 200) {
+        AW_ERROR_F("Failed to fetch device description: %.*s", fetch->location.size, fetch->location.str);
+        return FALSE;
+    }
+
+    MStr product = {0};
+    MStr manufacturer = {0};
+    if (!AwIp_ParseDescription(self, resp->body, &product, &manufacturer)) {
+        return FALSE;
+    }
+
+    PTPIpDescription* desc = AwIp_FindDescription(self, MStrViewFromStr(fetch->usn));
+    b32 listed = FALSE;
+    if (desc) {
+        listed = desc->listed;
+        AwIp_FreeDescription(self, desc);
+    } else {
+        desc = MArrayAddPtr(self->allocator, self->descriptions);
+    }
+    memset(desc, 0, sizeof(PTPIpDescription));
+    desc->usn = fetch->usn;
+    desc->location = fetch->location;
+    fetch->usn = (MStr){0};
+    fetch->location = (MStr){0};
+    desc->product = product;
+    desc->manufacturer = manufacturer;
+    desc->expireTime = MGetTimeMilliseconds() + (u64)fetch->maxAgeSeconds * 1000;
+    desc->listed = listed;
+
+    HttpUrl hurl = {};
+    Http_ParseUrl(self->allocator, MStrViewFromStr(desc->location), &hurl);
+    desc->ipAddress = MStrMakeCopyLen(self->allocator, hurl.host.str, hurl.host.size);
+    Http_FreeUrl(self->allocator, &hurl);
+
+    if (!deviceList) {
+        // Found passively, outside of a refresh
+        if (!desc->listed) {
+            self->needsRefresh = TRUE;
+        }
+        return FALSE;
+    }
+    return AwIp_ListDescription(self, desc, deviceList);
+}
+
+// Advance all description fetches without blocking
+static b32 AwIp_UpdateDescriptionFetches(AwPtpIpBackend* self, AwDeviceInfo** deviceList) {
+    if (!MArraySize(self->descriptionFetches)) {
+        return FALSE;
+    }
+
+    MSockPollEvent ready[MSOCK_POLLER_WAIT_MAX];
+    int n = MSockPollerWait(&self->discoveryPoller, 0, ready, MSOCK_POLLER_WAIT_MAX);
+    for (int i = 0; i < n; ++i) {
+        MArrayEachPtr(self->descriptionFetches, it) {
+            if (it.p->request.sock == ready[i].sock) {
+                u32 waitEvents = Http_RequestWaitEvents(&it.p->request);
+                if (!Http_RequestUpdate(&it.p->request, ready[i].events)
+                        && Http_RequestWaitEvents(&it.p->request) != waitEvents) {
+                    MSockPollerRemove(&self->discoveryPoller, it.p->request.sock);
+                    MSockPollerAdd(&self->discoveryPoller, it.p->request.sock,
+                                   Http_RequestWaitEvents(&it.p->request), NULL);
+                }
+                break;
+            }
+        }
+    }
+
+    b32 foundDevice = FALSE;
+    for (u32 i = 0; i < MArraySize(self->descriptionFetches);) {
+        PTPIpDescriptionFetch* fetch = self->descriptionFetches + i;
+        // Also catches requests that timed out without their socket becoming ready
+        if (!Http_RequestUpdate(&fetch->request, 0)) {
+            i++;
+            continue;
+        }
+        if (AwIp_CompleteDescriptionFetch(self, fetch, deviceList)) {
+            foundDevice = TRUE;
+        }
+        AwIp_FreeDescriptionFetch(self, fetch);
+        MArrayRemoveIndex(self->descriptionFetches, i);
+    }
+    return foundDevice;
+}
+
 static b32 AwIp_PollListUpdates(AwPtpIpBackend* self, AwDeviceInfo** deviceList) {
     b32 foundDevice = FALSE;
     char buffer[4096];
@@ -728,99 +1811,137 @@ static b32 AwIp_PollListUpdates(AwPtpIpBackend* self, AwDeviceInfo** deviceList)
 
     while ((n = recvfrom(self->discoverySock, buffer, sizeof(buffer)-1, 0, (struct sockaddr*)&from, &fromLen)) > 0) {
         MStrView view = MStrViewMakeP(buffer, n);
-        i32 locPos = MStrViewFindC(view, "LOCATION:");
-        if (locPos == -1) {
-            locPos = MStrViewFindC(view, "location:");
+        MStrView location = {0};
+        MStrView usn = {0};
+        if (Ssdp_GetHeader(view, "location", &location) && Ssdp_GetHeader(view, "usn", &usn)) {
+            if (Ssdp_IsSonyImaging(usn)) {
+                if (AwIp_HandleSsdpResponse(self, usn, location, Ssdp_GetMaxAge(view), deviceList)) {
+                    foundDevice = TRUE;
+                }
+            }
         }
+    }
 
-        i32 usnPos = MStrViewFindC(view, "USN:");
-        if (usnPos == -1) {
-            usnPos = MStrViewFindC(view, "usn:");
-        }
+    if (AwIp_UpdateDescriptionFetches(self, deviceList)) {
+        foundDevice = TRUE;
+    }
 
-        if (locPos != -1 && usnPos != -1) {
-            MStrView location = MStrViewSub(view, locPos + 9, -1);
-            while (!MStrViewIsEmpty(location) && location.str[0] == ' ') {
-                MStrViewAdvance(&location, 1);
-            }
-            i32 locEndPos = MStrViewFindC(location, "\r\n");
+    u64 currentTime = MGetTimeMilliseconds();
+    if (self->discoverySock != MSOCK_INVALID && currentTime - self->discoveryStartTime > 10000) {
+        AW_TRACE("SSDP discovery stopped after waiting for responses for 10s.");
+        MSockClose(self->discoverySock);
+    }
+    if (self->discoverySock == MSOCK_INVALID && !MArraySize(self->descriptionFetches)) {
+        self->isDiscoveryInProgress = FALSE;
+    }
+    return foundDevice;
+}
+
+// Listen on the SSDP multicast group for cameras announcing themselves, so joins and leaves are seen without
+// sending M-SEARCH requests
+static void AwIp_OpenNotifyListener(AwPtpIpBackend* self) {
+    self->notifySock = MSockMakeUdpSocket();
+    if (self->notifySock == MSOCK_INVALID) {
+        return;
+    }
+    // Share the port with any other SSDP listeners on this host
+    MSockSetReuseAddress(self->notifySock, TRUE);
+    if (MSockBind(self->notifySock, NULL, SSDP_PORT) != 0) {
+        AW_WARNING_F("SSDP NOTIFY listener could not bind port %d: %d, cameras are only found by refreshing",
+                     SSDP_PORT, MSockGetLastError().code);
+        MSockClose(self->notifySock);
+        return;
+    }
+    MSockSetNonBlocking(self->notifySock, TRUE);
 
-            MStrView usn = MStrViewSub(view, usnPos + 4, -1);
-            while (!MStrViewIsEmpty(usn) && usn.str[0] == ' ') {
-                MStrViewAdvance(&usn, 1);
+    int joined = 0;
+    MSockInterface* interfaces = NULL;
+    if (MSockGetInterfaces(self->allocator, &interfaces, MSockIfAddrFlag_IPV4)) {
+        MArrayEachPtr(interfaces, it) {
+            struct sockaddr_in* ip = (struct sockaddr_in*)&it.p->addr;
+            char ipStr[INET6_ADDRSTRLEN];
+            if (inet_ntop(AF_INET, &ip->sin_addr, ipStr, sizeof(ipStr)) == NULL) {
+                continue;
             }
+            if (MSockJoinMulticastGroup(self->notifySock, SSDP_MULTICAST_ADDR_STR, ipStr) == 0) {
+                joined++;
+            } else {
+                AW_WARNING_F("SSDP NOTIFY listener failed to join group on interface: %s", ipStr);
+            }
+        }
+    }
+    MArrayFree(self->allocator, interfaces);
 
-            i32 usnEndPos = MStrViewFindC(usn, "\r\n");
-
-            if (locEndPos != -1 && usnEndPos != -1) {
-                usn = MStrViewLeft(usn, usnEndPos);
-                b32 isSonyImaging = MStrViewFindC(usn, ":urn:schemas-sony-com:service:DigitalImaging") != -1;
-
-                if (isSonyImaging) {
-                    MStrView url = MStrViewLeft(location, locEndPos);
-                    AW_INFO_F("Found Sony Imaging device at location: %.*s", url.size, url.str);
-                    HttpResponse resp;
-                    if (Http_Get(self->allocator, url, &resp)) {
-                        if (resp.statusCode == 200) {
-                            MXml parser;
-                            MXml_Init(&parser, resp.body);
-
-                            MStrView cameraModelTag = MStrViewFromCStr("friendlyName");
-                            MStrView manufacturerTag = MStrViewFromCStr("manufacturer");
-                            MStrView currentTag = {0};
-                            MStr cameraModel = {0};
-                            MStr manufacturer = {0};
-
-                            MXmlToken token;
-                            while ((token = MXml_NextToken(&parser)).type != MXmlTokenType_EOF && token.type != MXmlTokenType_ERROR) {
-                                if (token.type == MXmlTokenType_TAG_START) {
-                                    currentTag = token.name;
-                                } else if (token.type == MXmlTokenType_TEXT) {
-                                    if (MStrViewEq(&cameraModelTag, &currentTag)) {
-                                        cameraModel = MStrMakeCopyLen(self->allocator, token.value.str, token.value.size);
-                                    } else if (MStrViewEq(&manufacturerTag, &currentTag)) {
-                                        manufacturer = MStrMakeCopyLen(self->allocator, token.value.str, token.value.size);
-                                    }
-                                } else if (token.type == MXmlTokenType_TAG_CLOSE) {
-                                    currentTag = (MStrView){0};
-                                }
-
-                                if (!MStrIsEmpty(cameraModel) && !MStrIsEmpty(manufacturer)) {
-                                    break;
-                                }
-                            }
-
-                            if (!MStrIsEmpty(cameraModel)) {
-                                AwDeviceInfo* info = MArrayAddPtrZ(self->allocator, *deviceList);
-                                info->backendType = AW_BACKEND_IP;
-                                info->product = cameraModel;
-                                info->manufacturer = manufacturer;
-
-                                HttpUrl hurl = {};
-                                Http_ParseUrl(self->allocator, url, &hurl);
-                                info->ipAddress = MStrMakeCopyLen(self->allocator, hurl.host.str, hurl.host.size);
-                                info->device = (void*)info->ipAddress.str; // Store host as device data
-                                Http_FreeUrl(self->allocator, &hurl);
-                                foundDevice = TRUE;
-                            }
-                        }
-                        Http_FreeResponse(self->allocator, &resp);
-                    }
+    if (!joined && MSockJoinMulticastGroup(self->notifySock, SSDP_MULTICAST_ADDR_STR, NULL) != 0) {
+        AW_WARNING("SSDP NOTIFY listener failed to join multicast group, cameras are only found by refreshing");
+        MSockClose(self->notifySock);
+    }
+}
+
+// Drain NOTIFY messages, a Sony camera saying ssdp:alive has its description cached (fetching it if needed) and
+// ssdp:byebye drops it.  Either flags a refresh if the device list is now out of date.
+static void AwIp_PollNotifications(AwPtpIpBackend* self) {
+    char buffer[4096];
+    int n;
+    while ((n = MSockRecvFrom(self->notifySock, buffer, sizeof(buffer) - 1, NULL, 0, NULL)) > 0) {
+        MStrView view = MStrViewMakeP(buffer, n);
+        if (MStrViewFindC(view, "NOTIFY ") != 0) {
+            continue; // M-SEARCH requests from other control points
+        }
+
+        MStrView nts = {0};
+        MStrView usn = {0};
+        if (!Ssdp_GetHeader(view, "nts", &nts) || !Ssdp_GetHeader(view, "usn", &usn) || !Ssdp_IsSonyImaging(usn)) {
+            continue;
+        }
+
+        if (MStrViewFindC(nts, "ssdp:byebye") != -1) {
+            PTPIpDescription* desc = AwIp_FindDescription(self, usn);
+            if (desc) {
+                AW_INFO_F("Sony Imaging device left: %.*s", desc->product.size, desc->product.str);
+                if (desc->listed) {
+                    self->needsRefresh = TRUE;
+                }
+                AwIp_FreeDescription(self, desc);
+                MArrayRemoveIndex(self->descriptions, desc - self->descriptions);
+            }
+            MArrayEachPtr(self->descriptionFetches, it) {
+                if (MStrViewCmp(MStrViewFromStr(it.p->usn), usn) == 0) {
+                    AwIp_FreeDescriptionFetch(self, it.p);
+                    MArrayRemoveIndex(self->descriptionFetches, it.i);
+                    break;
                 }
             }
+        } else if (MStrViewFindC(nts, "ssdp:alive") != -1) {
+            MStrView location = {0};
+            if (!Ssdp_GetHeader(view, "location", &location)) {
+                continue;
+            }
+            PTPIpDescription* desc = AwIp_FindValidDescription(self, usn, location, Ssdp_GetMaxAge(view));
+            if (desc) {
+                if (!desc->listed) {
+                    self->needsRefresh = TRUE;
+                }
+            } else {
+                AwIp_StartDescriptionFetch(self, usn, location, Ssdp_GetMaxAge(view));
+            }
         }
     }
 
-    u64 currentTime = MGetTimeMilliseconds();
-    if (currentTime - self->discoveryStartTime > 10000) {
-        AW_TRACE("SSDP discovery stopped after waiting for responses for 10s.");
-        MSockClose(self->discoverySock);
+    if (!self->isDiscoveryInProgress) {
+        // Outside a refresh the fetches are only advanced here
+        AwIp_UpdateDescriptionFetches(self, NULL);
     }
-    return foundDevice;
+}
+
+static b32 AwIp_NeedsRefresh(AwPtpIpBackend* self) {
+    AwIp_PollNotifications(self);
+    return self->needsRefresh;
 }
 
 static AwResult AwIp_Close_(AwBackend* backend) {
     AwPtpIpBackend* self = backend->self;
+    AwIp_StopEventThread(self);
     AwResult r = AwIp_Close(self);
     MFree(self->allocator, self, sizeof(AwPtpIpBackend));
     return r;
@@ -853,7 +1974,11 @@ static AwResult AwIp_ReleaseList_(AwBackend* backend) {
 
 static AwResult AwIp_OpenDevice_(AwBackend* backend, AwDeviceInfo* deviceInfo, AwDevice** deviceOut) {
     AwPtpIpBackend* self = backend->self;
-    return AwIp_OpenDevice(self, deviceInfo, deviceOut);
+    AwResult r = AwIp_OpenDevice(self, deviceInfo, deviceOut);
+    if (r.code == AW_RESULT_OK) {
+        AwIp_StartEventThread(self);
+    }
+    return r;
 }
 
 static AwResult AwIp_CloseDevice_(AwBackend* backend, AwDevice* device) {
@@ -861,6 +1986,47 @@ static AwResult AwIp_CloseDevice_(AwBackend* backend, AwDevice* device) {
     return AwIp_CloseDevice(self, device);
 }
 
+// Called with serviceLock held
+static b32 AwIp_HasQueuedEvents(AwPtpIpBackend* self) {
+    MArrayEachPtr(self->openDevices, it) {
+        if (MArraySize((*it.p)->eventList) > 0) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// Already serviced by the event thread, wait for it to queue something (or a device to close) like a service call
+// would.  Returns AW_RESULT_TIMEOUT if nothing arrived in time.
+static AwResult AwIp_WaitForServicedEvents(AwPtpIpBackend* self, int timeoutMilliseconds) {
+    u64 deadline = MGetTimeMilliseconds() + (timeoutMilliseconds > 0 ? timeoutMilliseconds : 0);
+    PTPIpLock_Lock(&self->serviceLock);
+    u32 signals = self->eventSignals;
+    b32 arrived = AwIp_HasQueuedEvents(self);
+    while (!arrived && !self->eventThreadStop) {
+        u32 waitMs = PTPIP_EVENT_THREAD_WAIT_MILLISECONDS;
+        if (timeoutMilliseconds >= 0) {
+            u64 now = MGetTimeMilliseconds();
+            if (now >= deadline) {
+                break;
+            }
+            waitMs = (u32)(deadline - now);
+        }
+        PTPIpCond_Wait(&self->eventCond, &self->serviceLock, waitMs);
+        arrived = self->eventSignals != signals;
+    }
+    PTPIpLock_Unlock(&self->serviceLock);
+    return (AwResult){.code=arrived ? AW_RESULT_OK : AW_RESULT_TIMEOUT};
+}
+
+static AwResult AwIp_ServiceDevices_(AwBackend* backend, int timeoutMilliseconds) {
+    AwPtpIpBackend* self = backend->self;
+    if (self->eventThreadStarted) {
+        return AwIp_WaitForServicedEvents(self, timeoutMilliseconds);
+    }
+    return AwIp_ServiceDevices(self, timeoutMilliseconds);
+}
+
 AwResult AwIpDeviceList_OpenBackend(AwBackend* backend, int timeoutMilliseconds) {
     AW_LOG_TRACE(&backend->logger, "AwIpDeviceList_OpenBackend");
 
@@ -878,10 +2044,17 @@ AwResult AwIpDeviceList_OpenBackend(AwBackend* backend, int timeoutMilliseconds)
     backend->releaseList = AwIp_ReleaseList_;
     backend->openDevice = AwIp_OpenDevice_;
     backend->closeDevice = AwIp_CloseDevice_;
+    backend->serviceDevices = AwIp_ServiceDevices_;
     backend->type = AW_BACKEND_IP;
     self->timeoutMilliseconds = timeoutMilliseconds;
     self->logger = backend->logger;
     self->allocator = backend->allocator;
+    PTPIpLock_Init(&self->serviceLock);
+    PTPIpCond_Init(&self->eventCond);
+    self->spawnEventThread = !backend->config.disallowSpawnEventThread;
+    self->discoverySock = MSOCK_INVALID;
     MSockInit();
+    // Opens a socket, so must come after MSockInit() (WSAStartup() on Windows)
+    AwIp_OpenNotifyListener(self);
     return (AwResult){.code=AW_RESULT_OK};
 }
@@ -190,6 +190,16 @@ static b32 Http_ParseResponseHeaders(HttpResponse* response) {
     return TRUE;
 }
 
+static void Http_WriteGetRequest(MMemIO* memIo, HttpUrl* url) {
+    MStrAppendf(memIo,
+        "GET %.*s HTTP/1.1\r\n"
+        "Host: %.*s\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+        url->path.size, url->path.str,
+        url->host.size, url->host.str);
+}
+
 b32 Http_Get(MAllocator* allocator, MStrView url, HttpResponse* outResponse) {
     memset(outResponse, 0, sizeof(HttpResponse));
     MMemInitEmpty(&outResponse->response, allocator);
@@ -214,13 +224,7 @@ b32 Http_Get(MAllocator* allocator, MStrView url, HttpResponse* outResponse) {
 
     MMemIO memIo;
     MMemInitEmpty(&memIo, allocator);
-    MStrAppendf(&memIo,
-        "GET %.*s HTTP/1.1\r\n"
-        "Host: %.*s\r\n"
-        "Connection: close\r\n"
-        "\r\n",
-        parsedUrl.path.size, parsedUrl.path.str,
-        parsedUrl.host.size, parsedUrl.host.str);
+    Http_WriteGetRequest(&memIo, &parsedUrl);
 
     MSockSendAll(sock, &memIo);
     MMemFree(&memIo);
@@ -242,3 +246,128 @@ b32 Http_Get(MAllocator* allocator, MStrView url, HttpResponse* outResponse) {
 
     return TRUE;
 }
+
+b32 Http_GetStart(MAllocator* allocator, MStrView url, u32 timeoutMilliseconds, HttpRequest* outRequest) {
+    memset(outRequest, 0, sizeof(HttpRequest));
+    outRequest->sock = MSOCK_INVALID;
+    outRequest->allocator = allocator;
+    outRequest->state = HttpRequestState_Failed;
+    outRequest->deadline = MGetTimeMilliseconds() + timeoutMilliseconds;
+
+    HttpUrl parsedUrl;
+    if (!Http_ParseUrl(allocator, url, &parsedUrl)) {
+        return FALSE;
+    }
+
+    outRequest->sock = MSockMakeTcpSocket();
+    if (outRequest->sock == MSOCK_INVALID) {
+        Http_FreeUrl(allocator, &parsedUrl);
+        return FALSE;
+    }
+
+    MSockSetNonBlocking(outRequest->sock, TRUE);
+    if (MSockConnectHost(outRequest->sock, parsedUrl.host, (u16)parsedUrl.port, NULL) == 0) {
+        outRequest->state = HttpRequestState_Sending;
+    } else if (MSockGetLastError().inProgress) {
+        outRequest->state = HttpRequestState_Connecting;
+    } else {
+        MSockClose(outRequest->sock);
+        Http_FreeUrl(allocator, &parsedUrl);
+        return FALSE;
+    }
+
+    MMemInitEmpty(&outRequest->request, allocator);
+    Http_WriteGetRequest(&outRequest->request, &parsedUrl);
+    MMemInitEmpty(&outRequest->response.response, allocator);
+    Http_FreeUrl(allocator, &parsedUrl);
+    return TRUE;
+}
+
+u32 Http_RequestWaitEvents(HttpRequest* request) {
+    switch (request->state) {
+        case HttpRequestState_Connecting:
+        case HttpRequestState_Sending:
+            return MSOCK_POLL_WRITE;
+        case HttpRequestState_Receiving:
+            return MSOCK_POLL_READ;
+        default:
+            return 0;
+    }
+}
+
+// The socket is left open until Http_FreeRequest(), see Http_RequestUpdate()
+static b32 Http_RequestFail(HttpRequest* request) {
+    request->state = HttpRequestState_Failed;
+    return TRUE;
+}
+
+b32 Http_RequestUpdate(HttpRequest* request, u32 readyEvents) {
+    if (request->state == HttpRequestState_Done || request->state == HttpRequestState_Failed) {
+        return TRUE;
+    }
+
+    if (request->state == HttpRequestState_Connecting) {
+        if (!(readyEvents & (MSOCK_POLL_WRITE | MSOCK_POLL_HANGUP))) {
+            return MGetTimeMilliseconds() > request->deadline ? Http_RequestFail(request) : FALSE;
+        }
+        if (MSockGetSocketError(request->sock) != 0) {
+            return Http_RequestFail(request);
+        }
+        request->state = HttpRequestState_Sending;
+    }
+
+    if (request->state == HttpRequestState_Sending) {
+        while (request->requestSent < request->request.size) {
+            int sent = MSockSend(request->sock, request->request.mem + request->requestSent,
+                                 (int)(request->request.size - request->requestSent));
+            if (sent <= 0) {
+                if (sent < 0 && MSockGetLastError().timeout) {
+                    break;
+                }
+                return Http_RequestFail(request);
+            }
+            request->requestSent += sent;
+        }
+        if (request->requestSent == request->request.size) {
+            request->state = HttpRequestState_Receiving;
+        }
+    }
+
+    if (request->state == HttpRequestState_Receiving) {
+        MMemIO* memIo = &request->response.response;
+        for (;;) {
+            if (memIo->capacity - memIo->size < 1024) {
+                MMemGrowBytes(memIo, 1024 * 4);
+            }
+            int received = MSockRecv(request->sock, memIo->mem + memIo->size, (int)(memIo->capacity - memIo->size));
+            if (received > 0) {
+                memIo->size += received;
+                continue;
+            }
+            if (received < 0) {
+                if (MSockGetLastError().timeout) {
+                    break;
+                }
+                return Http_RequestFail(request);
+            }
+
+            // Server closed the connection, the response is complete
+            if (memIo->size == 0 || !Http_ParseResponseHeaders(&request->response)) {
+                return Http_RequestFail(request);
+            }
+            request->state = HttpRequestState_Done;
+            return TRUE;
+        }
+    }
+
+    if (MGetTimeMilliseconds() > request->deadline) {
+        return Http_RequestFail(request);
+    }
+    return FALSE;
+}
+
+void Http_FreeRequest(HttpRequest* request) {
+    MSockClose(request->sock);
+    MMemFree(&request->request);
+    MMemFree(&request->response.response);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mlib/mlib.h"
+#include "mlib/msock.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +42,38 @@ void Http_FreeUrl(MAllocator* allocator, HttpUrl* url);
 b32 Http_Get(MAllocator* allocator, MStrView url, HttpResponse* outResponse);
 void Http_FreeResponse(MAllocator* allocator, HttpResponse* response);
 
+typedef enum HttpRequestState {
+    HttpRequestState_Connecting,
+    HttpRequestState_Sending,
+    HttpRequestState_Receiving,
+    HttpRequestState_Done,
+    HttpRequestState_Failed,
+} HttpRequestState;
+
+// Non-blocking GET request, driven by socket readiness so many requests can be in flight from one thread
+typedef struct {
+    MSock sock;
+    HttpRequestState state;
+    MMemIO request;
+    u32 requestSent;
+    u64 deadline; // Request fails if not done by this time (MGetTimeMilliseconds())
+    HttpResponse response; // Valid once state is HttpRequestState_Done
+    MAllocator* allocator;
+} HttpRequest;
+
+// Start connecting, returns FALSE if the request could not be started
+b32 Http_GetStart(MAllocator* allocator, MStrView url, u32 timeoutMilliseconds, HttpRequest* outRequest);
+
+// MSockPollFlags to wait for on request->sock before calling Http_RequestUpdate()
+u32 Http_RequestWaitEvents(HttpRequest* request);
+
+// Make progress with the MSockPollFlags that are ready (0 to only check the deadline).
+// Returns TRUE once the request is finished, check request->state for the outcome.  The socket stays open until
+// Http_FreeRequest(), so it can be removed from a poller before it's closed.
+b32 Http_RequestUpdate(HttpRequest* request, u32 readyEvents);
+
+void Http_FreeRequest(HttpRequest* request);
+
 #ifdef __cplusplus
 }
 #endif
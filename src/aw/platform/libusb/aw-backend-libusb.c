@@ -2,12 +2,40 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef AW_ENABLE_UDEV
+#include <libudev.h>
+#endif
 
 #include "mlib/mlib.h"
 #include "aw/aw-control.h"
 #include "aw/platform/usb-const.h"
 #include "aw/platform/libusb/aw-backend-libusb.h"
 
+// Event ring indices shared between the event thread and the reader, and transaction cancellation state
+#define ATOMIC_LOAD_U32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_U32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_ADD_U32(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_CAS_U32(p, expected, v) \
+    ({ u32 expected_ = (expected); \
+       __atomic_compare_exchange_n((p), &expected_, (v), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE); })
+
+// Cancel state holds the transaction id + 1 it's for, a cancel racing the end of its transaction never hits the next
+#define LIBUSB_CANCEL_TOKEN(transactionId) ((transactionId) + 1)
+
+// Time to wait for a device to finish cancelling a transaction, and to drain what's left of its data phase
+#define LIBUSB_CANCEL_STATUS_POLL_MILLISECONDS 10
+#define LIBUSB_CANCEL_DRAIN_TIMEOUT_MILLISECONDS 100
+
+// Interval between attempts to read the strings of an attached device that couldn't be opened yet
+#define LIBUSB_PENDING_RETRY_MILLISECONDS 1000
+
+// Backoff between restarts of an event transfer that stopped on an error, in milliseconds
+#define LIBUSB_EVENT_RETRY_MIN_DELAY 100
+#define LIBUSB_EVENT_RETRY_MAX_DELAY 5000
+
 static b32 CheckDeviceHasPtpEndPoints(AwLibusbDeviceList* self, libusb_device* device, AwUsbEndPoints* outEndPoints) {
     struct libusb_config_descriptor* config;
     int r = libusb_get_active_config_descriptor(device, &config);
@@ -58,6 +86,388 @@ static b32 CheckDeviceHasPtpEndPoints(AwLibusbDeviceList* self, libusb_device* d
     return hasPTP;
 }
 
+// Open the device to read its string descriptors, buffers must be 256 bytes
+static b32 ReadDeviceStrings(AwLibusbDeviceList* self, libusb_device* dev, struct libusb_device_descriptor* desc,
+                             char* product, char* manufacturer, char* serial) {
+    libusb_device_handle* handle = NULL;
+    int r = libusb_open(dev, &handle);
+    if (r < 0) {
+        AW_WARNING("Failed to open Sony device for string retrieval");
+        return FALSE;
+    }
+
+    if (desc->iProduct > 0) {
+        libusb_get_string_descriptor_ascii(handle, desc->iProduct, (unsigned char*)product, 256);
+    }
+    if (desc->iManufacturer > 0) {
+        libusb_get_string_descriptor_ascii(handle, desc->iManufacturer, (unsigned char*)manufacturer, 256);
+    }
+    if (desc->iSerialNumber > 0) {
+        libusb_get_string_descriptor_ascii(handle, desc->iSerialNumber, (unsigned char*)serial, 256);
+    }
+
+    libusb_close(handle);
+    return TRUE;
+}
+
+static void AddDeviceInfo(AwLibusbDeviceList* self, AwDeviceInfo** devices, libusb_device* dev, u16 vid, u16 pid,
+                          u16 usbVersion, MStrView product, MStrView manufacturer, MStrView serial) {
+    LibusbDeviceInfo* libusbDeviceInfo = MArrayAddPtr(self->allocator, self->devices);
+    libusbDeviceInfo->device = libusb_ref_device(dev);
+
+    AwDeviceInfo* deviceInfo = MArrayAddPtrZ(self->allocator, *devices);
+    deviceInfo->manufacturer = MStrMakeCopyLen(self->allocator, manufacturer.str, manufacturer.size);
+    deviceInfo->product = MStrMakeCopyLen(self->allocator, product.str, product.size);
+    deviceInfo->serial = MStrMakeCopyLen(self->allocator, serial.str, serial.size);
+    deviceInfo->usbVID = vid;
+    deviceInfo->usbPID = pid;
+    deviceInfo->usbVersion = usbVersion;
+    deviceInfo->backendType = AW_BACKEND_LIBUSB;
+    deviceInfo->device = libusbDeviceInfo;
+
+    AW_INFO_F("Found device: %.*s (%.*s)", deviceInfo->product.size, deviceInfo->product.str,
+        deviceInfo->manufacturer.size, deviceInfo->manufacturer.str);
+}
+
+static void FreeKnownDevice(AwLibusbDeviceList* self, LibusbKnownDevice* known) {
+    libusb_unref_device(known->device);
+    MStrFree(self->allocator, known->manufacturer);
+    MStrFree(self->allocator, known->product);
+    MStrFree(self->allocator, known->serial);
+}
+
+// Called by libusb from whichever thread is handling events, so only queue the change.  Opening the device to read
+// strings happens later in ProcessHotplugEvents().
+static int LIBUSB_CALL HotplugCallback(libusb_context* ctx, libusb_device* device, libusb_hotplug_event event,
+                                       void* userData) {
+    AwLibusbDeviceList* self = userData;
+    pthread_mutex_lock(&self->hotplugLock);
+    LibusbHotplugEvent* e = MArrayAddPtr(self->allocator, self->hotplugEvents);
+    e->device = libusb_ref_device(device);
+    e->arrived = (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+    pthread_mutex_unlock(&self->hotplugLock);
+    return 0; // Stay registered
+}
+
+// Returns FALSE if the device's strings couldn't be read, e.g. it's still starting up, and it should be retried
+static b32 HotplugDeviceArrived(AwLibusbDeviceList* self, libusb_device* dev) {
+    MArrayEachPtr(self->knownDevices, it) {
+        if (it.p->device == dev) {
+            return TRUE;
+        }
+    }
+
+    struct libusb_device_descriptor desc;
+    if (libusb_get_device_descriptor(dev, &desc) < 0) {
+        return TRUE;
+    }
+    AwUsbEndPoints endPoints;
+    if (!CheckDeviceHasPtpEndPoints(self, dev, &endPoints)) {
+        return TRUE;
+    }
+
+    char product[256] = {0};
+    char manufacturer[256] = {0};
+    char serial[256] = {0};
+    if (!ReadDeviceStrings(self, dev, &desc, product, manufacturer, serial)) {
+        return FALSE;
+    }
+
+    LibusbKnownDevice* known = MArrayAddPtrZ(self->allocator, self->knownDevices);
+    known->device = libusb_ref_device(dev);
+    known->usbVID = desc.idVendor;
+    known->usbPID = desc.idProduct;
+    known->usbVersion = desc.bcdUSB;
+    known->product = MStrMakeCopyCStr(self->allocator, product);
+    known->manufacturer = MStrMakeCopyCStr(self->allocator, manufacturer);
+    known->serial = MStrMakeCopyCStr(self->allocator, serial);
+    self->needsRefresh = TRUE;
+    AW_INFO_F("Device attached: %s (%s)", product, manufacturer);
+    return TRUE;
+}
+
+static void AddPendingDevice(AwLibusbDeviceList* self, libusb_device* dev) {
+    MArrayEachPtr(self->pendingDevices, it) {
+        if (*it.p == dev) {
+            return;
+        }
+    }
+    MArrayAdd(self->allocator, self->pendingDevices, libusb_ref_device(dev));
+}
+
+static void RemovePendingDevice(AwLibusbDeviceList* self, libusb_device* dev) {
+    MArrayEachPtr(self->pendingDevices, it) {
+        if (*it.p == dev) {
+            libusb_unref_device(dev);
+            MArrayRemoveIndex(self->pendingDevices, it.i);
+            return;
+        }
+    }
+}
+
+// Retry arrivals whose strings couldn't be read, at most every LIBUSB_PENDING_RETRY_MILLISECONDS
+static void RetryPendingDevices(AwLibusbDeviceList* self) {
+    u64 now = MGetTimeMilliseconds();
+    if (!MArraySize(self->pendingDevices) || now < self->pendingRetryTime) {
+        return;
+    }
+    self->pendingRetryTime = now + LIBUSB_PENDING_RETRY_MILLISECONDS;
+    for (int i = 0; i < MArraySize(self->pendingDevices);) {
+        libusb_device* dev = self->pendingDevices[i];
+        if (HotplugDeviceArrived(self, dev)) {
+            libusb_unref_device(dev);
+            MArrayRemoveIndex(self->pendingDevices, i);
+        } else {
+            i++;
+        }
+    }
+}
+
+static void HotplugDeviceLeft(AwLibusbDeviceList* self, libusb_device* dev) {
+    RemovePendingDevice(self, dev);
+    MArrayEachPtr(self->knownDevices, it) {
+        if (it.p->device == dev) {
+            AW_INFO_F("Device detached: %.*s", it.p->product.size, it.p->product.str);
+            FreeKnownDevice(self, it.p);
+            MArrayRemoveIndex(self->knownDevices, it.i);
+            self->needsRefresh = TRUE;
+            break;
+        }
+    }
+    MArrayEachPtr(self->openDevices, it) {
+        if ((*it.p)->device == dev) {
+            (*it.p)->disconnected = TRUE;
+        }
+    }
+}
+
+static void ProcessHotplugEvents(AwLibusbDeviceList* self) {
+    // Hotplug callbacks are delivered while handling events, don't wait if there are none
+    struct timeval zero = {0, 0};
+    libusb_handle_events_timeout_completed((libusb_context*)self->context, &zero, NULL);
+
+    pthread_mutex_lock(&self->hotplugLock);
+    LibusbHotplugEvent* events = self->hotplugEvents;
+    self->hotplugEvents = NULL;
+    pthread_mutex_unlock(&self->hotplugLock);
+
+    MArrayEachPtr(events, it) {
+        if (it.p->arrived) {
+            if (!HotplugDeviceArrived(self, it.p->device)) {
+                AddPendingDevice(self, it.p->device);
+                self->pendingRetryTime = MGetTimeMilliseconds() + LIBUSB_PENDING_RETRY_MILLISECONDS;
+            }
+        } else {
+            HotplugDeviceLeft(self, it.p->device);
+        }
+        libusb_unref_device(it.p->device);
+    }
+    MArrayFree(self->allocator, events);
+
+    RetryPendingDevices(self);
+}
+
+static void OpenHotplug(AwLibusbDeviceList* self) {
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        AW_DEBUG("libusb hotplug not supported");
+        return;
+    }
+
+    pthread_mutex_init(&self->hotplugLock, NULL);
+    libusb_hotplug_callback_handle handle = 0;
+    // Enumerate queues an arrival for every device already attached
+    int r = libusb_hotplug_register_callback((libusb_context*)self->context,
+        LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT, LIBUSB_HOTPLUG_ENUMERATE,
+        USB_SONY_VID, LIBUSB_HOTPLUG_MATCH_ANY, LIBUSB_HOTPLUG_MATCH_ANY, HotplugCallback, self, &handle);
+    if (r != LIBUSB_SUCCESS) {
+        AW_WARNING_F("libusb_hotplug_register_callback failed: %s", libusb_error_name(r));
+        pthread_mutex_destroy(&self->hotplugLock);
+        return;
+    }
+    self->hotplugHandle = handle;
+    self->hotplugEnabled = TRUE;
+}
+
+static void CloseHotplug(AwLibusbDeviceList* self) {
+    if (!self->hotplugEnabled) {
+        return;
+    }
+    libusb_hotplug_deregister_callback((libusb_context*)self->context, self->hotplugHandle);
+    self->hotplugEnabled = FALSE;
+
+    MArrayEachPtr(self->hotplugEvents, it) {
+        libusb_unref_device(it.p->device);
+    }
+    MArrayFree(self->allocator, self->hotplugEvents);
+    MArrayEachPtr(self->pendingDevices, it) {
+        libusb_unref_device(*it.p);
+    }
+    MArrayFree(self->allocator, self->pendingDevices);
+    MArrayEachPtr(self->knownDevices, it) {
+        FreeKnownDevice(self, it.p);
+    }
+    MArrayFree(self->allocator, self->knownDevices);
+    pthread_mutex_destroy(&self->hotplugLock);
+}
+
+#ifdef AW_ENABLE_UDEV
+static void OpenUdevMonitor(AwLibusbDeviceList* self) {
+    struct udev* udev = udev_new();
+    if (!udev) {
+        return;
+    }
+    struct udev_monitor* monitor = udev_monitor_new_from_netlink(udev, "udev");
+    if (!monitor ||
+            udev_monitor_filter_add_match_subsystem_devtype(monitor, "usb", "usb_device") < 0 ||
+            udev_monitor_enable_receiving(monitor) < 0) {
+        AW_WARNING("Failed to create udev monitor, USB devices are only found by refreshing");
+        if (monitor) {
+            udev_monitor_unref(monitor);
+        }
+        udev_unref(udev);
+        return;
+    }
+    self->udev = udev;
+    self->udevMonitor = monitor;
+}
+
+static void PollUdevMonitor(AwLibusbDeviceList* self) {
+    struct udev_device* device;
+    // The monitor socket is non-blocking, returns NULL once drained
+    while ((device = udev_monitor_receive_device(self->udevMonitor)) != NULL) {
+        // PRODUCT is "vid/pid/bcdDevice" in hex, set for both add and remove
+        const char* product = udev_device_get_property_value(device, "PRODUCT");
+        if (product && strtol(product, NULL, 16) == USB_SONY_VID) {
+            self->needsRefresh = TRUE;
+        }
+        udev_device_unref(device);
+    }
+}
+
+static void CloseUdevMonitor(AwLibusbDeviceList* self) {
+    if (self->udevMonitor) {
+        udev_monitor_unref(self->udevMonitor);
+        self->udevMonitor = NULL;
+    }
+    if (self->udev) {
+        udev_unref(self->udev);
+        self->udev = NULL;
+    }
+}
+#endif
+
+static void FreeCachedDevice(AwLibusbDeviceList* self, LibusbCachedDevice* cached) {
+    MStrFree(self->allocator, cached->manufacturer);
+    MStrFree(self->allocator, cached->product);
+    MStrFree(self->allocator, cached->serial);
+}
+
+static void FreeDeviceCache(AwLibusbDeviceList* self) {
+    MArrayEachPtr(self->deviceCache, it) {
+        FreeCachedDevice(self, it.p);
+    }
+    MArrayFree(self->allocator, self->deviceCache);
+}
+
+// Port path of the device, 0 length if libusb can't read it (e.g. too deep for the buffer)
+static u8 GetPortPath(libusb_device* dev, u8* portPath, int portPathSize) {
+    int portPathLen = libusb_get_port_numbers(dev, portPath, portPathSize);
+    return portPathLen < 0 ? 0 : (u8)portPathLen;
+}
+
+static LibusbCachedDevice* FindCachedDevice(AwLibusbDeviceList* self, libusb_device* dev,
+                                            struct libusb_device_descriptor* desc) {
+    u8 portPath[8];
+    u8 portPathLen = GetPortPath(dev, portPath, sizeof(portPath));
+    u8 busNumber = libusb_get_bus_number(dev);
+    u8 deviceAddress = libusb_get_device_address(dev);
+
+    MArrayEachPtr(self->deviceCache, it) {
+        LibusbCachedDevice* cached = it.p;
+        if (cached->busNumber == busNumber &&
+                cached->deviceAddress == deviceAddress &&
+                cached->portPathLen == portPathLen &&
+                memcmp(cached->portPath, portPath, portPathLen) == 0 &&
+                cached->usbVID == desc->idVendor &&
+                cached->usbPID == desc->idProduct) {
+            return cached;
+        }
+    }
+    return NULL;
+}
+
+// Check the endpoints and read the strings of a device not seen before, returns NULL if it couldn't be read and
+// should be retried next refresh
+static LibusbCachedDevice* CacheDevice(AwLibusbDeviceList* self, libusb_device* dev,
+                                       struct libusb_device_descriptor* desc) {
+    u8 portPath[8];
+    u8 portPathLen = GetPortPath(dev, portPath, sizeof(portPath));
+
+    AwUsbEndPoints endPoints = {0};
+    b32 hasPtp = CheckDeviceHasPtpEndPoints(self, dev, &endPoints);
+    char product[256] = {0};
+    char manufacturer[256] = {0};
+    char serial[256] = {0};
+    if (hasPtp && !ReadDeviceStrings(self, dev, desc, product, manufacturer, serial)) {
+        return NULL;
+    }
+
+    LibusbCachedDevice* cached = MArrayAddPtrZ(self->allocator, self->deviceCache);
+    cached->busNumber = libusb_get_bus_number(dev);
+    cached->deviceAddress = libusb_get_device_address(dev);
+    cached->portPathLen = portPathLen;
+    memcpy(cached->portPath, portPath, portPathLen);
+    cached->usbVID = desc->idVendor;
+    cached->usbPID = desc->idProduct;
+    cached->usbVersion = desc->bcdUSB;
+    cached->hasPtp = hasPtp;
+    cached->seen = TRUE;
+    cached->endPoints = endPoints;
+    if (hasPtp) {
+        cached->product = MStrMakeCopyCStr(self->allocator, product);
+        cached->manufacturer = MStrMakeCopyCStr(self->allocator, manufacturer);
+        cached->serial = MStrMakeCopyCStr(self->allocator, serial);
+    }
+    return cached;
+}
+
+// Handles events for every open device, so transfers complete without anyone waiting on them
+static void* EventThreadProc(void* lpParameter) {
+    AwLibusbDeviceList* self = lpParameter;
+    while (!ATOMIC_LOAD_U32((u32*)&self->eventThreadStop)) {
+        int r = libusb_handle_events_completed((libusb_context*)self->context, &self->eventThreadStop);
+        if (r != 0 && r != LIBUSB_ERROR_INTERRUPTED) {
+            AW_WARNING_F("libusb_handle_events failed: %s", libusb_error_name(r));
+        }
+    }
+    return NULL;
+}
+
+static b32 StartEventThread(AwLibusbDeviceList* self) {
+    if (self->eventThreadStarted) {
+        return TRUE;
+    }
+    self->eventThreadStop = 0;
+    int r = pthread_create(&self->eventThread, NULL, EventThreadProc, self);
+    if (r != 0) {
+        AW_WARNING_F("Failed to create event thread: %d", r);
+        return FALSE;
+    }
+    self->eventThreadStarted = TRUE;
+    AW_DEBUG("Started event thread");
+    return TRUE;
+}
+
+static void StopEventThread(AwLibusbDeviceList* self) {
+    if (!self->eventThreadStarted) {
+        return;
+    }
+    ATOMIC_STORE_U32((u32*)&self->eventThreadStop, 1);
+    libusb_interrupt_event_handler((libusb_context*)self->context);
+    pthread_join(self->eventThread, NULL);
+    self->eventThreadStarted = FALSE;
+}
+
 AwResult AwLibusbDeviceList_Open(AwLibusbDeviceList* self) {
     AW_TRACE("AwLibusbDeviceList_Open");
     int r = libusb_init((libusb_context**)&self->context);
@@ -65,15 +475,33 @@ AwResult AwLibusbDeviceList_Open(AwLibusbDeviceList* self) {
         AW_ERROR("libusb_init failed");
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
+    OpenHotplug(self);
+#ifdef AW_ENABLE_UDEV
+    if (!self->hotplugEnabled) {
+        OpenUdevMonitor(self);
+    }
+#endif
     return (AwResult){.code=AW_RESULT_OK};
 }
 
+static void StopEventTransfer(AwDeviceLibusb* dev);
+
 AwResult AwLibusbDeviceList_Close(AwLibusbDeviceList* self) {
     AW_TRACE("AwLibusbDeviceList_Close");
     AwLibusbDeviceList_ReleaseList(self);
+    // Cancel event transfers of devices left open while the event thread can still complete them
+    MArrayEachPtr(self->openDevices, it) {
+        StopEventTransfer(*it.p);
+    }
+    StopEventThread(self);
     if (self->openDevices) {
         MArrayFree(self->allocator, self->openDevices);
     }
+    CloseHotplug(self);
+#ifdef AW_ENABLE_UDEV
+    CloseUdevMonitor(self);
+#endif
+    FreeDeviceCache(self);
     if (self->context) {
         libusb_exit((libusb_context*)self->context);
         self->context = NULL;
@@ -82,17 +510,43 @@ AwResult AwLibusbDeviceList_Close(AwLibusbDeviceList* self) {
 }
 
 b32 AwLibusbDeviceList_NeedsRefresh(AwLibusbDeviceList* self) {
-    return FALSE;
+    if (self->hotplugEnabled) {
+        ProcessHotplugEvents(self);
+    }
+#ifdef AW_ENABLE_UDEV
+    else if (self->udevMonitor) {
+        PollUdevMonitor(self);
+    }
+#endif
+    // Pending devices are retried on refresh, keep asking for one until they show up or leave
+    return self->needsRefresh || MArraySize(self->pendingDevices) > 0;
 }
 
 AwResult AwLibusbDeviceList_RefreshList(AwLibusbDeviceList* self, AwDeviceInfo** devices) {
     AW_TRACE("AwLibusbDeviceList_RefreshList");
+    self->needsRefresh = FALSE;
+
+    if (self->hotplugEnabled) {
+        // Attached devices are already known, no need to scan the bus or open anything
+        ProcessHotplugEvents(self);
+        self->needsRefresh = FALSE;
+        MArrayEachPtr(self->knownDevices, it) {
+            AddDeviceInfo(self, devices, it.p->device, it.p->usbVID, it.p->usbPID, it.p->usbVersion,
+                MStrViewFromStr(it.p->product), MStrViewFromStr(it.p->manufacturer), MStrViewFromStr(it.p->serial));
+        }
+        return (AwResult){.code=AW_RESULT_OK};
+    }
+
     libusb_device** list;
     ssize_t count = libusb_get_device_list((libusb_context*)self->context, &list);
     if (count < 0) {
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
 
+    MArrayEachPtr(self->deviceCache, it) {
+        it.p->seen = FALSE;
+    }
+
     for (ssize_t i = 0; i < count; i++) {
         libusb_device* dev = list[i];
         struct libusb_device_descriptor desc;
@@ -105,46 +559,28 @@ AwResult AwLibusbDeviceList_RefreshList(AwLibusbDeviceList* self, AwDeviceInfo**
             continue;
         }
 
-        AwUsbEndPoints endPoints;
-        if (CheckDeviceHasPtpEndPoints(self, dev, &endPoints)) {
-            libusb_device_handle* handle = NULL;
-            r = libusb_open(dev, &handle);
-            if (r < 0) {
-                AW_WARNING("Failed to open Sony device for string retrieval");
+        LibusbCachedDevice* cached = FindCachedDevice(self, dev, &desc);
+        if (cached) {
+            cached->seen = TRUE;
+        } else {
+            cached = CacheDevice(self, dev, &desc);
+            if (!cached) {
                 continue;
             }
+        }
 
-            char product[256] = {0};
-            char manufacturer[256] = {0};
-            char serial[256] = {0};
-
-            if (desc.iProduct > 0) {
-                libusb_get_string_descriptor_ascii(handle, desc.iProduct, (unsigned char*)product, sizeof(product));
-            }
-            if (desc.iManufacturer > 0) {
-                libusb_get_string_descriptor_ascii(handle, desc.iManufacturer, (unsigned char*)manufacturer, sizeof(manufacturer));
-            }
-            if (desc.iSerialNumber > 0) {
-                libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, (unsigned char*)serial, sizeof(serial));
-            }
-
-            libusb_close(handle);
-
-            LibusbDeviceInfo* libusbDeviceInfo = MArrayAddPtr(self->allocator, self->devices);
-            libusbDeviceInfo->device = libusb_ref_device(dev);
-
-            AwDeviceInfo* deviceInfo = MArrayAddPtrZ(self->allocator, *devices);
-            deviceInfo->manufacturer = MStrMakeCopyCStr(self->allocator, manufacturer);
-            deviceInfo->product = MStrMakeCopyCStr(self->allocator, product);
-            deviceInfo->serial = MStrMakeCopyCStr(self->allocator, serial);
-            deviceInfo->usbVID = desc.idVendor;
-            deviceInfo->usbPID = desc.idProduct;
-            deviceInfo->usbVersion = desc.bcdUSB;
-            deviceInfo->backendType = AW_BACKEND_LIBUSB;
-            deviceInfo->device = libusbDeviceInfo;
+        if (cached->hasPtp) {
+            AddDeviceInfo(self, devices, dev, cached->usbVID, cached->usbPID, cached->usbVersion,
+                MStrViewFromStr(cached->product), MStrViewFromStr(cached->manufacturer),
+                MStrViewFromStr(cached->serial));
+        }
+    }
 
-            AW_INFO_F("Found device: %.*s (%.*s)", deviceInfo->product.size, deviceInfo->product.str,
-                deviceInfo->manufacturer.size, deviceInfo->manufacturer.str);
+    // Drop devices that have been unplugged
+    for (int i = (int)MArraySize(self->deviceCache) - 1; i >= 0; i--) {
+        if (!self->deviceCache[i].seen) {
+            FreeCachedDevice(self, self->deviceCache + i);
+            MArrayRemoveIndex(self->deviceCache, i);
         }
     }
 
@@ -171,7 +607,7 @@ static void* AwDeviceLibusb_ReallocBuffer(AwDevice* self, AwBufferType type, voi
         u8* mem = ((u8*)dataMem)-headerSize;
         MFree(self->transport.allocator, mem, dataOldSize + headerSize);
     }
-    u8* data = MMallocZ(self->transport.allocator, dataSize);
+    u8* data = MMalloc(self->transport.allocator, dataSize);
     return data + headerSize;
 }
 
@@ -211,12 +647,180 @@ static int BulkTransferOut(AwDeviceLibusb* device, u8* data, size_t transferLen,
     return 0;
 }
 
-static AwResult AwDeviceLibusb_SendAndRecv(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
-                                           AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize,
-                                           size_t* actualDataOutSize) {
-    AwDeviceLibusb* deviceLibusb = self->device;
-    libusb_device_handle* handle = deviceLibusb->handle;
+typedef struct {
+    struct libusb_transfer* transfer;
+    int done;
+} AwLibusbAsyncSlot;
+
+static void LIBUSB_CALL AsyncTransferCallback(struct libusb_transfer* transfer) {
+    AwLibusbAsyncSlot* slot = transfer->user_data;
+    slot->done = 1;
+}
+
+static int AsyncTransferStatusToError(enum libusb_transfer_status status) {
+    switch (status) {
+        case LIBUSB_TRANSFER_COMPLETED: return 0;
+        case LIBUSB_TRANSFER_TIMED_OUT: return LIBUSB_ERROR_TIMEOUT;
+        case LIBUSB_TRANSFER_STALL: return LIBUSB_ERROR_PIPE;
+        case LIBUSB_TRANSFER_NO_DEVICE: return LIBUSB_ERROR_NO_DEVICE;
+        case LIBUSB_TRANSFER_OVERFLOW: return LIBUSB_ERROR_OVERFLOW;
+        case LIBUSB_TRANSFER_CANCELLED: return LIBUSB_ERROR_INTERRUPTED;
+        default: return LIBUSB_ERROR_IO;
+    }
+}
+
+static b32 CancelRequested(AwDeviceLibusb* device) {
+    return ATOMIC_LOAD_U32(&device->cancelRequested) == LIBUSB_CANCEL_TOKEN(ATOMIC_LOAD_U32(&device->transactionId));
+}
+
+// Returns FALSE if 'stopOnCancel' is set and the transaction was cancelled before the slot completed
+static b32 AsyncWaitForSlot(AwDeviceLibusb* device, AwLibusbAsyncSlot* slot, b32 stopOnCancel) {
+    while (!slot->done) {
+        if (stopOnCancel && CancelRequested(device)) {
+            return FALSE;
+        }
+        struct timeval tv = {1, 0};
+        int r = libusb_handle_events_timeout_completed(device->context, &tv, &slot->done);
+        if (r != 0 && r != LIBUSB_ERROR_INTERRUPTED && r != LIBUSB_ERROR_TIMEOUT) {
+            AW_LOG_WARNING_F(&device->logger, "libusb_handle_events failed: %s", libusb_error_name(r));
+        }
+    }
+    return TRUE;
+}
+
+// Transfers must be a multiple of the max packet size, a short packet marks the end of the data phase
+static size_t AsyncTransferSize(AwDeviceLibusb* device, AwDataSink* sink) {
+    size_t packetSize = device->usb.bulkInMaxPacketSize ? device->usb.bulkInMaxPacketSize : USB_BULK_MAX_PACKET_SIZE;
+    size_t size = sink ? AwDataSink_GetChunkSize(sink) : device->asyncTransferSize;
+    return MSizeAlign(size, packetSize);
+}
 
+// Read the bulk in data phase into 'data' keeping up to asyncTransferCount transfers queued, so the bus is never idle
+// between chunks.  Each transfer reads directly into its slice of 'data', transfers complete in submission order on
+// the endpoint so *outTransferred is always the contiguous number of bytes received.
+// When streaming to a sink 'data' is a ring of asyncTransferCount chunks instead, each completed chunk is passed to
+// the sink while the following transfers are still in flight, then its slot is reused.
+// If the pipeline can't be set up (or a submit fails part way through) *outCanFallback is set, in-flight transfers
+// are drained and the caller can continue with synchronous transfers from *outTransferred.
+static int BulkTransferInAsync(AwDeviceLibusb* device, u8* data, size_t transferLen, AwDataSink* sink,
+                               size_t* outTransferred, b32* outCanFallback) {
+    *outTransferred = 0;
+    *outCanFallback = FALSE;
+
+    size_t transferSize = AsyncTransferSize(device, sink);
+    u32 slotCount = (u32)((transferLen + transferSize - 1) / transferSize);
+    if (slotCount > device->asyncTransferCount) {
+        slotCount = device->asyncTransferCount;
+    }
+
+    u32 slotsAllocated = slotCount;
+    AwLibusbAsyncSlot* slots = MMallocZ(device->allocator, slotsAllocated * sizeof(AwLibusbAsyncSlot));
+    if (!slots) {
+        *outCanFallback = TRUE;
+        return LIBUSB_ERROR_NO_MEM;
+    }
+    for (u32 i = 0; i < slotCount; i++) {
+        slots[i].transfer = libusb_alloc_transfer(0);
+        if (!slots[i].transfer) {
+            slotCount = i;
+            break;
+        }
+    }
+
+    int result = 0;
+    if (slotCount == 0) {
+        *outCanFallback = TRUE;
+        result = LIBUSB_ERROR_NO_MEM;
+    }
+
+    size_t submitted = 0;
+    size_t received = 0;
+    u32 head = 0;
+    u32 inFlight = 0;
+    b32 stopSubmitting = (result != 0);
+    b32 failed = FALSE;
+
+    while (TRUE) {
+        while (!stopSubmitting && inFlight < slotCount && submitted < transferLen) {
+            u32 slotIndex = (head + inFlight) % slotCount;
+            AwLibusbAsyncSlot* slot = slots + slotIndex;
+            size_t chunkSize = transferLen - submitted;
+            chunkSize = chunkSize > transferSize ? transferSize : chunkSize;
+            u8* chunk = sink ? data + (slotIndex * transferSize) : data + submitted;
+            slot->done = 0;
+            libusb_fill_bulk_transfer(slot->transfer, device->handle, device->usb.bulkIn, chunk,
+                (int)chunkSize, AsyncTransferCallback, slot, device->timeoutMilliseconds);
+            int r = libusb_submit_transfer(slot->transfer);
+            if (r != 0) {
+                AW_LOG_WARNING_F(&device->logger, "libusb_submit_transfer failed: %s", libusb_error_name(r));
+                *outCanFallback = TRUE;
+                result = r;
+                stopSubmitting = TRUE;
+                break;
+            }
+            submitted += chunkSize;
+            inFlight++;
+        }
+
+        if (inFlight == 0) {
+            break;
+        }
+
+        AwLibusbAsyncSlot* slot = slots + head;
+        if (!AsyncWaitForSlot(device, slot, !failed)) {
+            // Cancelled, stop the pipeline and drain the transfers still in flight
+            failed = TRUE;
+            stopSubmitting = TRUE;
+            result = LIBUSB_ERROR_INTERRUPTED;
+            *outCanFallback = FALSE;
+            for (u32 i = 0; i < inFlight; i++) {
+                libusb_cancel_transfer(slots[(head + i) % slotCount].transfer);
+            }
+            continue;
+        }
+        head = (head + 1) % slotCount;
+        inFlight--;
+
+        if (failed) {
+            // Draining cancelled transfers
+            continue;
+        }
+
+        struct libusb_transfer* transfer = slot->transfer;
+        int r = AsyncTransferStatusToError(transfer->status);
+        if (r == 0) {
+            received += transfer->actual_length;
+            if (sink) {
+                AwDataSink_Write(sink, transfer->buffer, transfer->actual_length);
+            }
+            if (transfer->actual_length < transfer->length) {
+                // Short packet, the data phase ended early - anything queued after this isn't part of it
+                AW_LOG_WARNING_F(&device->logger, "Data phase ended early: got %d of %d bytes",
+                    (int)received, (int)transferLen);
+                r = LIBUSB_ERROR_IO;
+            }
+        }
+        if (r != 0) {
+            failed = TRUE;
+            stopSubmitting = TRUE;
+            result = r;
+            *outCanFallback = FALSE;
+            for (u32 i = 0; i < inFlight; i++) {
+                libusb_cancel_transfer(slots[(head + i) % slotCount].transfer);
+            }
+        }
+    }
+
+    for (u32 i = 0; i < slotCount; i++) {
+        libusb_free_transfer(slots[i].transfer);
+    }
+    MFree(device->allocator, slots, slotsAllocated * sizeof(AwLibusbAsyncSlot));
+
+    *outTransferred = received;
+    return result;
+}
+
+static AwResult SendRequest(AwDeviceLibusb* deviceLibusb, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize) {
     size_t requestSize = sizeof(PTPContainerHeader) + (request->NumParams * sizeof(u32));
     PTPContainerHeader* requestData = alloca(requestSize);
     requestData->length = (u32)requestSize;
@@ -231,7 +835,7 @@ static AwResult AwDeviceLibusb_SendAndRecv(AwDevice* self, AwPtpRequestHeader* r
     int transferred = 0;
     int r = BulkTransferOut(deviceLibusb, (u8*)requestData, requestSize, &transferred);
     if (r != 0) {
-        AW_ERROR_F("Failed to send PTP request: %s", libusb_error_name(r));
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to send PTP request: %s", libusb_error_name(r));
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
 
@@ -246,16 +850,248 @@ static AwResult AwDeviceLibusb_SendAndRecv(AwDevice* self, AwPtpRequestHeader* r
         transferred = 0;
         r = BulkTransferOut(deviceLibusb, (u8*)dataHeader, fullDataSize, &transferred);
         if (r != 0) {
-            AW_ERROR_F("Failed to send PTP request: %s", libusb_error_name(r));
+            AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to send PTP request: %s", libusb_error_name(r));
             return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
         }
     }
+    return (AwResult){.code=AW_RESULT_OK};
+}
+
+// Read the remaining 'transferLen' bytes of a data phase into 'data', using the async pipeline for large reads.
+// If 'sink' is set the data is streamed to it, with 'data' being a ring of asyncTransferCount chunks for staging.
+static int BulkTransferIn(AwDeviceLibusb* deviceLibusb, u8* data, size_t transferLen, AwDataSink* sink,
+                          size_t* outTransferred) {
+    size_t actual = 0;
+    size_t maxChunkSize = sink ? AsyncTransferSize(deviceLibusb, sink) : (1 << 15);
+    int r;
+    if (deviceLibusb->asyncTransferCount > 1 && transferLen > AsyncTransferSize(deviceLibusb, sink)) {
+        b32 canFallback = FALSE;
+        r = BulkTransferInAsync(deviceLibusb, data, transferLen, sink, &actual, &canFallback);
+        if (r != 0) {
+            if (!canFallback) {
+                *outTransferred = actual;
+                return r;
+            }
+            AW_LOG_WARNING_F(&deviceLibusb->logger, "Async transfers unavailable (%s), using synchronous transfers",
+                libusb_error_name(r));
+        }
+    }
+
+    while (actual < transferLen) {
+        if (CancelRequested(deviceLibusb)) {
+            *outTransferred = actual;
+            return LIBUSB_ERROR_INTERRUPTED;
+        }
+        int chunk = 0;
+        int chunkSize = (int)(transferLen - actual);
+        chunkSize = chunkSize > maxChunkSize ? (int)maxChunkSize : chunkSize;
+        u8* dst = sink ? data : data + actual;
+        r = libusb_bulk_transfer(deviceLibusb->handle, deviceLibusb->usb.bulkIn, dst, chunkSize,
+            &chunk, deviceLibusb->timeoutMilliseconds);
+        if (r != 0) {
+            *outTransferred = actual;
+            return r;
+        }
+        if (sink) {
+            AwDataSink_Write(sink, dst, chunk);
+        }
+        actual += chunk;
+    }
+
+    *outTransferred = actual;
+    return 0;
+}
+
+static b32 DiscardWrite(void* userData, const u8* data, size_t size) {
+    return TRUE;
+}
+
+// Read and drop the remaining 'length' bytes of a data phase, streamed through the async pipeline so a payload that
+// doesn't fit the caller's buffer takes about as long as receiving it would
+static int DrainDataPhase(AwDeviceLibusb* deviceLibusb, size_t length, size_t* outTransferred) {
+    AwDataSink discard = {.write = DiscardWrite};
+    size_t transferSize = AsyncTransferSize(deviceLibusb, &discard);
+    size_t ringSize = (deviceLibusb->asyncTransferCount > 1 ? deviceLibusb->asyncTransferCount : 1) * transferSize;
+    u8* ring = MMalloc(deviceLibusb->allocator, ringSize);
+    if (!ring) {
+        *outTransferred = 0;
+        return LIBUSB_ERROR_NO_MEM;
+    }
+    int r = BulkTransferIn(deviceLibusb, ring, length, &discard, outTransferred);
+    MFree(deviceLibusb->allocator, ring, ringSize);
+    return r;
+}
+
+// Read the response container that follows a data phase into 'responseContainer'
+static AwResult ReadFinalResponse(AwDeviceLibusb* deviceLibusb, PTPContainerHeader* responseContainer) {
+    libusb_device_handle* handle = deviceLibusb->handle;
+    int finalResponseSize = (int)(sizeof(PTPContainerHeader) + (PTP_MAX_PARAMS * sizeof(u32)));
+    int transferred = 0;
+    int r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
+        finalResponseSize, &transferred, deviceLibusb->timeoutMilliseconds);
+    if (r != 0) {
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to read final PTP response: %s", libusb_error_name(r));
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+
+    if (transferred == 0) {
+        r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
+            finalResponseSize, &transferred, deviceLibusb->timeoutMilliseconds);
+        if (r != 0) {
+            AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to read final PTP response: %s", libusb_error_name(r));
+            return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+        }
+    }
+
+    if (transferred < (int)sizeof(PTPContainerHeader)) {
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Incomplete PTP response received: got: %d expected >= %d",
+            transferred, (int)sizeof(PTPContainerHeader));
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+
+    // TODO: verify PTP_CONTAINER_ is correct here
+    return (AwResult){.code=AW_RESULT_OK};
+}
+
+static AwResult ParseResponse(PTPContainerHeader* responseContainer, AwPtpResponseHeader* response) {
+    response->ResponseCode = responseContainer->code;
+    response->TransactionId = responseContainer->transactionId;
+    int paramsSize = (int)responseContainer->length - (int)sizeof(PTPContainerHeader);
+    response->NumParams = paramsSize / (int)sizeof(u32);
+    u32* resParams = (u32*)(responseContainer + 1);
+    for (int i = 0; i < response->NumParams && i < PTP_MAX_PARAMS; i++) {
+        response->Params[i] = resParams[i];
+    }
+
+    if (response->ResponseCode == PTP_OK) {
+        return (AwResult){.code=AW_RESULT_OK,.ptp=PTP_OK};
+    } else {
+        return (AwResult){.code=AW_RESULT_PTP_FAILURE,.ptp=(PtpResult)response->ResponseCode};
+    }
+}
+
+static void BeginTransaction(AwDeviceLibusb* deviceLibusb, u32 transactionId) {
+    ATOMIC_STORE_U32(&deviceLibusb->cancelClaimed, 0);
+    ATOMIC_STORE_U32(&deviceLibusb->cancelRequested, 0);
+    ATOMIC_STORE_U32(&deviceLibusb->transactionId, transactionId);
+    ATOMIC_STORE_U32(&deviceLibusb->inTransaction, 1);
+}
+
+// After a Cancel Request the device stops the data phase, skips the response and reports busy until it's done,
+// stalled endpoints are listed in its status and have to be cleared by the host.
+static void RecoverFromCancel(AwDeviceLibusb* deviceLibusb) {
+    libusb_device_handle* handle = deviceLibusb->handle;
+    u64 deadline = MGetTimeMilliseconds() + deviceLibusb->timeoutMilliseconds;
+    while (TRUE) {
+        u8 status[USB_STILL_IMAGE_STATUS_MAX_SIZE];
+        int n = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_CLASS |
+            LIBUSB_RECIPIENT_INTERFACE, USB_STILL_IMAGE_GET_DEVICE_STATUS, 0, 0, status, sizeof(status),
+            deviceLibusb->timeoutMilliseconds);
+        if (n < 4) {
+            AW_LOG_WARNING_F(&deviceLibusb->logger, "Get device status failed after cancel: %s",
+                n < 0 ? libusb_error_name(n) : "short status");
+            break;
+        }
+        u16 code = (u16)(status[2] | (status[3] << 8));
+        for (int i = 4; i + 4 <= n; i += 4) {
+            libusb_clear_halt(handle, status[i]);
+        }
+        if (code == PTP_OK) {
+            break;
+        }
+        if (MGetTimeMilliseconds() >= deadline) {
+            AW_LOG_WARNING_F(&deviceLibusb->logger, "Device still busy after cancel: 0x%04x", code);
+            break;
+        }
+        struct timespec ts = {0, LIBUSB_CANCEL_STATUS_POLL_MILLISECONDS * 1000000L};
+        nanosleep(&ts, NULL);
+    }
+
+    // Drop anything of the cancelled data phase that was already queued on the endpoint, in transfers as large as the
+    // data phase used so a big backlog is cleared in a few round trips
+    int drainSize = (int)AsyncTransferSize(deviceLibusb, NULL);
+    u8* drain = MMalloc(deviceLibusb->allocator, drainSize);
+    if (!drain) {
+        return;
+    }
+    int transferred = 0;
+    while (libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, drain, drainSize, &transferred,
+                                LIBUSB_CANCEL_DRAIN_TIMEOUT_MILLISECONDS) == 0 && transferred > 0) {
+    }
+    MFree(deviceLibusb->allocator, drain, drainSize);
+}
+
+// A failed transaction is reported as cancelled once the device has recovered, if it completed anyway its result stands
+static AwResult EndTransaction(AwDeviceLibusb* deviceLibusb, AwResult result) {
+    ATOMIC_STORE_U32(&deviceLibusb->inTransaction, 0);
+    if (CancelRequested(deviceLibusb)) {
+        RecoverFromCancel(deviceLibusb);
+        if (result.code != AW_RESULT_OK) {
+            AW_LOG_DEBUG_F(&deviceLibusb->logger, "Transaction %u cancelled", deviceLibusb->transactionId);
+            result = (AwResult){.code=AW_RESULT_CANCELLED};
+        }
+    }
+    return result;
+}
+
+static AwResult AwDeviceLibusb_Cancel(AwDevice* self) {
+    AwDeviceLibusb* deviceLibusb = self->device;
+    u32 transactionId = ATOMIC_LOAD_U32(&deviceLibusb->transactionId);
+    u32 token = LIBUSB_CANCEL_TOKEN(transactionId);
+    if (!ATOMIC_LOAD_U32(&deviceLibusb->inTransaction)) {
+        return (AwResult){.code=AW_RESULT_OK};
+    }
+
+    // Claim the cancel for this transaction, only the first caller sends the Cancel Request
+    while (TRUE) {
+        u32 claimed = ATOMIC_LOAD_U32(&deviceLibusb->cancelClaimed);
+        if (claimed == token) {
+            return (AwResult){.code=AW_RESULT_OK};
+        }
+        if (ATOMIC_CAS_U32(&deviceLibusb->cancelClaimed, claimed, token)) {
+            break;
+        }
+    }
+    // The transaction may have ended while claiming, never cancel the one after it
+    if (!ATOMIC_LOAD_U32(&deviceLibusb->inTransaction) ||
+            ATOMIC_LOAD_U32(&deviceLibusb->transactionId) != transactionId) {
+        return (AwResult){.code=AW_RESULT_OK};
+    }
+
+    u8 data[6] = {
+        USB_STILL_IMAGE_CANCEL_CODE & 0xff, USB_STILL_IMAGE_CANCEL_CODE >> 8,
+        transactionId & 0xff, (transactionId >> 8) & 0xff, (transactionId >> 16) & 0xff, transactionId >> 24
+    };
+    int r = libusb_control_transfer(deviceLibusb->handle, LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_CLASS |
+        LIBUSB_RECIPIENT_INTERFACE, USB_STILL_IMAGE_CANCEL_REQUEST, 0, 0, data, sizeof(data),
+        deviceLibusb->timeoutMilliseconds);
+    if (r < 0) {
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Cancel request failed: %s", libusb_error_name(r));
+        // Let a later call try again
+        ATOMIC_CAS_U32(&deviceLibusb->cancelClaimed, token, 0);
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+    // Stop the transferring thread between chunks, and wake it if it's waiting on the async pipeline
+    ATOMIC_STORE_U32(&deviceLibusb->cancelRequested, token);
+    libusb_interrupt_event_handler(deviceLibusb->context);
+    return (AwResult){.code=AW_RESULT_OK};
+}
+
+static AwResult SendAndRecv(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                            AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize, size_t* actualDataOutSize) {
+    AwDeviceLibusb* deviceLibusb = self->device;
+    libusb_device_handle* handle = deviceLibusb->handle;
+
+    AwResult result = SendRequest(deviceLibusb, request, dataIn, dataInSize);
+    if (result.code != AW_RESULT_OK) {
+        return result;
+    }
 
     PTPContainerHeader* responseContainer = (PTPContainerHeader*)(dataOut - sizeof(PTPContainerHeader));
-    transferred = 0;
+    int transferred = 0;
     int chunkSize = (int)(sizeof(PTPContainerHeader) + dataOutSize);
     chunkSize = chunkSize > (1 << 15) ? (1 << 15) : chunkSize;
-    r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
+    int r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
         chunkSize, &transferred, deviceLibusb->timeoutMilliseconds);
     if (r != 0) {
         AW_ERROR_F("Failed to read PTP response: %s", libusb_error_name(r));
@@ -270,66 +1106,180 @@ static AwResult AwDeviceLibusb_SendAndRecv(AwDevice* self, AwPtpRequestHeader* r
     u32 dataBytesTransferred = 0;
     if (responseContainer->type == PTP_CONTAINER_DATA) {
         u32 payloadLength = responseContainer->length;
-        int actual = transferred;
-        unsigned char* cp = ((unsigned char*)responseContainer) + actual;
-
-        while ((u32)actual < payloadLength) {
-            int chunk = 0;
-            chunkSize = (int)(payloadLength - actual);
-            chunkSize = chunkSize > (1 << 15) ? (1 << 15) : chunkSize;
-            r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, cp, chunkSize,
-                &chunk, deviceLibusb->timeoutMilliseconds);
+        size_t actual = transferred;
+        if (actual < payloadLength) {
+            size_t chunk = 0;
+            r = BulkTransferIn(deviceLibusb, ((u8*)responseContainer) + actual, payloadLength - actual, NULL, &chunk);
+            actual += chunk;
             if (r != 0) {
                 AW_ERROR_F("Failed to read PTP response data: %s", libusb_error_name(r));
                 return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
             }
-            actual += chunk;
+        }
+        dataBytesTransferred = (actual > sizeof(PTPContainerHeader)) ? (u32)(actual - sizeof(PTPContainerHeader)) : 0;
 
-            cp += chunk;
+        responseContainer = alloca(sizeof(PTPContainerHeader) + (PTP_MAX_PARAMS * sizeof(u32)));
+        result = ReadFinalResponse(deviceLibusb, responseContainer);
+        if (result.code != AW_RESULT_OK) {
+            return result;
         }
-        dataBytesTransferred = (actual > (int)sizeof(PTPContainerHeader)) ? (u32)(actual - sizeof(PTPContainerHeader)) : 0;
+    }
 
-        size_t finalResponseSize = sizeof(PTPContainerHeader) + (PTP_MAX_PARAMS * sizeof(u32));
-        responseContainer = alloca(finalResponseSize);
-        r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
-            (int)finalResponseSize, &transferred, deviceLibusb->timeoutMilliseconds);
+    *actualDataOutSize = dataBytesTransferred;
+    return ParseResponse(responseContainer, response);
+}
+
+static AwResult AwDeviceLibusb_SendAndRecv(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                                           AwPtpResponseHeader* response, u8* dataOut, size_t dataOutSize,
+                                           size_t* actualDataOutSize) {
+    AwDeviceLibusb* deviceLibusb = self->device;
+    BeginTransaction(deviceLibusb, request->TransactionId);
+    AwResult result = SendAndRecv(self, request, dataIn, dataInSize, response, dataOut, dataOutSize,
+                                  actualDataOutSize);
+    return EndTransaction(deviceLibusb, result);
+}
+
+// Size of the first read of a sink data phase, a multiple of both the high & super speed bulk packet sizes
+#define LIBUSB_SINK_FIRST_READ_SIZE 1024
+
+// Stream a data phase to sink->write(), the first read goes into the first chunk of the staging ring, for a data
+// container it holds the header and the start of the payload.
+static AwResult RecvStream(AwDeviceLibusb* deviceLibusb, AwDataSink* sink, PTPContainerHeader* responseOut) {
+    libusb_device_handle* handle = deviceLibusb->handle;
+    size_t transferSize = AsyncTransferSize(deviceLibusb, sink);
+    size_t ringSize = (deviceLibusb->asyncTransferCount > 1 ? deviceLibusb->asyncTransferCount : 1) * transferSize;
+    u8* ring = MMalloc(deviceLibusb->allocator, ringSize);
+    AwResult result = {.code=AW_RESULT_OK};
+
+    int transferred = 0;
+    int r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, ring, (int)transferSize, &transferred,
+        deviceLibusb->timeoutMilliseconds);
+    if (r != 0) {
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to read PTP response: %s", libusb_error_name(r));
+        result.code = AW_RESULT_TRANSPORT_ERROR;
+        goto exit;
+    }
+
+    if (transferred < sizeof(PTPContainerHeader)) {
+        AW_LOG_ERROR_F(&deviceLibusb->logger, "Incomplete PTP response received: got: %d expected >= %d",
+            transferred, (int)sizeof(PTPContainerHeader));
+        result.code = AW_RESULT_TRANSPORT_ERROR;
+        goto exit;
+    }
+
+    PTPContainerHeader* container = (PTPContainerHeader*)ring;
+    if (container->type != PTP_CONTAINER_DATA) {
+        size_t responseSize = sizeof(PTPContainerHeader) + (PTP_MAX_PARAMS * sizeof(u32));
+        memcpy(responseOut, ring, transferred < responseSize ? transferred : responseSize);
+        goto exit;
+    }
+
+    size_t payloadLength = container->length - sizeof(PTPContainerHeader);
+    size_t received = transferred - sizeof(PTPContainerHeader);
+    AwDataSink_Write(sink, ring + sizeof(PTPContainerHeader), received);
+    if (received < payloadLength) {
+        size_t chunk = 0;
+        r = BulkTransferIn(deviceLibusb, ring, payloadLength - received, sink, &chunk);
         if (r != 0) {
-            AW_ERROR_F("Failed to read final PTP response: %s", libusb_error_name(r));
-            return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+            AW_LOG_ERROR_F(&deviceLibusb->logger, "Failed to read PTP response data: %s", libusb_error_name(r));
+            result.code = AW_RESULT_TRANSPORT_ERROR;
+            goto exit;
         }
+    }
 
-        if (transferred == 0) {
-            r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, (unsigned char*)responseContainer,
-                (int)finalResponseSize, &transferred, deviceLibusb->timeoutMilliseconds);
+    result = ReadFinalResponse(deviceLibusb, responseOut);
+
+exit:
+    MFree(deviceLibusb->allocator, ring, ringSize);
+    return result;
+}
+
+static AwResult SendAndRecvSink(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn, size_t dataInSize,
+                                AwPtpResponseHeader* response, AwDataSink* sink) {
+    AwDeviceLibusb* deviceLibusb = self->device;
+    libusb_device_handle* handle = deviceLibusb->handle;
+    sink->size = 0;
+    sink->aborted = FALSE;
+    sink->required = 0;
+
+    AwResult result = SendRequest(deviceLibusb, request, dataIn, dataInSize);
+    if (result.code != AW_RESULT_OK) {
+        return result;
+    }
+
+    if (sink->write) {
+        PTPContainerHeader* responseContainer = alloca(sizeof(PTPContainerHeader) + (PTP_MAX_PARAMS * sizeof(u32)));
+        result = RecvStream(deviceLibusb, sink, responseContainer);
+        if (result.code != AW_RESULT_OK) {
+            return result;
+        }
+        return ParseResponse(responseContainer, response);
+    }
+
+    // The sink memory has no room for the container header, read the first packets into a small buffer and copy
+    // their payload over, everything after that is received straight into the sink.
+    u8 firstRead[LIBUSB_SINK_FIRST_READ_SIZE];
+    PTPContainerHeader* responseContainer = (PTPContainerHeader*)firstRead;
+    int transferred = 0;
+    int r = libusb_bulk_transfer(handle, deviceLibusb->usb.bulkIn, firstRead, sizeof(firstRead), &transferred,
+        deviceLibusb->timeoutMilliseconds);
+    if (r != 0) {
+        AW_ERROR_F("Failed to read PTP response: %s", libusb_error_name(r));
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+
+    if (transferred < sizeof(PTPContainerHeader)) {
+        AW_ERROR_F("Incomplete PTP response received: got: %d expected >= %d", transferred, (int)sizeof(PTPContainerHeader));
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+
+    if (responseContainer->type == PTP_CONTAINER_DATA) {
+        size_t payloadLength = responseContainer->length - sizeof(PTPContainerHeader);
+        size_t received = transferred - sizeof(PTPContainerHeader);
+        if (payloadLength > sink->capacity) {
+            // Drain the data phase so the session stays in sync, but report the error
+            AW_DEBUG_F("Response data size: %llu but sink only: %llu", (u64)payloadLength, (u64)sink->capacity);
+            sink->required = payloadLength;
+            if (received < payloadLength) {
+                size_t drained = 0;
+                r = DrainDataPhase(deviceLibusb, payloadLength - received, &drained);
+                if (r != 0) {
+                    AW_ERROR_F("Failed to read PTP response data: %s", libusb_error_name(r));
+                    return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+                }
+            }
+            ReadFinalResponse(deviceLibusb, responseContainer);
+            return (AwResult){.code=AW_RESULT_BUFFER_TOO_SMALL};
+        }
+
+        memcpy(sink->mem, firstRead + sizeof(PTPContainerHeader), received);
+        if (received < payloadLength) {
+            size_t chunk = 0;
+            r = BulkTransferIn(deviceLibusb, sink->mem + received, payloadLength - received, NULL, &chunk);
+            received += chunk;
             if (r != 0) {
-                AW_ERROR_F("Failed to read final PTP response: %s", libusb_error_name(r));
+                sink->size = received;
+                AW_ERROR_F("Failed to read PTP response data: %s", libusb_error_name(r));
                 return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
             }
         }
+        sink->size = received;
 
-        if (transferred < (int)sizeof(PTPContainerHeader)) {
-            AW_ERROR_F("Incomplete PTP response received: got: %d expected >= %d", transferred, (int)sizeof(PTPContainerHeader));
-            return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+        result = ReadFinalResponse(deviceLibusb, responseContainer);
+        if (result.code != AW_RESULT_OK) {
+            return result;
         }
-
-        // TODO: verify PTP_CONTAINER_ is correct here
     }
 
-    *actualDataOutSize = dataBytesTransferred;
-    response->ResponseCode = responseContainer->code;
-    response->TransactionId = responseContainer->transactionId;
-    int paramsSize = (int)responseContainer->length - (int)sizeof(PTPContainerHeader);
-    response->NumParams = paramsSize / (int)sizeof(u32);
-    u32* resParams = (u32*)(responseContainer + 1);
-    for (int i = 0; i < response->NumParams && i < PTP_MAX_PARAMS; i++) {
-        response->Params[i] = resParams[i];
-    }
+    return ParseResponse(responseContainer, response);
+}
 
-    if (response->ResponseCode == PTP_OK) {
-        return (AwResult){.code=AW_RESULT_OK,.ptp=PTP_OK};
-    } else {
-        return (AwResult){.code=AW_RESULT_PTP_FAILURE,.ptp=(PtpResult)response->ResponseCode};
-    }
+static AwResult AwDeviceLibusb_SendAndRecvSink(AwDevice* self, AwPtpRequestHeader* request, u8* dataIn,
+                                               size_t dataInSize, AwPtpResponseHeader* response, AwDataSink* sink) {
+    AwDeviceLibusb* deviceLibusb = self->device;
+    BeginTransaction(deviceLibusb, request->TransactionId);
+    AwResult result = SendAndRecvSink(self, request, dataIn, dataInSize, response, sink);
+    return EndTransaction(deviceLibusb, result);
 }
 
 static b32 AwDeviceLibusb_Reset(AwDevice* self) {
@@ -375,46 +1325,191 @@ static b32 ReadEventFromBuffer(AwDeviceLibusb* dev, int transferred, AwPtpEvent*
     return FALSE;
 }
 
-// Background thread function for processing events
-static void* EventThreadProc(void* lpParameter) {
-    AwDeviceLibusb* dev = (AwDeviceLibusb*)lpParameter;
+static b32 EventRingPush(LibusbEventRing* ring, AwPtpEvent* event) {
+    u32 head = ring->head;
+    if (head - ATOMIC_LOAD_U32(&ring->tail) >= LIBUSB_EVENT_RING_CAPACITY) {
+        ATOMIC_ADD_U32(&ring->overflowCount, 1);
+        return FALSE;
+    }
+    ring->events[head & (LIBUSB_EVENT_RING_CAPACITY - 1)] = *event;
+    ATOMIC_STORE_U32(&ring->head, head + 1);
+    return TRUE;
+}
 
-    while (!dev->eventThreadStop) {
-        int transferred = 0;
+static b32 EventRingIsEmpty(LibusbEventRing* ring) {
+    return ATOMIC_LOAD_U32(&ring->head) == ring->tail;
+}
 
-        // Allocate event buffer if not already done
-        if (!dev->eventMem.allocator) {
-            MMemInitAlloc(&dev->eventMem, dev->allocator, 1024);
-        } else {
-            dev->eventMem.size = 0;
-        }
+static void EventRingPopAll(LibusbEventRing* ring, MAllocator* alloc, AwPtpEvent** outEvents) {
+    u32 tail = ring->tail;
+    u32 head = ATOMIC_LOAD_U32(&ring->head);
+    for (; tail != head; tail++) {
+        AwPtpEvent* event = MArrayAddPtr(alloc, *outEvents);
+        *event = ring->events[tail & (LIBUSB_EVENT_RING_CAPACITY - 1)];
+    }
+    ATOMIC_STORE_U32(&ring->tail, tail);
+}
 
-        // Perform interrupt transfer with a reasonable timeout
-        int r = libusb_interrupt_transfer(dev->handle, dev->usb.interruptIn,
-            dev->eventMem.mem, dev->eventMem.capacity, &transferred, 1000);
+// Runs on the backend event thread
+static void LIBUSB_CALL EventTransferCallback(struct libusb_transfer* transfer) {
+    AwDeviceLibusb* dev = transfer->user_data;
 
-        if (dev->eventThreadStop) {
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED && transfer->actual_length > 0) {
+        AwPtpEvent event = {};
+        if (ReadEventFromBuffer(dev, transfer->actual_length, &event)) {
+            event.timestampMicroseconds = MGetTimeMicroseconds();
+            EventRingPush(&dev->eventRing, &event);
+        }
+    }
+
+    pthread_mutex_lock(&dev->eventLock);
+    b32 resubmit = !dev->eventStop;
+    switch (transfer->status) {
+        case LIBUSB_TRANSFER_COMPLETED:
+            dev->eventRetryDelay = 0;
+            break;
+        case LIBUSB_TRANSFER_TIMED_OUT:
+        case LIBUSB_TRANSFER_OVERFLOW:
+            break;
+        case LIBUSB_TRANSFER_CANCELLED:
+            resubmit = FALSE;
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            dev->disconnected = TRUE;
+            resubmit = FALSE;
+            break;
+        default:
+            // Resubmitting right away would spin on the event thread for persistent errors, ReadEvents() restarts
+            // the transfer with a backoff instead
+            AW_LOG_WARNING_F(&dev->logger, "Interrupt transfer failed: %s",
+                libusb_error_name(AsyncTransferStatusToError(transfer->status)));
+            resubmit = FALSE;
             break;
+    }
+    if (resubmit) {
+        int r = libusb_submit_transfer(transfer);
+        if (r != 0) {
+            AW_LOG_WARNING_F(&dev->logger, "Failed to resubmit interrupt transfer: %s", libusb_error_name(r));
+            resubmit = FALSE;
         }
+    }
+    if (!resubmit) {
+        dev->eventTransferActive = FALSE;
+    }
+    pthread_cond_broadcast(&dev->eventCond);
+    pthread_mutex_unlock(&dev->eventLock);
+}
+
+static b32 StartEventTransfer(AwLibusbDeviceList* self, AwDeviceLibusb* dev) {
+    if (!dev->usb.interruptIn || !StartEventThread(self)) {
+        return FALSE;
+    }
+
+    struct libusb_transfer* transfer = libusb_alloc_transfer(0);
+    if (!transfer) {
+        return FALSE;
+    }
+    MMemInitAlloc(&dev->eventMem, dev->allocator, 1024);
+    pthread_mutex_init(&dev->eventLock, NULL);
+    pthread_cond_init(&dev->eventCond, NULL);
+
+    // No timeout, the transfer is resubmitted as each event arrives and cancelled on close
+    libusb_fill_interrupt_transfer(transfer, dev->handle, dev->usb.interruptIn, dev->eventMem.mem,
+        (int)dev->eventMem.capacity, EventTransferCallback, dev, 0);
+    dev->eventTransfer = transfer;
+    dev->eventTransferActive = TRUE;
+    int r = libusb_submit_transfer(transfer);
+    if (r != 0) {
+        AW_WARNING_F("Failed to submit interrupt transfer: %s", libusb_error_name(r));
+        libusb_free_transfer(transfer);
+        dev->eventTransfer = NULL;
+        dev->eventTransferActive = FALSE;
+        pthread_cond_destroy(&dev->eventCond);
+        pthread_mutex_destroy(&dev->eventLock);
+        return FALSE;
+    }
+    dev->eventsAsync = TRUE;
+    return TRUE;
+}
+
+static void StopEventTransfer(AwDeviceLibusb* dev) {
+    if (!dev->eventsAsync) {
+        return;
+    }
+    pthread_mutex_lock(&dev->eventLock);
+    dev->eventStop = TRUE;
+    if (dev->eventTransferActive) {
+        libusb_cancel_transfer(dev->eventTransfer);
+    }
+    // The event thread delivers the cancellation promptly, no need to wait out a transfer timeout
+    while (dev->eventTransferActive) {
+        pthread_cond_wait(&dev->eventCond, &dev->eventLock);
+    }
+    pthread_mutex_unlock(&dev->eventLock);
+
+    libusb_free_transfer(dev->eventTransfer);
+    dev->eventTransfer = NULL;
+    pthread_cond_destroy(&dev->eventCond);
+    pthread_mutex_destroy(&dev->eventLock);
+    dev->eventsAsync = FALSE;
+}
 
-        if (r == 0 && transferred > 0) {
-            AwPtpEvent tempEvent = {};
-            if (ReadEventFromBuffer(dev, transferred, &tempEvent)) {
-                pthread_mutex_lock(&dev->eventLock);
-                AwPtpEvent* event = MArrayAddPtr(dev->allocator, dev->eventList);
-                *event = tempEvent;
-                pthread_mutex_unlock(&dev->eventLock);
+// Restart an event transfer that stopped on an error (e.g. a stall), at most once per backoff period so a persistent
+// error doesn't flood the device with requests
+static AwResult RestartEventTransfer(AwDeviceLibusb* dev) {
+    if (dev->disconnected) {
+        return (AwResult){.code=AW_RESULT_CONNECTION_CLOSED};
+    }
+    u64 now = MGetTimeMilliseconds();
+    if (now < dev->eventRetryTime) {
+        return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
+    }
+
+    // Transfer isn't active so the event thread doesn't touch it, the halt is cleared before taking the lock
+    int r = libusb_clear_halt(dev->handle, dev->usb.interruptIn);
+    if (r != 0 && r != LIBUSB_ERROR_NOT_FOUND) {
+        AW_LOG_WARNING_F(&dev->logger, "Failed to clear interrupt endpoint halt: %s", libusb_error_name(r));
+    }
+
+    pthread_mutex_lock(&dev->eventLock);
+    // Each restart that isn't followed by an event doubles the wait before the next one
+    dev->eventRetryDelay = dev->eventRetryDelay ? dev->eventRetryDelay * 2 : LIBUSB_EVENT_RETRY_MIN_DELAY;
+    if (dev->eventRetryDelay > LIBUSB_EVENT_RETRY_MAX_DELAY) {
+        dev->eventRetryDelay = LIBUSB_EVENT_RETRY_MAX_DELAY;
+    }
+    dev->eventRetryTime = now + dev->eventRetryDelay;
+    if (!dev->eventTransferActive && !dev->eventStop) {
+        r = libusb_submit_transfer(dev->eventTransfer);
+        if (r == 0) {
+            dev->eventTransferActive = TRUE;
+        } else {
+            AW_LOG_WARNING_F(&dev->logger, "Failed to restart interrupt transfer: %s", libusb_error_name(r));
+            if (r == LIBUSB_ERROR_NO_DEVICE) {
+                dev->disconnected = TRUE;
             }
-        } else if (r != LIBUSB_ERROR_TIMEOUT) {
-            // Log error but continue running
-            AW_LOG_WARNING_F(&dev->logger, "Interrupt transfer failed: %s", libusb_error_name(r));
-            // Sleep briefly to avoid busy-looping on persistent errors
-            struct timespec ts = {0, 100000000}; // 100ms
-            nanosleep(&ts, NULL);
         }
     }
+    b32 active = dev->eventTransferActive;
+    pthread_mutex_unlock(&dev->eventLock);
+    return (AwResult){.code=active ? AW_RESULT_OK : AW_RESULT_TRANSPORT_ERROR};
+}
 
-    return NULL;
+static void WaitForEvents(AwDeviceLibusb* dev, int timeoutMilliseconds) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMilliseconds / 1000;
+    deadline.tv_nsec += (long)(timeoutMilliseconds % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_mutex_lock(&dev->eventLock);
+    while (EventRingIsEmpty(&dev->eventRing) && dev->eventTransferActive) {
+        if (pthread_cond_timedwait(&dev->eventCond, &dev->eventLock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&dev->eventLock);
 }
 
 static AwResult AwDeviceLibusb_ReadEvents(AwDevice* self, int timeoutMilliseconds, MAllocator* alloc,
@@ -425,22 +1520,28 @@ static AwResult AwDeviceLibusb_ReadEvents(AwDevice* self, int timeoutMillisecond
         return (AwResult){.code=AW_RESULT_UNSUPPORTED};
     }
 
-    // If event thread is running, return stored events
-    if (dev->eventThreadStarted) {
+    // Events are queued by the event thread, block until one arrives or the timeout passes
+    if (dev->eventsAsync) {
+        AwResult result = {.code=AW_RESULT_OK};
         pthread_mutex_lock(&dev->eventLock);
-
-        // Copy all events to output
-        if (dev->eventList && MArraySize(dev->eventList) > 0) {
-            for (int i = 0; i < MArraySize(dev->eventList); i++) {
-                AwPtpEvent* event = MArrayAddPtr(alloc, *outEvents);
-                *event = dev->eventList[i];
-            }
-            // Clear the stored events
-            MArrayClear(dev->eventList);
+        b32 active = dev->eventTransferActive;
+        pthread_mutex_unlock(&dev->eventLock);
+        if (!active) {
+            // Transfer stopped on an error, events queued before it did are still returned
+            result = RestartEventTransfer(dev);
+        }
+        if (result.code == AW_RESULT_OK && timeoutMilliseconds > 0 && EventRingIsEmpty(&dev->eventRing)) {
+            WaitForEvents(dev, timeoutMilliseconds);
         }
+        EventRingPopAll(&dev->eventRing, alloc, outEvents);
 
-        pthread_mutex_unlock(&dev->eventLock);
-        return (AwResult){.code=AW_RESULT_OK};
+        u32 overflowCount = ATOMIC_LOAD_U32(&dev->eventRing.overflowCount);
+        if (overflowCount != dev->eventOverflowReported) {
+            AW_LOG_WARNING_F(&dev->logger, "Dropped %u events, ReadEvents() not called often enough",
+                overflowCount - dev->eventOverflowReported);
+            dev->eventOverflowReported = overflowCount;
+        }
+        return result;
     }
 
     // Non-threaded mode - this may miss some events if ReadEvents is not called frequently enough
@@ -488,29 +1589,41 @@ AwResult AwLibusbDeviceList_OpenDevice(AwLibusbDeviceList* self, AwDeviceInfo* d
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
 
-    AwUsbEndPoints endPoints;
-    if (!CheckDeviceHasPtpEndPoints(self, dev, &endPoints)) {
+    // Endpoints found while enumerating are reused, the cache key (bus, address, port path, VID/PID) changes on replug
+    AwUsbEndPoints endPoints = {0};
+    struct libusb_device_descriptor desc;
+    LibusbCachedDevice* cached = NULL;
+    if (libusb_get_device_descriptor(dev, &desc) == 0) {
+        cached = FindCachedDevice(self, dev, &desc);
+    }
+    if (cached && cached->hasPtp) {
+        endPoints = cached->endPoints;
+    } else if (!CheckDeviceHasPtpEndPoints(self, dev, &endPoints)) {
         AW_ERROR("Failed to find PTP interfaces");
         libusb_close(handle);
         return (AwResult){.code=AW_RESULT_TRANSPORT_ERROR};
     }
 
-    AwDeviceLibusb* deviceLibusb = MArrayAddPtrZ(self->allocator, self->openDevices);
+    AwDeviceLibusb* deviceLibusb = MMallocZ(self->allocator, sizeof(AwDeviceLibusb));
+    MArrayAdd(self->allocator, self->openDevices, deviceLibusb);
     deviceLibusb->device = libusb_ref_device(dev);
     deviceLibusb->handle = handle;
     deviceLibusb->usb = endPoints;
     deviceLibusb->disconnected = FALSE;
+    deviceLibusb->context = self->context;
     deviceLibusb->timeoutMilliseconds = self->timeoutMilliseconds;
+    deviceLibusb->asyncTransferCount = self->asyncTransferCount;
+    deviceLibusb->asyncTransferSize = self->asyncTransferSize;
     deviceLibusb->allocator = self->allocator;
     deviceLibusb->logger = self->logger;
     deviceLibusb->usbInterruptInterval = 0;
-    deviceLibusb->eventThreadStop = FALSE;
-    deviceLibusb->eventList = NULL;
 
     (*deviceOut)->transport.reallocBuffer = AwDeviceLibusb_ReallocBuffer;
     (*deviceOut)->transport.freeBuffer = AwDeviceLibusb_FreeBuffer;
     (*deviceOut)->transport.sendAndRecv = AwDeviceLibusb_SendAndRecv;
+    (*deviceOut)->transport.sendAndRecvSink = AwDeviceLibusb_SendAndRecvSink;
     (*deviceOut)->transport.reset = AwDeviceLibusb_Reset;
+    (*deviceOut)->transport.cancel = AwDeviceLibusb_Cancel;
     (*deviceOut)->transport.readEvents = AwDeviceLibusb_ReadEvents;
     (*deviceOut)->transport.requiresSessionOpenClose = TRUE;
     (*deviceOut)->transport.allocator = self->allocator;
@@ -520,23 +1633,9 @@ AwResult AwLibusbDeviceList_OpenDevice(AwLibusbDeviceList* self, AwDeviceInfo* d
     (*deviceOut)->disconnected = FALSE;
     (*deviceOut)->deviceInfo = deviceInfo;
 
-    // Start event thread if allowed
+    // Read events asynchronously on the backend event thread if allowed, otherwise ReadEvents() polls the endpoint
     if (!self->backend->config.disallowSpawnEventThread) {
-        pthread_mutex_init(&deviceLibusb->eventLock, NULL);
-
-        pthread_mutex_lock(&deviceLibusb->eventLock);
-        MArrayInit(deviceLibusb->allocator, deviceLibusb->eventList, 16);
-        pthread_mutex_unlock(&deviceLibusb->eventLock);
-
-        int r = pthread_create(&deviceLibusb->eventThread, NULL, EventThreadProc, deviceLibusb);
-        if (r != 0) {
-            AW_WARNING_F("Failed to create event thread: %d", r);
-            deviceLibusb->eventThreadStop = -1;
-            pthread_mutex_destroy(&deviceLibusb->eventLock);
-        } else {
-            deviceLibusb->eventThreadStarted = -1;
-            AW_DEBUG("Started event thread");
-        }
+        StartEventTransfer(self, deviceLibusb);
     }
 
     return (AwResult){.code=AW_RESULT_OK};
@@ -546,23 +1645,7 @@ AwResult AwLibusbDeviceList_CloseDevice(AwLibusbDeviceList* self, AwDevice* devi
     AW_TRACE("AwLibusbDeviceList_CloseDevice");
     AwDeviceLibusb* deviceLibusb = device->device;
 
-    // Stop event thread if running
-    if (deviceLibusb->eventThreadStarted) {
-        // Signal thread to stop
-        deviceLibusb->eventThreadStop = -1;
-
-        // Wait for thread to exit
-        pthread_join(deviceLibusb->eventThread, NULL);
-
-        // Clean up event list
-        if (deviceLibusb->eventList) {
-            MArrayFree(deviceLibusb->allocator, deviceLibusb->eventList);
-            deviceLibusb->eventList = NULL;
-        }
-
-        pthread_mutex_destroy(&deviceLibusb->eventLock);
-    }
-
+    StopEventTransfer(deviceLibusb);
     MMemFree(&deviceLibusb->eventMem);
 
     if (deviceLibusb->handle) {
@@ -576,11 +1659,12 @@ AwResult AwLibusbDeviceList_CloseDevice(AwLibusbDeviceList* self, AwDevice* devi
     }
 
     MArrayEachPtr(self->openDevices, it) {
-        if (it.p == deviceLibusb) {
+        if (*it.p == deviceLibusb) {
             MArrayRemoveIndex(self->openDevices, it.i);
             break;
         }
     }
+    MFree(self->allocator, deviceLibusb, sizeof(AwDeviceLibusb));
     return (AwResult){.code=AW_RESULT_OK};
 }
 
@@ -625,6 +1709,10 @@ AwResult AwLibusbDeviceList_OpenBackend(AwBackend* backend, u32 timeoutMilliseco
     self->allocator = backend->allocator;
     self->logger = backend->logger;
     self->timeoutMilliseconds = (int)timeoutMilliseconds;
+    self->asyncTransferCount = backend->config.usbAsyncTransferCount ?
+        backend->config.usbAsyncTransferCount : USB_ASYNC_TRANSFER_COUNT_DEFAULT;
+    self->asyncTransferSize = backend->config.usbAsyncTransferSize ?
+        backend->config.usbAsyncTransferSize : USB_ASYNC_TRANSFER_SIZE_DEFAULT;
     self->backend = backend;
 
     backend->self = self;
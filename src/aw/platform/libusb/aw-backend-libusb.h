@@ -12,31 +12,111 @@ typedef struct {
     void* device; // libusb_device*
 } LibusbDeviceInfo;
 
+#define LIBUSB_EVENT_RING_CAPACITY 64 // Must be a power of two
+
+// Single producer (backend event thread) / single consumer (AwControl_ReadEvents()) queue, indices only grow and are
+// masked on access
+typedef struct {
+    AwPtpEvent events[LIBUSB_EVENT_RING_CAPACITY];
+    u32 head; // Next write, only written by the event thread
+    u32 tail; // Next read, only written by the reader
+    u32 overflowCount; // Events dropped because the reader fell behind
+} LibusbEventRing;
+
 typedef struct {
     void* device; // libusb_device*
     void* handle; // libusb_device_handle*
+    void* context; // libusb_context*
     AwUsbEndPoints usb;
     b32 disconnected;
     // Request timeout - can be adjust before requests
     u32 timeoutMilliseconds;
+    // Async data phase pipeline, number of bulk in transfers kept in flight and the size of each.
+    // Can be adjusted before requests, set asyncTransferCount <= 1 to only use synchronous transfers.
+    u32 asyncTransferCount;
+    u32 asyncTransferSize;
     MAllocator* allocator;
     AwLog logger;
     // Event handling
     u32 usbInterruptInterval;
     MMemIO eventMem; // Event buffer for reading and parsing events (reused across calls)
-    // Background event thread
-    pthread_t eventThread;
-    b32 eventThreadStop : 1;
-    b32 eventThreadStarted : 1;
-    pthread_mutex_t eventLock;
-    AwPtpEvent* eventList; // MArray of stored events
+    // Async interrupt transfer, completed on the backend event thread which queues events into eventRing
+    void* eventTransfer; // struct libusb_transfer*
+    b32 eventsAsync;
+    b32 eventStop; // Guarded by eventLock
+    b32 eventTransferActive; // Guarded by eventLock, cleared once the transfer is no longer resubmitted
+    u64 eventRetryTime; // MGetTimeMilliseconds() after which ReadEvents() restarts a failed transfer
+    u32 eventRetryDelay; // Milliseconds, doubles with each failed restart, guarded by eventLock
+    pthread_mutex_t eventLock; // Only used for wakeups, events themselves pass through eventRing without locking
+    pthread_cond_t eventCond;
+    LibusbEventRing eventRing;
+    u32 eventOverflowReported;
+    // Cancellation of the transaction in flight, see AwDevice_Cancel_Func
+    u32 inTransaction;
+    u32 transactionId;
+    u32 cancelClaimed; // Transaction id + 1 of the cancel being sent, only one thread sends it
+    u32 cancelRequested; // Transaction id + 1, set by the cancelling thread once the Cancel Request has been sent
 } AwDeviceLibusb;
 
+// Attached PTP capable device, tracked by hotplug so refreshes don't re-open devices to read their strings
+typedef struct {
+    void* device; // libusb_device*
+    u16 usbVID;
+    u16 usbPID;
+    u16 usbVersion;
+    MStr manufacturer;
+    MStr product;
+    MStr serial;
+} LibusbKnownDevice;
+
+typedef struct {
+    void* device; // libusb_device*
+    b32 arrived; // FALSE if the device left
+} LibusbHotplugEvent;
+
+// Enumeration results kept across refreshes, a device with the same bus, address, port path and VID/PID is assumed
+// unchanged and isn't opened again.  The address is reassigned on every plug, so a replug into the same port is
+// treated as a new device.
+typedef struct {
+    u8 busNumber;
+    u8 deviceAddress;
+    u8 portPathLen; // 0 if the port path couldn't be read, the bus and address still identify the device
+    u8 portPath[8];
+    u16 usbVID;
+    u16 usbPID;
+    u16 usbVersion;
+    b32 hasPtp; // FALSE entries are cached too, so non PTP Sony devices aren't re-checked
+    b32 seen; // Found during the current refresh, stale entries are dropped afterwards
+    AwUsbEndPoints endPoints;
+    MStr manufacturer;
+    MStr product;
+    MStr serial;
+} LibusbCachedDevice;
+
 typedef struct {
     LibusbDeviceInfo* devices;
-    AwDeviceLibusb* openDevices;
+    AwDeviceLibusb** openDevices; // MArray, each allocated separately as pending transfers point to them
     void* context; // libusb_context*
     int timeoutMilliseconds;
+    u32 asyncTransferCount;
+    u32 asyncTransferSize;
+    // Hotplug, when supported the device list is updated incrementally instead of rescanning the bus
+    b32 hotplugEnabled;
+    int hotplugHandle; // libusb_hotplug_callback_handle
+    pthread_mutex_t hotplugLock;
+    LibusbHotplugEvent* hotplugEvents; // MArray, queued from the hotplug callback under hotplugLock
+    LibusbKnownDevice* knownDevices; // MArray
+    void** pendingDevices; // MArray of libusb_device*, arrivals that couldn't be opened yet, retried on refresh
+    u64 pendingRetryTime; // MGetTimeMilliseconds() of the next retry of pendingDevices
+    b32 needsRefresh;
+    LibusbCachedDevice* deviceCache; // MArray, used when enumerating without hotplug
+    // Handles libusb events for all open devices, started with the first device that reads events asynchronously
+    pthread_t eventThread;
+    b32 eventThreadStarted;
+    int eventThreadStop;
+    // Fallback when libusb has no hotplug support (AW_ENABLE_UDEV), flags a refresh on Sony device add/remove uevents
+    void* udev; // struct udev*
+    void* udevMonitor; // struct udev_monitor*
     MAllocator* allocator;
     AwLog logger;
     struct AwBackend* backend; // Reference to parent backend
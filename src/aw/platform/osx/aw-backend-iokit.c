@@ -482,7 +482,7 @@ static void* AwDeviceIokit_ReallocBuffer(AwDevice* self, AwBufferType type, void
         u8* mem = ((u8*)dataMem)-headerSize;
         MFree(self->transport.allocator, mem, dataOldSize + headerSize); dataMem = NULL;
     }
-    dataMem = MMallocZ(self->transport.allocator, dataSize);
+    dataMem = MMalloc(self->transport.allocator, dataSize);
     return ((u8*)dataMem) + headerSize;
 }
 
@@ -680,6 +680,7 @@ static void HandleInterruptResponse(void *refcon, IOReturn result, void *arg0) {
     if (result == kIOReturnSuccess && transferred > 0) {
         AwPtpEvent tempEvent = {};
         if (ReadEventFromBuffer(dev, transferred, &tempEvent)) {
+            tempEvent.timestampMicroseconds = MGetTimeMicroseconds();
             pthread_mutex_lock(&dev->eventLock);
             AwPtpEvent* event = MArrayAddPtr(dev->allocator, dev->eventList);
             *event = tempEvent;
@@ -14,6 +14,14 @@ extern "C" {
 #define USB_SUBCLASS_STILL_IMAGE 0x01
 #define USB_BULK_MAX_PACKET_SIZE 512
 #define USB_TIMEOUT_DEFAULT_MILLISECONDS 20000
+#define USB_ASYNC_TRANSFER_COUNT_DEFAULT 4
+#define USB_ASYNC_TRANSFER_SIZE_DEFAULT (512 * 1024)
+
+// Still image class requests, from the USB Still Image Capture Device Definition
+#define USB_STILL_IMAGE_CANCEL_REQUEST 0x64
+#define USB_STILL_IMAGE_GET_DEVICE_STATUS 0x67
+#define USB_STILL_IMAGE_CANCEL_CODE 0x4001 // Cancel request data: cancel code (u16) followed by the transaction id (u32)
+#define USB_STILL_IMAGE_STATUS_MAX_SIZE 32
 
 // PTP Container Types
 #define PTP_CONTAINER_COMMAND  0x0001
@@ -235,6 +235,7 @@ static DWORD WINAPI EventThreadProc(LPVOID lpParameter) {
         if (transferred > 0) {
             AwPtpEvent tempEvent = {};
             if (ReadEventFromBuffer(dev, transferred, &tempEvent)) {
+                tempEvent.timestampMicroseconds = MGetTimeMicroseconds();
                 AcquireSRWLockExclusive(&dev->eventLock);
                 AwPtpEvent* event = MArrayAddPtr(dev->allocator, dev->eventList);
                 *event = tempEvent;
@@ -449,7 +450,7 @@ static void* AwDeviceUsbk_ReallocBuffer(AwDevice* self, AwBufferType type, void*
         u8* mem = ((u8*)dataMem)-headerSize;
         MFree(self->transport.allocator, mem, dataOldSize + headerSize); dataMem = NULL;
     }
-    dataMem = MMallocZ(self->transport.allocator, dataSize);
+    dataMem = MMalloc(self->transport.allocator, dataSize);
     return ((u8*)dataMem) + headerSize;
 }
 
@@ -579,7 +579,8 @@ typedef struct {
 
 #define MArrayCopy(m, a, b) ((b) = M_ArrayCopy(MDEBUG_SOURCE_MACRO (m), M_ArrayUnpack(a), M_ArrayUnpack(b)))
 
-#define MArrayRemoveIndex(a, b) (memcpy((a)+(b), (a)+(b)+1, (MArraySize(a)-(b)-1)*(sizeof*(a))))
+// Remove the item at index 'b', shifting the items after it down and shrinking the array by one
+#define MArrayRemoveIndex(a, b) (memmove((a)+(b), (a)+(b)+1, (MArraySize(a)-(b)-1)*(sizeof*(a))), --(M_ArrayHeader(a)->size))
 
 #define MArrayEach(a, i) for (size_t i = 0; (i) < MArraySize(a); ++(i))
 
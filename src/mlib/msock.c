@@ -6,12 +6,17 @@
     #include <iphlpapi.h>
 #else
     #include <sys/fcntl.h>
+    #include <sys/uio.h>
+    #include <poll.h>
     #include <arpa/inet.h>
     #include <netdb.h>
     #include <unistd.h>
     #include <errno.h>
     #include <ifaddrs.h>
     #include <net/if.h>
+    #ifdef __linux__
+        #include <sys/epoll.h>
+    #endif
 #endif
 
 int MSockInit() {
@@ -87,6 +92,34 @@ void MSockSetMulticastInterface(MSock s, const char* ip) {
     setsockopt(s, IPPROTO_IP, IP_MULTICAST_IF, (char*)&addr, sizeof(addr));
 }
 
+void MSockSetReuseAddress(MSock s, b32 reuse) {
+    int value = reuse ? 1 : 0;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char*)&value, sizeof(value));
+#ifdef SO_REUSEPORT
+    setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (char*)&value, sizeof(value));
+#endif
+}
+
+int MSockJoinMulticastGroup(MSock s, const char* group, const char* interfaceIp) {
+    struct ip_mreq mreq;
+    memset(&mreq, 0, sizeof(mreq));
+#ifdef _WIN32
+    InetPtonA(AF_INET, group, &mreq.imr_multiaddr);
+#else
+    inet_pton(AF_INET, group, &mreq.imr_multiaddr);
+#endif
+    if (!interfaceIp || interfaceIp[0] == '\0') {
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    } else {
+#ifdef _WIN32
+        InetPtonA(AF_INET, interfaceIp, &mreq.imr_interface);
+#else
+        inet_pton(AF_INET, interfaceIp, &mreq.imr_interface);
+#endif
+    }
+    return setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&mreq, sizeof(mreq));
+}
+
 static void FillAddr(struct sockaddr_in* addr, const char* ip, u16 port) {
     memset(addr, 0, sizeof(*addr));
     addr->sin_family = AF_INET;
@@ -190,6 +223,82 @@ int MSockSendAll(MSock s, MMemIO* memIo) {
     return totalSent;
 }
 
+int MSockSendBuffersAll(MSock s, const MSockBuffer* buffers, int count) {
+    if (count > MSOCK_SEND_BUFFERS_MAX) {
+        return -1;
+    }
+#ifdef _WIN32
+    WSABUF bufs[MSOCK_SEND_BUFFERS_MAX];
+#else
+    struct iovec bufs[MSOCK_SEND_BUFFERS_MAX];
+#endif
+    int n = 0;
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!buffers[i].size) {
+            continue;
+        }
+#ifdef _WIN32
+        bufs[n].buf = (char*)buffers[i].data;
+        bufs[n].len = (ULONG)buffers[i].size;
+#else
+        bufs[n].iov_base = (void*)buffers[i].data;
+        bufs[n].iov_len = buffers[i].size;
+#endif
+        total += buffers[i].size;
+        n++;
+    }
+
+    size_t totalSent = 0;
+    int first = 0;
+    while (totalSent < total) {
+#ifdef _WIN32
+        DWORD sentBytes = 0;
+        if (WSASend(s, bufs + first, (DWORD)(n - first), &sentBytes, 0, NULL, NULL) != 0) {
+            return -1;
+        }
+        size_t sent = sentBytes;
+#else
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = bufs + first;
+        msg.msg_iovlen = n - first;
+        ssize_t r = sendmsg(s, &msg, 0);
+        if (r < 0) {
+            return -1;
+        }
+        size_t sent = (size_t)r;
+#endif
+        if (sent == 0) {
+            return 0;
+        }
+        totalSent += sent;
+        // Step over what was sent, partially sent buffers are adjusted to start at the first unsent byte
+        while (first < n && sent) {
+#ifdef _WIN32
+            size_t len = bufs[first].len;
+#else
+            size_t len = bufs[first].iov_len;
+#endif
+            if (sent < len) {
+#ifdef _WIN32
+                bufs[first].buf += sent;
+                bufs[first].len -= (ULONG)sent;
+#else
+                bufs[first].iov_base = (u8*)bufs[first].iov_base + sent;
+                bufs[first].iov_len -= sent;
+#endif
+                sent = 0;
+            } else {
+                sent -= len;
+                first++;
+            }
+        }
+    }
+
+    return (int)totalSent;
+}
+
 int MSockRecv(MSock s, void* buf, int len) {
 #ifdef _WIN32
     return recv(s, (char*)buf, len, 0);
@@ -253,6 +362,169 @@ int MSockRecvFrom(MSock s, void* buf, int len, char* outIp, int outIpLen, u16* o
     return n;
 }
 
+int MSockPollerInit(MSockPoller* poller, MAllocator* allocator) {
+    memset(poller, 0, sizeof(MSockPoller));
+    poller->allocator = allocator;
+#ifdef MSOCK_POLLER_EPOLL
+    poller->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (poller->epollFd < 0) {
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+void MSockPollerFree(MSockPoller* poller) {
+#ifdef MSOCK_POLLER_EPOLL
+    if (poller->epollFd >= 0) {
+        close(poller->epollFd);
+        poller->epollFd = -1;
+    }
+#else
+    MArrayFree(poller->allocator, poller->pollFds);
+#endif
+    MArrayFree(poller->allocator, poller->entries);
+}
+
+#ifdef MSOCK_POLLER_EPOLL
+static u32 M_SockPollToEpoll(u32 events) {
+    u32 r = EPOLLRDHUP;
+    if (events & MSOCK_POLL_READ) {
+        r |= EPOLLIN;
+    }
+    if (events & MSOCK_POLL_WRITE) {
+        r |= EPOLLOUT;
+    }
+    return r;
+}
+#endif
+
+int MSockPollerAdd(MSockPoller* poller, MSock s, u32 events, void* userData) {
+#ifdef MSOCK_POLLER_EPOLL
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = M_SockPollToEpoll(events);
+    ev.data.fd = s;
+    if (epoll_ctl(poller->epollFd, EPOLL_CTL_ADD, s, &ev) != 0) {
+        return -1;
+    }
+#else
+    MSockPollFd* pollFd = MArrayAddPtrZ(poller->allocator, poller->pollFds);
+    pollFd->fd = s;
+    pollFd->events = (short)(((events & MSOCK_POLL_READ) ? POLLIN : 0) | ((events & MSOCK_POLL_WRITE) ? POLLOUT : 0));
+#endif
+    MSockPollEntry* entry = MArrayAddPtr(poller->allocator, poller->entries);
+    entry->sock = s;
+    entry->userData = userData;
+    entry->events = events;
+    return 0;
+}
+
+int MSockPollerRemove(MSockPoller* poller, MSock s) {
+    MArrayEachPtr(poller->entries, it) {
+        if (it.p->sock == s) {
+#ifdef MSOCK_POLLER_EPOLL
+            // Fails if the socket was already closed, closing removes it from the epoll set anyway
+            epoll_ctl(poller->epollFd, EPOLL_CTL_DEL, s, NULL);
+#else
+            MArrayRemoveIndex(poller->pollFds, it.i);
+#endif
+            MArrayRemoveIndex(poller->entries, it.i);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void MSockPollerClear(MSockPoller* poller) {
+#ifdef MSOCK_POLLER_EPOLL
+    MArrayEachPtr(poller->entries, it) {
+        epoll_ctl(poller->epollFd, EPOLL_CTL_DEL, it.p->sock, NULL);
+    }
+#else
+    MArrayClear(poller->pollFds);
+#endif
+    MArrayClear(poller->entries);
+}
+
+static void* M_SockPollerFindUserData(MSockPoller* poller, MSock s) {
+    MArrayEachPtr(poller->entries, it) {
+        if (it.p->sock == s) {
+            return it.p->userData;
+        }
+    }
+    return NULL;
+}
+
+int MSockPollerWait(MSockPoller* poller, int timeoutMs, MSockPollEvent* outEvents, int maxEvents) {
+    if (maxEvents > MSOCK_POLLER_WAIT_MAX) {
+        maxEvents = MSOCK_POLLER_WAIT_MAX;
+    }
+#ifdef MSOCK_POLLER_EPOLL
+    struct epoll_event events[MSOCK_POLLER_WAIT_MAX];
+    int n = epoll_wait(poller->epollFd, events, maxEvents, timeoutMs);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    for (int i = 0; i < n; ++i) {
+        u32 ready = 0;
+        if (events[i].events & EPOLLIN) {
+            ready |= MSOCK_POLL_READ;
+        }
+        if (events[i].events & EPOLLOUT) {
+            ready |= MSOCK_POLL_WRITE;
+        }
+        if (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            ready |= MSOCK_POLL_HANGUP;
+        }
+        outEvents[i].sock = events[i].data.fd;
+        outEvents[i].userData = M_SockPollerFindUserData(poller, events[i].data.fd);
+        outEvents[i].events = ready;
+    }
+    return n;
+#else
+    int count = (int)MArraySize(poller->pollFds);
+#ifdef _WIN32
+    if (count == 0) {
+        // WSAPoll() rejects an empty set
+        Sleep(timeoutMs < 0 ? INFINITE : (DWORD)timeoutMs);
+        return 0;
+    }
+    int r = WSAPoll(poller->pollFds, (ULONG)count, timeoutMs);
+#else
+    int r = poll(poller->pollFds, (nfds_t)count, timeoutMs);
+    if (r < 0 && errno == EINTR) {
+        return 0;
+    }
+#endif
+    if (r <= 0) {
+        return r;
+    }
+    int n = 0;
+    for (int i = 0; i < count && n < maxEvents; ++i) {
+        short revents = poller->pollFds[i].revents;
+        if (!revents) {
+            continue;
+        }
+        u32 ready = 0;
+        if (revents & POLLIN) {
+            ready |= MSOCK_POLL_READ;
+        }
+        if (revents & POLLOUT) {
+            ready |= MSOCK_POLL_WRITE;
+        }
+        if (revents & (POLLHUP | POLLERR | POLLNVAL)) {
+            ready |= MSOCK_POLL_HANGUP;
+        }
+        outEvents[n].sock = poller->entries[i].sock;
+        outEvents[n].userData = poller->entries[i].userData;
+        outEvents[n].events = ready;
+        n++;
+    }
+    return n;
+#endif
+}
+
 int M_SockClose(MSock s) {
 #ifdef _WIN32
     return closesocket(s);
@@ -264,6 +536,7 @@ int M_SockClose(MSock s) {
 MSockError MSockGetLastError() {
     int error = 0;
     b32 timeout = FALSE;
+    b32 inProgress = FALSE;
 #ifdef _WIN32
     error = WSAGetLastError();
 #else
@@ -271,10 +544,49 @@ MSockError MSockGetLastError() {
 #endif
 #ifdef _WIN32
     timeout = (error == WSAETIMEDOUT || error == WSAEWOULDBLOCK);
+    inProgress = (error == WSAEWOULDBLOCK);
 #else
     timeout = (error == EAGAIN || error == EWOULDBLOCK);
+    inProgress = (error == EINPROGRESS);
 #endif
-    return (MSockError){ error, timeout };
+    return (MSockError){ error, timeout, inProgress };
+}
+
+int MSockGetSocketError(MSock s) {
+    int error = 0;
+#ifdef _WIN32
+    int len = sizeof(error);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, (char*)&error, &len) != 0) {
+        return WSAGetLastError();
+    }
+#else
+    socklen_t len = sizeof(error);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+        return errno;
+    }
+#endif
+    return error;
+}
+
+int MSockWaitReadable(MSock s, int timeoutMs) {
+#ifdef _WIN32
+    WSAPOLLFD pollFd = {0};
+    pollFd.fd = s;
+    pollFd.events = POLLRDNORM;
+    int r = WSAPoll(&pollFd, 1, timeoutMs);
+#else
+    struct pollfd pollFd = {0};
+    pollFd.fd = s;
+    pollFd.events = POLLIN;
+    int r = poll(&pollFd, 1, timeoutMs);
+    if (r < 0 && errno == EINTR) {
+        return 0;
+    }
+#endif
+    if (r < 0) {
+        return MSOCK_ERROR;
+    }
+    return r > 0 ? 1 : 0;
 }
 
 // #ifndef INET6_ADDRSTRLEN
@@ -7,6 +7,9 @@
     #include <ws2tcpip.h>
 #else
     #include <sys/socket.h>
+    #ifndef __linux__
+        #include <poll.h>
+    #endif
 #endif
 
 #ifdef __cplusplus
@@ -42,6 +45,10 @@ MSock MSockMakeTcpSocket();
 MSock MSockMakeUdpSocket();
 void MSockSetBroadcast(MSock s, int broadcast);
 void MSockSetMulticastInterface(MSock s, const char* ip);
+// Allow more than one socket to bind the same port (SO_REUSEADDR, plus SO_REUSEPORT where available)
+void MSockSetReuseAddress(MSock s, b32 reuse);
+// Join an IPv4 multicast group on the interface with the given address, NULL or "" for the default interface
+int MSockJoinMulticastGroup(MSock s, const char* group, const char* interfaceIp);
 int MSockBind(MSock s, const char* ip, u16 port);
 int MSockListen(MSock s, int backlog);
 MSock MSockAccept(MSock s);
@@ -51,6 +58,17 @@ int MSockConnectHost(MSock s, MStrView host, u16 port, MSockAddress* outAddr);
 
 int MSockSend(MSock s, const void* buf, int len);
 int MSockSendAll(MSock s, MMemIO* memIo);
+
+#define MSOCK_SEND_BUFFERS_MAX 8
+
+typedef struct MSockBuffer {
+    const void* data;
+    size_t size;
+} MSockBuffer;
+
+// Gather send (sendmsg / WSASend) of up to MSOCK_SEND_BUFFERS_MAX buffers, looping until all bytes are sent.
+// Returns total bytes sent, 0 if the connection closed or MSOCK_ERROR.
+int MSockSendBuffersAll(MSock s, const MSockBuffer* buffers, int count);
 int MSockRecv(MSock s, void* buf, int len);
 int MSockRecvAll(MSock s, MMemIO* memIo);
 int MSockSendTo(MSock s, const void* buf, int len, const char* ip, u16 port);
@@ -61,10 +79,18 @@ int MSockRecvFrom(MSock s, void* buf, int len, char* outIp, int outIpLen, u16* o
 typedef struct MSockError {
     int code; // Platform error code
     b32 timeout; // Set to TRUE if (the error is a timeout) or (a blocking operation on a non-blocking socket)
+    b32 inProgress; // Set to TRUE if a connect on a non-blocking socket was started, wait for it to be writable
 } MSockError;
 
 MSockError MSockGetLastError();
 
+// Pending error on the socket (SO_ERROR), e.g. the result of a non-blocking connect, 0 if none
+int MSockGetSocketError(MSock s);
+
+// Wait up to 'timeoutMs' for the socket to have data to read (or be closed).  Returns 1 if readable, 0 on timeout or
+// MSOCK_ERROR.
+int MSockWaitReadable(MSock s, int timeoutMs);
+
 typedef struct MSockInterface {
     MStrView name;                  // interface name (e.g. "eth0", "en0")
     int family;                     // AF_INET / AF_INET6
@@ -85,6 +111,65 @@ typedef enum MSockInterfaceEnumFlags {
 // Enumerate interfaces and address
 int MSockGetInterfaces(MAllocator* allocator, MSockInterface** outAddr, int flags);
 
+//
+// Readiness multiplexer, waits on many sockets at once from a single thread.
+// Uses epoll on Linux, poll() on other POSIX platforms and WSAPoll on Windows.
+//
+
+#ifdef __linux__
+    #define MSOCK_POLLER_EPOLL
+#elif defined(_WIN32)
+    typedef WSAPOLLFD MSockPollFd;
+#else
+    typedef struct pollfd MSockPollFd;
+#endif
+
+// Max number of ready sockets returned from a single MSockPollerWait()
+#define MSOCK_POLLER_WAIT_MAX 64
+
+typedef enum MSockPollFlags {
+    MSOCK_POLL_READ = 1,
+    MSOCK_POLL_WRITE = 1 << 1,
+    MSOCK_POLL_HANGUP = 1 << 2, // Peer closed or socket error, always reported, no need to ask for it
+} MSockPollFlags;
+
+typedef struct MSockPollEvent {
+    MSock sock;
+    void* userData;
+    u32 events; // MSockPollFlags that are ready
+} MSockPollEvent;
+
+typedef struct MSockPollEntry {
+    MSock sock;
+    void* userData;
+    u32 events; // MSockPollFlags to wait for
+} MSockPollEntry;
+
+typedef struct MSockPoller {
+    MSockPollEntry* entries; // MArray of registered sockets
+#ifdef MSOCK_POLLER_EPOLL
+    int epollFd;
+#else
+    MSockPollFd* pollFds; // MArray matching entries, passed straight to poll()
+#endif
+    MAllocator* allocator;
+} MSockPoller;
+
+int MSockPollerInit(MSockPoller* poller, MAllocator* allocator);
+void MSockPollerFree(MSockPoller* poller);
+
+// Register a socket, 'events' can be 0 to only be told about hangups.
+// Sockets are level triggered, a hung up socket is reported by every wait until it is removed.
+int MSockPollerAdd(MSockPoller* poller, MSock s, u32 events, void* userData);
+int MSockPollerRemove(MSockPoller* poller, MSock s);
+void MSockPollerClear(MSockPoller* poller);
+
+// Wait up to timeoutMs (-1 to wait forever, 0 to not wait) for registered sockets to become ready.
+// Fills at most maxEvents (capped to MSOCK_POLLER_WAIT_MAX) entries of outEvents.
+// Returns the number of ready sockets, 0 on timeout or MSOCK_ERROR.
+// Not thread safe, add/remove sockets from the thread that waits.
+int MSockPollerWait(MSockPoller* poller, int timeoutMs, MSockPollEvent* outEvents, int maxEvents);
+
 // Internals
 int M_SockClose(MSock s);
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "aw/aw-control.h"
+#include "aw/aw-command-queue.h"
 #include "aw/aw-device-list.h"
+#include "aw/aw-live-view.h"
 #include "../mlib/utf8.h"
 
 #include <vector>
@@ -9,6 +11,8 @@
 #include <locale>
 #include <string>
 #include <deque>
+#include <functional>
+#include <mutex>
 
 #ifdef AW_ENABLE_WIA
 #include "aw/platform/windows/aw-backend-wia.h"
@@ -103,10 +107,14 @@ struct PropTable {
         return false;
     }
 
-    void rebuild(AwControl& ptp) {
+    void rebuild(AwPropertySnapshot* snapshot) {
         items.clear();
-        for (size_t i = 0; i < MArraySize(ptp.properties); i++) {
-            AwPtpProperty *property = ptp.properties + i;
+        if (snapshot == NULL) {
+            needsRebuild = false;
+            return;
+        }
+        for (size_t i = 0; i < MArraySize(snapshot->properties); i++) {
+            AwPtpProperty *property = snapshot->properties + i;
 
             UiPtpProperty uiPtpProperty{};
             snprintf(uiPtpProperty.propCode,  sizeof(uiPtpProperty.propCode), "0x%04x", property->propCode);
@@ -152,6 +160,7 @@ struct LogEntry {
 };
 
 struct LogWindow {
+    std::mutex lock; // Entries are added from the command queue and live view threads too
     std::deque<LogEntry> entries;
     bool autoScroll = true;
     int selectedLogLevel = AW_LOG_LEVEL_TRACE;  // Show all logs by default
@@ -159,6 +168,7 @@ struct LogWindow {
     static const size_t MAX_LOG_ENTRIES = 5000;
 
     void AddLog(AwLogLevel level, const char* message) {
+        std::lock_guard<std::mutex> guard(lock);
         entries.emplace_back(level, message);
         if (entries.size() > MAX_LOG_ENTRIES) {
             entries.pop_front();
@@ -166,6 +176,7 @@ struct LogWindow {
     }
 
     void Clear() {
+        std::lock_guard<std::mutex> guard(lock);
         entries.clear();
     }
 };
@@ -182,6 +193,9 @@ enum LiveViewOverlayMode {
     LiveViewOverlayMode_CROSSHAIR = 2,
 };
 
+// Device work queued by the UI, see AppContext::Submit()
+typedef std::function<AwResult(AwControl*)> UiDeviceFunc;
+
 struct AppContext {
     MAllocator* deviceListAllocator = NULL;
     MAllocator* autoReleasePool = NULL;
@@ -189,6 +203,10 @@ struct AppContext {
     AwDeviceList deviceList{};
     AwDevice* device = NULL;
     AwControl aw{};
+    // Runs every device call the UI makes, so a frame never waits on a transfer
+    AwCommandQueue commandQueue{};
+    // Newest published properties, everything on screen is drawn from this rather than the session
+    AwPropertySnapshot* props = nullptr;
     int selectedDeviceIndex = -1;
     int selectedProtoVersion = 1;
 
@@ -204,10 +222,15 @@ struct AppContext {
     double propertyLastRefreshTime = 0.;
     bool propAutoRefresh = true;
     bool propAutoRefreshIncremental = false;
+    bool propEventSync = false;
     bool propRefresh = true;
+    AwCommand* pollCommand = nullptr; // Event read / property refresh in flight
+    bool pollRefresh = false; // pollCommand includes a property refresh
+    AwCommand* propSyncCommand = nullptr; // Event Sync toggle in flight
 
     // Property & Controls Debug
-    AwPtpProperty* selectedProperty = nullptr;
+    AwPtpProperty* selectedProperty = nullptr; // Points into props
+    AwPtpPropValue selectedPropertyValue{}; // Value being edited for selectedProperty
     AwPtpControl* selectedControl = nullptr;
     AwPtpPropValue selectedControlValue;
     PropTable propTable{};
@@ -222,14 +245,15 @@ struct AppContext {
     // Live View state
     bool liveViewOpen = false;
     double liveViewLastTime = 0.;
-    MMemIO liveViewImage{};
-    AwLiveViewFrames liveViewFrames{};
+    AwLiveViewStream liveViewStream{};
+    AwLiveViewFrame* liveViewFrame = nullptr; // Newest frame taken from liveViewStream
     ImTextureID liveViewImageGLId = 0;
     i32 liveViewImageWidth = 0;
     i32 liveViewImageHeight = 0;
     bool liveFocusOverlay = true;
     bool osdEnabled = false;
     bool osdCaptured = false;
+    AwCommand* osdCommand = nullptr; // Fetch of osdImage in flight, written on the command queue's thread
     MMemIO osdImage{};
     ImTextureID osdImageGLId = 0;
     i32 osdImageWidth = 0;
@@ -253,6 +277,15 @@ struct AppContext {
     size_t fileDownloadTotalBytes = 0;
     bool fileDownloadAuto = false;
     std::string fileDownloadPath = "";
+    AwCommand* fileDownloadCommand = nullptr; // Download in flight, fills fileDownloadContents / fileDownloadInfo
+    MMemIO fileDownloadContents{};
+    AwPtpCapturedImageInfo fileDownloadInfo{};
+    i64 fileDownloadStartTime = 0;
+
+    // Camera settings file transfer
+    AwCommand* cameraSettingsCommand = nullptr;
+    MMemIO cameraSettingsFile{};
+    bool cameraSettingsSaving = false; // cameraSettingsCommand reads the file from the camera
 
     // Events
     double eventRefreshTime = 0.;
@@ -263,6 +296,105 @@ struct AppContext {
     // Log window
     LogWindow logWindow;
 
+    static AwResult RunDeviceFunc(AwControl* control, void* userData) {
+        return (*(UiDeviceFunc*)userData)(control);
+    }
+
+    static void FreeDeviceFunc(AwCommand* command, void* callbackData) {
+        delete (UiDeviceFunc*)callbackData;
+    }
+
+    // Queue device work instead of calling AwControl from the UI thread.  'func' runs on the command queue's thread
+    // while it owns the transport, so it may only touch the AwControl it's passed and data the UI leaves alone until
+    // the command is done.  Take outCommand to poll for the result with TakeFinished().
+    AwResult Submit(AwCommandPriority priority, UiDeviceFunc func, AwCommand** outCommand = nullptr) {
+        UiDeviceFunc* deviceFunc = new UiDeviceFunc(std::move(func));
+        AwCommandOptions options = {};
+        options.onComplete = FreeDeviceFunc;
+        options.callbackData = deviceFunc;
+        AwResult r = AwCommandQueue_Submit(&commandQueue, priority, RunDeviceFunc, deviceFunc, &options, outCommand);
+        if (r.code != AW_RESULT_OK) {
+            delete deviceFunc;
+        }
+        return r;
+    }
+
+    void SetPropertyValue(u16 propCode, AwPtpPropValue value) {
+        AwCommandQueue_SetPropertyValue(&commandQueue, propCode, value, NULL, NULL);
+    }
+
+    void SetControlValue(u16 controlCode, AwPtpPropValue value) {
+        AwCommandQueue_SetControlValue(&commandQueue, controlCode, value, NULL, NULL);
+    }
+
+    void SetControlToggle(u16 controlCode, bool pressed) {
+        AwCommandQueue_SetControlToggle(&commandQueue, controlCode, pressed, NULL, NULL);
+    }
+
+    void SetPropertyNotch(u16 propCode, i8 notch) {
+        Submit(AW_PRIORITY_PROPERTY_SET, [propCode, notch](AwControl* control) {
+            AwPtpProperty* property = AwControl_GetPropertyByCode(control, propCode);
+            if (!property) {
+                return AwResult{.code = AW_RESULT_NOT_SUPPORTED};
+            }
+            return AwControl_SetPropertyNotch(control, property, notch);
+        });
+    }
+
+    void SetPropertyStrRaw(u16 propCode, std::string value) {
+        Submit(AW_PRIORITY_PROPERTY_SET, [propCode, value](AwControl* control) {
+            AwPtpProperty* property = AwControl_GetPropertyByCode(control, propCode);
+            if (!property) {
+                return AwResult{.code = AW_RESULT_NOT_SUPPORTED};
+            }
+            return AwControl_SetPropertyStrRaw(control, property, MStr{(char*)value.c_str(), (u32)value.size(), 0});
+        });
+    }
+
+    void SetMagnifier(AwMagnifierSet magnifier) {
+        Submit(AW_PRIORITY_PROPERTY_SET, [magnifier](AwControl* control) {
+            return AwControl_SetMagnifier(control, magnifier);
+        });
+    }
+
+    // TRUE once a command from Submit() has finished, 'command' is released and cleared
+    static bool TakeFinished(AwCommand** command, AwResult* outResult) {
+        if (*command == nullptr || !AwCommand_IsDone(*command)) {
+            return false;
+        }
+        if (outResult) {
+            *outResult = (*command)->result;
+        }
+        AwCommand_Release(*command);
+        *command = nullptr;
+        return true;
+    }
+
+    // Switch to the newest published property snapshot, never waits on the session
+    void UpdatePropertySnapshot() {
+        AwPropertySnapshot* latest = AwControl_AcquirePropertySnapshot(&aw);
+        if (latest == props) {
+            AwPropertySnapshot_Release(latest);
+            return;
+        }
+        if (selectedProperty) {
+            selectedProperty = latest ?
+                (AwPtpProperty*)AwPropertySnapshot_GetProperty(latest, selectedProperty->propCode) : nullptr;
+        }
+        AwPropertySnapshot_Release(props);
+        props = latest;
+        propTable.needsRebuild = true;
+    }
+
+    // Property from the current snapshot, NULL if it doesn't have it
+    AwPtpProperty* GetProperty(u16 propCode) {
+        return props ? (AwPtpProperty*)AwPropertySnapshot_GetProperty(props, propCode) : nullptr;
+    }
+
+    bool PropertyEnabled(u16 propCode) {
+        return AwControl_PropertyEnabled(&aw, GetProperty(propCode));
+    }
+
     void RefreshDevices() {
         selectedDeviceIndex = -1;
         AwDeviceList_RefreshList(&deviceList);
@@ -282,19 +414,27 @@ struct AppContext {
                 r = AwControl_Init(&aw, device, &deviceAllocator);
                 if (r.code == AW_RESULT_OK) {
                     r = AwControl_Connect(&aw, selectedProtoVersion ? SDI_EXTENSION_VERSION_300 : SDI_EXTENSION_VERSION_200);
+                    if (r.code == AW_RESULT_OK) {
+                        AwControl_SetLiveViewMode(&aw, AW_LIVE_VIEW_MODE_SINGLE_REQUEST);
+                        AwControl_AcquireTransport(&aw, -1);
+                        AwControl_SetPropertySnapshots(&aw, TRUE);
+                        AwControl_ReleaseTransport(&aw);
+                        r = AwCommandQueue_Start(&commandQueue, &aw, NULL);
+                    }
                     if (r.code == AW_RESULT_OK) {
                         connected = true;
+                        UpdatePropertySnapshot();
                     }
                 }
             }
         }
         propTable.reset();
         if (connected) {
-            cameraSettingsSaveEnabled = AwControl_PropertyEnabledByCode(&aw, DPC_CAMERA_SETTING_SAVE_ENABLED);
-            cameraSettingsReadEnabled = AwControl_PropertyEnabledByCode(&aw, DPC_CAMERA_SETTING_READ_ENABLED);
+            cameraSettingsSaveEnabled = PropertyEnabled(DPC_CAMERA_SETTING_SAVE_ENABLED);
+            cameraSettingsReadEnabled = PropertyEnabled(DPC_CAMERA_SETTING_READ_ENABLED);
             remoteButtonsEnabled = AwControl_RemoteButtonEnable(&aw);
 
-            AwPtpProperty* photographerProperty = AwControl_GetPropertyByCode(&aw, DPC_PHOTOGRAPHER);
+            AwPtpProperty* photographerProperty = GetProperty(DPC_PHOTOGRAPHER);
             if (photographerProperty) {
                 size_t size = photographerProperty->value.str.size;
                 if (size >= sizeof(photographerEdit)) {
@@ -304,7 +444,7 @@ struct AppContext {
                 photographerEdit[size] = 0;
             }
 
-            AwPtpProperty* copyrightProperty = AwControl_GetPropertyByCode(&aw, DPC_COPYRIGHT);
+            AwPtpProperty* copyrightProperty = GetProperty(DPC_COPYRIGHT);
             if (copyrightProperty) {
                 size_t size = copyrightProperty->value.str.size;
                 if (size >= sizeof(copyrightEdit)) {
@@ -325,6 +465,7 @@ struct AppContext {
         osdEnabled = false;
         osdCaptured = false;
         propAutoRefresh = true;
+        propEventSync = false;
         propRefresh = true;
         propertyLastRefreshTime = 0.;
         selectedControl = nullptr;
@@ -340,9 +481,25 @@ struct AppContext {
 
     void DisconnectDevice() {
         if (device != NULL) {
-            MMemFree(&this->liveViewImage);
+            AwLiveViewStream_Stop(&liveViewStream);
+            liveViewFrame = nullptr;
+            // Finishes what's running, cancels the rest, nothing touches the buffers below after this
+            AwCommandQueue_Stop(&commandQueue);
+            for (AwCommand** command : {&pollCommand, &propSyncCommand, &osdCommand, &fileDownloadCommand,
+                                        &cameraSettingsCommand}) {
+                if (*command) {
+                    AwCommand_Release(*command);
+                    *command = nullptr;
+                }
+            }
+            MMemFree(&fileDownloadContents);
+            MStrFree(aw.allocator, fileDownloadInfo.filename);
+            fileDownloadInfo = {};
+            MMemFree(&cameraSettingsFile);
+            selectedProperty = nullptr;
+            AwPropertySnapshot_Release(props);
+            props = nullptr;
             MMemFree(&this->osdImage);
-            AwControl_FreeLiveViewFrames(&aw, &liveViewFrames);
             AwControl_Cleanup(&aw);
             AwDeviceList_CloseDevice(&deviceList, device);
 #ifdef M_MEM_DEBUG
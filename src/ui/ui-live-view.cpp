@@ -95,24 +95,36 @@ void UiPtpLiveViewShow(AppContext& c) {
         c.liveViewLastTime = ImGui::GetTime();
     }
 
+    AwLiveViewFrame* latestFrame = AwLiveViewStream_GetLatestFrame(&c.liveViewStream);
+    if (latestFrame) {
+        c.liveViewFrame = latestFrame;
+        LoadTextureFromMemory(&latestFrame->jpeg, &c.liveViewImageGLId, &c.liveViewImageWidth, &c.liveViewImageHeight);
+    }
+
+    // OSD image is fetched on the command queue's thread, osdImage is left alone until the command is done
+    AwResult osdResult = {};
+    if (AppContext::TakeFinished(&c.osdCommand, &osdResult)) {
+        if (osdResult.code == AW_RESULT_OK) {
+            LoadTextureFromMemory(&c.osdImage, &c.osdImageGLId, &c.osdImageWidth, &c.osdImageHeight);
+            c.osdCaptured = true;
+        } else {
+            c.osdCaptured = false;
+        }
+    }
+
     double currentTime = ImGui::GetTime();
     bool refresh = (currentTime - c.liveViewLastTime >= 0.1f);
     if (refresh) {
         c.liveViewLastTime = currentTime;
-        if (AwControl_GetLiveViewImage(&c.aw, &c.liveViewImage, &c.liveViewFrames).code == AW_RESULT_OK) {
-            LoadTextureFromMemory(&c.liveViewImage, &c.liveViewImageGLId, &c.liveViewImageWidth, &c.liveViewImageHeight);
-        }
-        if (c.osdEnabled) {
-            if (AwControl_GetOSDImage(&c.aw, &c.osdImage).code == AW_RESULT_OK) {
-                LoadTextureFromMemory(&c.osdImage, &c.osdImageGLId, &c.osdImageWidth, &c.osdImageHeight);
-                c.osdCaptured = true;
-            } else {
-                c.osdCaptured = false;
-            }
+        if (c.osdEnabled && !c.osdCommand) {
+            MMemIO* osdImage = &c.osdImage;
+            c.Submit(AW_PRIORITY_LIVE_VIEW, [osdImage](AwControl* control) {
+                return AwControl_GetOSDImage(control, osdImage);
+            }, &c.osdCommand);
         }
     }
 
-    if (c.liveViewImage.size != 0) {
+    if (c.liveViewFrame && c.liveViewFrame->jpeg.size != 0) {
         // Calculate scaled dimensions while maintaining aspect ratio
         ImVec2 windowContentSize = ImGui::GetContentRegionAvail();
         float windowAspect = windowContentSize.x / windowContentSize.y;
@@ -144,17 +156,18 @@ void UiPtpLiveViewShow(AppContext& c) {
         }
 
         // Indicate detected focus frames
-        if (c.liveFocusOverlay && MArraySize(c.liveViewFrames.focus.frames)) {
+        AwFocusFrames* focusFrames = &c.liveViewFrame->frames.focus;
+        if (c.liveFocusOverlay && MArraySize(focusFrames->frames)) {
             ImDrawList *drawList = ImGui::GetWindowDrawList();
             ImVec2 windowPos = ImGui::GetWindowPos();
 
-            MArrayEachPtr(c.liveViewFrames.focus.frames, it) {
+            MArrayEachPtr(focusFrames->frames, it) {
                 const auto& frame = it.p;
 
-                f32 x = frame->x / (f32)c.liveViewFrames.focus.xDenominator;
-                f32 y = frame->y / (f32)c.liveViewFrames.focus.yDenominator;
-                f32 w = frame->width / (f32)c.liveViewFrames.focus.xDenominator;
-                f32 h = frame->height / (f32)c.liveViewFrames.focus.yDenominator;
+                f32 x = frame->x / (f32)focusFrames->xDenominator;
+                f32 y = frame->y / (f32)focusFrames->yDenominator;
+                f32 w = frame->width / (f32)focusFrames->xDenominator;
+                f32 h = frame->height / (f32)focusFrames->yDenominator;
 
                 x *= renderWidth;
                 y *= renderHeight;
@@ -231,23 +244,26 @@ void UiPtpLiveViewShow(AppContext& c) {
                         case LiveViewClickAction_MOVE_FOCUS: {
                             // If no touch focus mode is set - set one
                             // Still need to be set to a flexible spot mode
-                            AwPtpProperty* liveViewTouchOp =
-                                AwControl_GetPropertyByCode(&c.aw, DPC_TOUCH_FOCUS_OPERATION);
-                            if (liveViewTouchOp->value.u8 == 0) {
-                                AwControl_SetPropertyValue(&c.aw, liveViewTouchOp, AwPtpPropValue{.u8 = 1});
+                            AwPtpProperty* liveViewTouchOp = c.GetProperty(DPC_TOUCH_FOCUS_OPERATION);
+                            if (liveViewTouchOp && liveViewTouchOp->value.u8 == 0) {
+                                c.SetPropertyValue(DPC_TOUCH_FOCUS_OPERATION, AwPtpPropValue{.u8 = 1});
                             }
                             AwMagnifier magnifier = {};
-                            AwControl_GetMagnifier(&c.aw, &magnifier);
+                            if (c.props) {
+                                AwPropertySnapshot_GetMagnifier(c.props, &magnifier);
+                            }
 
                             AwPosInt2 newPos = AwMagnifierMoveViewport(&magnifier,
                                 AwPosFloat2{.x = relX / renderWidth, .y = relY / renderHeight});
                             u32 value = (u32)(newPos.x << 16) | newPos.y;
-                            AwControl_SetControlValue(&c.aw, DPC_REMOTE_TOUCH_XY, AwPtpPropValue{.u32=value});
+                            c.SetControlValue(DPC_REMOTE_TOUCH_XY, AwPtpPropValue{.u32=value});
                             break;
                         }
                         case LiveViewClickAction_MAGNIFY: {
                             AwMagnifier magnifier = {};
-                            AwControl_GetMagnifier(&c.aw, &magnifier);
+                            if (c.props) {
+                                AwPropertySnapshot_GetMagnifier(c.props, &magnifier);
+                            }
 
                             // Move to next magnification level
                             i32 index = magnifier.ratioIndex;
@@ -263,8 +279,7 @@ void UiPtpLiveViewShow(AppContext& c) {
                             AwPosInt2 newPos = AwMagnifierMoveViewport(&magnifier,
                                 AwPosFloat2{.x = relX / renderWidth, .y = relY / renderHeight});
 
-                            AwControl_SetMagnifier(&c.aw,
-                                AwMagnifierSet{.x = newPos.x, .y = newPos.y, .ratio = *ratio});
+                            c.SetMagnifier(AwMagnifierSet{.x = newPos.x, .y = newPos.y, .ratio = *ratio});
                             break;
                         }
                     }
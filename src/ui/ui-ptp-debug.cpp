@@ -247,7 +247,7 @@ static bool ImGuiSlider(const char* label, u16 dataType, AwPtpPropValue* value,
 
 static void ImGuiShowPropertyText(AppContext& c, u16 propCode) {
     MStr str = {};
-    AwPtpProperty* propAfStatus = AwControl_GetPropertyByCode(&c.aw, propCode);
+    AwPtpProperty* propAfStatus = c.GetProperty(propCode);
     if (propAfStatus) {
         AwControl_GetPropertyValueAsStr(&c.aw, propAfStatus, c.autoReleasePool, &str);
         const char* label = AwGetPropertyLabel(propCode);
@@ -281,11 +281,11 @@ void ShowDebugExtendedPropWindow(AppContext& c, AwPtpProperty *property) {
 
     if (property->isNotch) {
         if (ImGui::Button("Notch Next")) {
-            AwControl_SetPropertyNotch(&c.aw, property, 1);
+            c.SetPropertyNotch(property->propCode, 1);
         }
         ImGui::SameLine();
         if (ImGui::Button("Notch Prev")) {
-            AwControl_SetPropertyNotch(&c.aw, property, -1);
+            c.SetPropertyNotch(property->propCode, -1);
         }
     }
 
@@ -329,7 +329,7 @@ void ShowDebugExtendedPropWindow(AppContext& c, AwPtpProperty *property) {
                     }
 
                     if (ImGui::Selectable(str, selected, selectFlags)) {
-                        AwControl_SetPropertyValue(&c.aw, property, valueEnum->propValue);
+                        c.SetPropertyValue(property->propCode, valueEnum->propValue);
                     }
 
                     ImGui::TableNextColumn();
@@ -354,8 +354,10 @@ void ShowDebugExtendedPropWindow(AppContext& c, AwPtpProperty *property) {
         }
     }
     else if (property->formFlag == PTP_FORM_FLAG_RANGE) {
-        if (ImGuiSlider(NULL, property->dataType, &property->value, property->form.range.min, property->form.range.step, property->form.range.max)) {
-            AwControl_SetPropertyValue(&c.aw, property, property->value);
+        // Snapshot properties are read only, the slider shows the new value once the set is published
+        AwPtpPropValue value = property->value;
+        if (ImGuiSlider(NULL, property->dataType, &value, property->form.range.min, property->form.range.step, property->form.range.max)) {
+            c.SetPropertyValue(property->propCode, value);
         }
     }
 
@@ -374,17 +376,17 @@ void ShowDebugExtendedPropWindow(AppContext& c, AwPtpProperty *property) {
             case PTP_DT_UINT32:
             case PTP_DT_INT64:
             case PTP_DT_UINT64:
-                ImGuiInputIntDuel(property->dataType, &property->value);
+                ImGuiInputIntDuel(property->dataType, &c.selectedPropertyValue);
                 ImGui::SameLine();
                 if (ImGui::Button("Send")) {
-                    AwControl_SetPropertyValue(&c.aw, property, property->value);
+                    c.SetPropertyValue(property->propCode, c.selectedPropertyValue);
                 }
                 break;
             case PTP_DT_STR: {
                 ImGui::InputText("Value", c.debugSetText, sizeof(c.debugSetText));
                 ImGui::SameLine();
                 if (ImGui::Button("Send")) {
-                    AwControl_SetPropertyStrRaw(&c.aw, property, MStr{c.debugSetText, MCStrLen(c.debugSetText), MCStrLen(c.debugSetText)});
+                    c.SetPropertyStrRaw(property->propCode, c.debugSetText);
                 }
                 break;
             }
@@ -468,7 +470,7 @@ void ShowDebugExtendedControlWindow(AppContext& c, AwPtpControl *control) {
                     }
 
                     if (ImGui::Selectable(str, false, selectFlags)) {
-                        AwControl_SetControlValue(&c.aw, control->controlCode, valueEnum->propValue);
+                        c.SetControlValue(control->controlCode, valueEnum->propValue);
                     }
 
                     ImGui::TableNextColumn();
@@ -485,7 +487,7 @@ void ShowDebugExtendedControlWindow(AppContext& c, AwPtpControl *control) {
             ImGuiInputIntDuel(control->dataType, &c.selectedControlValue);
             ImGui::SameLine();
             if (ImGui::Button("Set")) {
-                AwControl_SetControlValue(&c.aw, control->controlCode, c.selectedControlValue);
+                c.SetControlValue(control->controlCode, c.selectedControlValue);
             }
         }
     } else if (control->formFlag == PTP_FORM_FLAG_RANGE) {
@@ -508,7 +510,7 @@ void ShowDebugExtendedControlWindow(AppContext& c, AwPtpControl *control) {
         ImGui::SameLine();
 
         if (ImGui::Button("Set")) {
-            AwControl_SetControlValue(&c.aw, control->controlCode, c.selectedControlValue);
+            c.SetControlValue(control->controlCode, c.selectedControlValue);
         }
         // Display current value
     }
@@ -558,6 +560,16 @@ void ShowDebugPropertyListTab(AppContext& c) {
         ImGui::Checkbox("Auto Refresh", &c.propAutoRefresh);
         ImGui::SameLine();
         ImGui::Checkbox("Incremental", &c.propAutoRefreshIncremental);
+        ImGui::SameLine();
+        ImGui::BeginDisabled(c.propSyncCommand != nullptr);
+        if (ImGui::Checkbox("Event Sync", &c.propEventSync)) {
+            // Result is checked in PollDevice()
+            bool enabled = c.propEventSync;
+            c.Submit(AW_PRIORITY_PROPERTY_SET, [enabled](AwControl* control) {
+                return AwControl_SetPropertySync(control, enabled, 0);
+            }, &c.propSyncCommand);
+        }
+        ImGui::EndDisabled();
 
         ImGuiTableFlags flags =
                 ImGuiTableFlags_Sortable |
@@ -620,6 +632,7 @@ void ShowDebugPropertyListTab(AppContext& c) {
                 if (ImGui::Selectable(uiPtpProperty.propCode, c.selectedProperty == property,
                                       selectFlags)) {
                     c.selectedProperty = property;
+                    c.selectedPropertyValue = property->dataType == PTP_DT_STR ? AwPtpPropValue{} : property->value;
                     c.selectedControl = nullptr;
                     c.selectedControlValue = {};
                     c.showWindowDebugPropertyOrControl = true;
@@ -685,17 +698,17 @@ void ShowDebugPropertyListTab(AppContext& c) {
 
 static void ImGuiControlButton(AppContext &c, const char* buttonName, u16 propertyCode) {
     if (ImGui::Button(buttonName)) {
-        AwControl_SetControlToggle(&c.aw, propertyCode, true);
+        c.SetControlToggle(propertyCode, true);
     }
     if (ImGui::IsItemHovered()) {
         if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
-            AwControl_SetControlToggle(&c.aw, propertyCode, false);
+            c.SetControlToggle(propertyCode, false);
         }
     }
 }
 
 static void ImGuiBuildPropertyCombo(AppContext& c, u16 propCode, const char* label) {
-    if (AwPtpProperty* property = AwControl_GetPropertyByCode(&c.aw, propCode)) {
+    if (AwPtpProperty* property = c.GetProperty(propCode)) {
         MStr currentValAsStr = {};
         AwControl_GetPropertyValueAsStr(&c.aw, property, c.autoReleasePool, &currentValAsStr);
         if (AwControl_IsPropertyWritable(&c.aw, property)) {
@@ -707,7 +720,7 @@ static void ImGuiBuildPropertyCombo(AppContext& c, u16 propCode, const char* lab
                         AwPtpPropValueEnum* valueEnum = options.values + i;
                         bool isSelected = AwPtpPropEquals(property, valueEnum->propValue);
                         if (ImGui::Selectable(valueEnum->str.str, isSelected)) {
-                            AwControl_SetPropertyValue(&c.aw, property, valueEnum->propValue);
+                            c.SetPropertyValue(propCode, valueEnum->propValue);
                         }
                     }
                     ImGui::EndCombo();
@@ -725,11 +738,11 @@ static void ImGuiBuildPropertyCombo(AppContext& c, u16 propCode, const char* lab
             ImGui::PushID(propCode);
             ImGui::SameLine();
             if (ImGui::Button("Notch Down")) {
-                AwControl_SetPropertyNotch(&c.aw, property, -1);
+                c.SetPropertyNotch(propCode, -1);
             }
             ImGui::SameLine();
             if (ImGui::Button("Notch Up")) {
-                AwControl_SetPropertyNotch(&c.aw, property, 1);
+                c.SetPropertyNotch(propCode, 1);
             }
             ImGui::PopID();
         }
@@ -737,11 +750,12 @@ static void ImGuiBuildPropertyCombo(AppContext& c, u16 propCode, const char* lab
 }
 
 static void ImGuiBuildPropertySlider(AppContext& c, u16 propCode, const char* label) {
-    if (AwPtpProperty* property = AwControl_GetPropertyByCode(&c.aw, propCode)) {
+    if (AwPtpProperty* property = c.GetProperty(propCode)) {
         if (AwControl_IsPropertyWritable(&c.aw, property)) {
-            if (ImGuiSlider(label, property->dataType, &property->value, property->form.range.min,
+            AwPtpPropValue value = property->value;
+            if (ImGuiSlider(label, property->dataType, &value, property->form.range.min,
                     property->form.range.step, property->form.range.max)) {
-                AwControl_SetPropertyValue(&c.aw, property, property->value);
+                c.SetPropertyValue(propCode, value);
             }
             return;
         }
@@ -812,6 +826,7 @@ static void ShowLogWindow(AppContext& c) {
         ImGui::TableHeadersRow();
 
         // Display log entries filtered by level
+        std::lock_guard<std::mutex> guard(c.logWindow.lock);
         for (const auto& entry : c.logWindow.entries) {
             if (entry.level <= c.logWindow.selectedLogLevel) {
                 ImGui::TableNextRow();
@@ -865,30 +880,30 @@ void ShowCameraControlsWindow(AppContext& c) {
     ImGui::Checkbox("Inspect Controls", &c.showWindowDeviceDebug);
 
     if (ImGui::Button("Shutter")) {
-        AwControl_SetControlToggle(&c.aw, DPC_SHUTTER, false);
+        c.SetControlToggle(DPC_SHUTTER, false);
     }
     if (ImGui::IsItemHovered()) {
         if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
-            AwControl_SetControlToggle(&c.aw, DPC_SHUTTER, true);
+            c.SetControlToggle(DPC_SHUTTER, true);
         }
     }
 
     ImGui::SameLine();
     if (ImGui::Checkbox("Half-Press", &c.shutterHalfPress)) {
-        AwControl_SetControlToggle(&c.aw, DPC_SHUTTER_HALF_PRESS, c.shutterHalfPress);
+        c.SetControlToggle(DPC_SHUTTER_HALF_PRESS, c.shutterHalfPress);
     }
 
     ImGui::Spacing();
     if (ImGui::CollapsingHeader("Live View", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Spacing();
-        AwPtpProperty* osdImageModeProp = AwControl_GetPropertyByCode(&c.aw, DPC_OSD_IMAGE_MODE);
+        AwPtpProperty* osdImageModeProp = c.GetProperty(DPC_OSD_IMAGE_MODE);
         if (osdImageModeProp) {
             ImGui::SameLine();
             ImGui::BeginDisabled(!c.liveViewOpen);
             if (ImGui::Checkbox("OSD", &c.osdEnabled)) {
                 AwPtpPropValue value = {};
                 value.u8 = c.osdEnabled ? 1 : 0;
-                AwControl_SetPropertyValue(&c.aw, osdImageModeProp, value);
+                c.SetPropertyValue(DPC_OSD_IMAGE_MODE, value);
             }
             ImGui::EndDisabled();
         }
@@ -898,18 +913,26 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGui::Checkbox("Show Focus", &c.liveFocusOverlay);
         ImGui::EndDisabled();
 
+        if (c.liveViewStream.running) {
+            AwLiveViewStreamStats stats;
+            AwLiveViewStream_GetStats(&c.liveViewStream, &stats);
+            u32 averageLatency = stats.framesPublished ? (u32)(stats.totalLatencyMs / stats.framesPublished) : 0;
+            ImGui::SameLine();
+            ImGui::Text("Frames: %u Dropped: %u Failed: %u Latency: %u ms (avg %u ms)", stats.framesPublished,
+                        stats.framesDropped, stats.framesFailed, stats.lastLatencyMs, averageLatency);
+        }
+
         if (!c.liveViewOpen) {
             ImGui::BeginDisabled();
         }
-        AwPtpProperty* liveViewSettingEffect =
-            AwControl_GetPropertyByCode(&c.aw, DPC_LIVE_VIEW_SETTING_EFFECT);
+        AwPtpProperty* liveViewSettingEffect = c.GetProperty(DPC_LIVE_VIEW_SETTING_EFFECT);
         if (liveViewSettingEffect) {
             ImGui::SameLine();
             bool settingsEffectEnabled = liveViewSettingEffect->value.u8 == 1 ? true : false;
             if (ImGui::Checkbox("Settings Effect", &settingsEffectEnabled)) {
                 AwPtpPropValue value = {};
                 value.u8 = settingsEffectEnabled ? 1 : 2;
-                AwControl_SetPropertyValue(&c.aw, liveViewSettingEffect, value);
+                c.SetPropertyValue(DPC_LIVE_VIEW_SETTING_EFFECT, value);
             }
         }
 
@@ -925,7 +948,7 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGui::SliderFloat("##Size", &c.liveViewOverlayThickness, 0.1, 20.0, "%0.2f");
         ImGui::PopID();
 
-        bool touchEnabled = AwControl_PropertyEnabledByCode(&c.aw, DPC_REMOTE_TOUCH_ENABLED);
+        bool touchEnabled = c.PropertyEnabled(DPC_REMOTE_TOUCH_ENABLED);
         bool focusMagnifyEnabled = AwControl_SupportsProperty(&c.aw, DPC_FOCUS_MAGNIFY);
         if (focusMagnifyEnabled || touchEnabled) {
             ImGui::PushID("clickAction");
@@ -954,7 +977,7 @@ void ShowCameraControlsWindow(AppContext& c) {
 
         // Focus Mode
         MStr afMode = {};
-        AwPtpProperty* propFocusMode = AwControl_GetPropertyByCode(&c.aw, DPC_FOCUS_MODE);
+        AwPtpProperty* propFocusMode = c.GetProperty(DPC_FOCUS_MODE);
         AwControl_GetPropertyValueAsStr(&c.aw, propFocusMode, c.autoReleasePool, &afMode);
         AwPtpPropValueEnums focusModes = {};
         if (AwControl_GetEnumsForProperty(&c.aw, propFocusMode, c.autoReleasePool, &focusModes) &&
@@ -964,7 +987,7 @@ void ShowCameraControlsWindow(AppContext& c) {
                     AwPtpPropValueEnum *valueEnum = focusModes.values + i;
                     bool isSelected = MStrCmp(afMode, valueEnum->str);
                     if (ImGui::Selectable(valueEnum->str.str, isSelected)) {
-                        AwControl_SetPropertyValue(&c.aw, propFocusMode, valueEnum->propValue);
+                        c.SetPropertyValue(DPC_FOCUS_MODE, valueEnum->propValue);
                     }
                 }
                 ImGui::EndCombo();
@@ -978,14 +1001,14 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGuiShowPropertyText(c, DPC_AUTO_FOCUS_STATUS);
 
         if (ImGui::Checkbox("AF-On", &c.autoFocusButton)) {
-            AwControl_SetControlToggle(&c.aw, DPC_AUTO_FOCUS_HOLD, c.autoFocusButton);
+            c.SetControlToggle(DPC_AUTO_FOCUS_HOLD, c.autoFocusButton);
         }
 
         // Manual Focus Adjust
         AwPtpControl* focusAdjust = AwControl_GetControlByCode(&c.aw, DPC_MANUAL_FOCUS_ADJUST);
         if (focusAdjust) {
             AwPtpPropValue focusAdjustVal{};
-            bool enable = AwControl_PropertyEnabledByCode(&c.aw, DPC_MANUAL_FOCUS_ADJUST_ENABLED);
+            bool enable = c.PropertyEnabled(DPC_MANUAL_FOCUS_ADJUST_ENABLED);
             if (!enable) {
                 ImGui::BeginDisabled();
             }
@@ -1046,9 +1069,10 @@ void ShowCameraControlsWindow(AppContext& c) {
             }
             if (focusAdjustVal.i16 != 0) {
                 AwPtpPropValue focusAdjustOff{};
-                AwControl_SetControlValue(&c.aw, DPC_MANUAL_FOCUS_ADJUST, focusAdjustOff);
-                AwControl_SetControlValue(&c.aw, DPC_MANUAL_FOCUS_ADJUST, focusAdjustVal);
-                AwControl_SetControlValue(&c.aw, DPC_MANUAL_FOCUS_ADJUST, focusAdjustOff);
+                // Same priority class, so the queue runs them in this order
+                c.SetControlValue(DPC_MANUAL_FOCUS_ADJUST, focusAdjustOff);
+                c.SetControlValue(DPC_MANUAL_FOCUS_ADJUST, focusAdjustVal);
+                c.SetControlValue(DPC_MANUAL_FOCUS_ADJUST, focusAdjustOff);
             }
             if (!enable) {
                 ImGui::EndDisabled();
@@ -1063,7 +1087,8 @@ void ShowCameraControlsWindow(AppContext& c) {
     ImGui::Spacing();
     if (ImGui::CollapsingHeader("Capture Files", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Spacing();
-        ImGui::Text("Files On Camera: %d", AwControl_GetPendingFiles(&c.aw));
+        int pendingFiles = c.props ? AwPropertySnapshot_GetPendingFiles(c.props) : 0;
+        ImGui::Text("Files On Camera: %d", pendingFiles);
         ImGui::Text("Last Download Time: %lldms (%lldms)", c.fileDownloadTotalMillis, c.fileDownloadTimeMillis);
         ImGui::Text("Last Filename: %s", c.fileDownloadPath.c_str());
         ImGui::SameLine();
@@ -1074,7 +1099,7 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGui::SameLine();
 
         bool fileDownload = false;
-        if (c.fileDownloadAuto && AwControl_GetPendingFiles(&c.aw)) {
+        if (c.fileDownloadAuto && pendingFiles) {
             fileDownload = true;
         }
 
@@ -1090,30 +1115,37 @@ void ShowCameraControlsWindow(AppContext& c) {
             ImGui::EndDisabled();
         }
 
-        if (fileDownload) {
-            MMemIO fileContents{};
-            AwPtpCapturedImageInfo cii = {};
-            SDL_Time startTime = 0;
-            SDL_GetCurrentTime(&startTime);
-            AwResult r = AwControl_GetCapturedImage(&c.aw, &fileContents, &cii);
+        // The download runs on the command queue, the file is written once it's done
+        AwResult r = {};
+        if (AppContext::TakeFinished(&c.fileDownloadCommand, &r)) {
             SDL_Time dlTime = 0;
             SDL_GetCurrentTime(&dlTime);
+            AwPtpCapturedImageInfo& cii = c.fileDownloadInfo;
             if (r.code != AW_RESULT_OK) {
                 MLogf("Error fetching image from camera: %04x", r);
             } else if (cii.filename.size) {
                 MLogf("Writing %.*s...", cii.filename.size, cii.filename.str);
-                MFileWriteDataFully(cii.filename.str, fileContents.mem, fileContents.size);
+                MFileWriteDataFully(cii.filename.str, c.fileDownloadContents.mem, c.fileDownloadContents.size);
                 SDL_Time writeTime = 0;
                 SDL_GetCurrentTime(&writeTime);
-                c.fileDownloadTotalMillis = (writeTime - startTime) / (1000*1000);
-                c.fileDownloadTimeMillis = (dlTime - startTime) / (1000*1000);
+                c.fileDownloadTotalMillis = (writeTime - c.fileDownloadStartTime) / (1000*1000);
+                c.fileDownloadTimeMillis = (dlTime - c.fileDownloadStartTime) / (1000*1000);
                 MLogf("Total image save time %lld (dl time %lld)",
                     c.fileDownloadTotalMillis, c.fileDownloadTimeMillis);
-                c.fileDownloadTotalBytes = fileContents.size;
+                c.fileDownloadTotalBytes = c.fileDownloadContents.size;
                 c.fileDownloadPath = cii.filename.str;
-                MMemFree(&fileContents);
-                MStrFree(c.aw.allocator, cii.filename);
             }
+            MMemFree(&c.fileDownloadContents);
+            MStrFree(c.aw.allocator, cii.filename);
+            cii = {};
+        }
+
+        if (fileDownload && !c.fileDownloadCommand) {
+            SDL_Time startTime = 0;
+            SDL_GetCurrentTime(&startTime);
+            c.fileDownloadStartTime = startTime;
+            AwCommandQueue_GetCapturedImage(&c.commandQueue, &c.fileDownloadContents, &c.fileDownloadInfo, NULL,
+                                            &c.fileDownloadCommand);
         }
     }
 
@@ -1122,7 +1154,7 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGui::Spacing();
 
         AwMagnifier magnifier = {};
-        if (AwControl_GetMagnifier(&c.aw, &magnifier).code == AW_RESULT_OK) {
+        if (c.props && AwPropertySnapshot_GetMagnifier(c.props, &magnifier).code == AW_RESULT_OK) {
             if (magnifier.ratio.ratioByTen == 0) {
                 ImGui::Text("Magnifier: Off (%d, %d)", magnifier.x, magnifier.y);
             } else {
@@ -1151,7 +1183,7 @@ void ShowCameraControlsWindow(AppContext& c) {
                                 .y = magnifier.y,
                                 .ratio = *ratio
                             };
-                            AwControl_SetMagnifier(&c.aw, magnifierSet);
+                            c.SetMagnifier(magnifierSet);
                         }
                         ImGui::PopID();
                     }
@@ -1202,7 +1234,7 @@ void ShowCameraControlsWindow(AppContext& c) {
                         .y = y,
                         .ratio = magnifier.ratio,
                     };
-                    AwControl_SetMagnifier(&c.aw, magnifierSet);
+                    c.SetMagnifier(magnifierSet);
                 }
             } else {
                 ImGuiControlButton(c, "Magnify", DPC_FOCUS_MAGNIFIER);
@@ -1264,7 +1296,7 @@ void ShowCameraControlsWindow(AppContext& c) {
     ImGui::Spacing();
     if (ImGui::CollapsingHeader("Metadata")) {
         ImGui::Spacing();
-        AwPtpProperty* dateTimeProperty = AwControl_GetPropertyByCode(&c.aw, DPC_DATE_TIME_SET);
+        AwPtpProperty* dateTimeProperty = c.GetProperty(DPC_DATE_TIME_SET);
 
         if (dateTimeProperty) {
             if (ImGui::Button("Set Time Now")) {
@@ -1308,12 +1340,11 @@ void ShowCameraControlsWindow(AppContext& c) {
 
                 MLogf("Setting time to '%s'", timeBuffer);
 
-                MStr time = MStrMakeStaticCStr(timeBuffer);
-                AwControl_SetPropertyStrRaw(&c.aw, dateTimeProperty, time);
+                c.SetPropertyStrRaw(DPC_DATE_TIME_SET, timeBuffer);
             }
         }
 
-        AwPtpProperty* copyrightProperty = AwControl_GetPropertyByCode(&c.aw, DPC_COPYRIGHT);
+        AwPtpProperty* copyrightProperty = c.GetProperty(DPC_COPYRIGHT);
         if (copyrightProperty) {
             bool set = false;
             if (ImGui::InputText("Copyright", c.copyrightEdit, sizeof(c.copyrightEdit),
@@ -1326,12 +1357,12 @@ void ShowCameraControlsWindow(AppContext& c) {
                 set = true;
             }
             if (set) {
-                AwControl_SetPropertyStrRaw(&c.aw, copyrightProperty, MStrMakeStaticCStr(c.copyrightEdit));
+                c.SetPropertyStrRaw(DPC_COPYRIGHT, c.copyrightEdit);
             }
             ImGui::PopID();
         }
 
-        AwPtpProperty* photographerProperty = AwControl_GetPropertyByCode(&c.aw, DPC_PHOTOGRAPHER);
+        AwPtpProperty* photographerProperty = c.GetProperty(DPC_PHOTOGRAPHER);
         if (photographerProperty) {
             bool set = false;
             if (ImGui::InputText("Photographer", c.photographerEdit, sizeof(c.photographerEdit),
@@ -1344,7 +1375,7 @@ void ShowCameraControlsWindow(AppContext& c) {
                 set = true;
             }
             if (set) {
-                AwControl_SetPropertyStrRaw(&c.aw, photographerProperty, MStrMakeStaticCStr(c.photographerEdit));
+                c.SetPropertyStrRaw(DPC_PHOTOGRAPHER, c.photographerEdit);
             }
             ImGui::PopID();
         }
@@ -1354,7 +1385,7 @@ void ShowCameraControlsWindow(AppContext& c) {
         ImGui::Spacing();
         if (ImGui::CollapsingHeader("Buttons")) {
             ImGui::Spacing();
-            AwPtpProperty* buttonList = AwControl_GetPropertyByCode(&c.aw, DPC_BUTTON_LIST);
+            AwPtpProperty* buttonList = c.GetProperty(DPC_BUTTON_LIST);
 
             ImGui::PushID("remoteButtons");
             AwPtpPropValueEnums buttonListEnum = {};
@@ -1364,10 +1395,12 @@ void ShowCameraControlsWindow(AppContext& c) {
                     char buffer[256];
                     if (snprintf(buffer, sizeof(buffer), "%.*s", buttonName->size, buttonName->str) >= 0) {
                         if (ImGui::Button(buffer)) {
-                            AwControl_RemoteButtonPress(&c.aw, buttonListEnum.values[i].propValue.u16, TRUE);
+                            AwCommandQueue_RemoteButtonPress(&c.commandQueue, buttonListEnum.values[i].propValue.u16,
+                                                             TRUE, NULL, NULL);
                         }
                         if (ImGui::IsItemHovered() && ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
-                            AwControl_RemoteButtonPress(&c.aw, buttonListEnum.values[i].propValue.u16, FALSE);
+                            AwCommandQueue_RemoteButtonPress(&c.commandQueue, buttonListEnum.values[i].propValue.u16,
+                                                             FALSE, NULL, NULL);
                         }
                     }
                     if ((i + 1) % 5) {
@@ -1386,17 +1419,30 @@ void ShowCameraControlsWindow(AppContext& c) {
 
         bool showSettingsFileInput = false;
 
+        // Transfers run on the command queue, cameraSettingsFile is only touched here once it's done
+        AwResult r = {};
+        if (AppContext::TakeFinished(&c.cameraSettingsCommand, &r)) {
+            if (c.cameraSettingsSaving) {
+                if (r.code != AW_RESULT_OK) {
+                    MLogf("Error fetching settings from camera: %d", r);
+                } else {
+                    MFileWriteDataFully(c.cameraSettingsPathBuffer, c.cameraSettingsFile.mem, c.cameraSettingsFile.size);
+                }
+            } else if (r.code != AW_RESULT_OK) {
+                MLogf("Error uploading file %s", c.cameraSettingsPathBuffer);
+            }
+            MMemFree(&c.cameraSettingsFile);
+        }
+
+        ImGui::BeginDisabled(c.cameraSettingsCommand != nullptr);
         if (c.cameraSettingsReadEnabled) {
             if (ImGui::Button("Load")) {
                 MReadFileRet file = MFileReadFully(c.aw.allocator, c.cameraSettingsPathBuffer);
                 if (file.size > 0) {
-                    MMemIO memIo{};
-                    MMemInit(&memIo, c.aw.allocator, file.data, file.size);
-                    AwResult r = AwControl_PutCameraSettingsFile(&c.aw, &memIo);
-                    if (r.code != AW_RESULT_OK) {
-                        MLogf("Error uploading file %s", c.cameraSettingsPathBuffer);
-                    }
-                    MMemFree(&memIo);
+                    MMemInit(&c.cameraSettingsFile, c.aw.allocator, file.data, file.size);
+                    c.cameraSettingsSaving = false;
+                    AwCommandQueue_PutCameraSettingsFile(&c.commandQueue, &c.cameraSettingsFile, NULL,
+                                                         &c.cameraSettingsCommand);
                 }
                 showSettingsFileInput = true;
             }
@@ -1404,17 +1450,13 @@ void ShowCameraControlsWindow(AppContext& c) {
         if (c.cameraSettingsSaveEnabled) {
             ImGui::SameLine();
             if (ImGui::Button("Save")) {
-                MMemIO memIo{};
-                AwResult r = AwControl_GetCameraSettingsFile(&c.aw, &memIo);
-                if (r.code != AW_RESULT_OK) {
-                    MLogf("Error fetching settings from camera: %d", r);
-                } else {
-                    MFileWriteDataFully(c.cameraSettingsPathBuffer, memIo.mem, memIo.size);
-                    MMemFree(&memIo);
-                }
+                c.cameraSettingsSaving = true;
+                AwCommandQueue_GetCameraSettingsFile(&c.commandQueue, &c.cameraSettingsFile, NULL,
+                                                     &c.cameraSettingsCommand);
             }
             showSettingsFileInput = true;
         }
+        ImGui::EndDisabled();
         if (showSettingsFileInput) {
             ImGui::InputText("Settings File Path", c.cameraSettingsPathBuffer, sizeof(c.cameraSettingsPathBuffer));
         } else {
@@ -1425,43 +1467,75 @@ void ShowCameraControlsWindow(AppContext& c) {
     ImGui::End();
 }
 
-static void FetchEvents(AppContext& c, float currentTime) {
-    if (currentTime - c.eventRefreshTime >= AUTO_EVENT_FETCH_INTERVAL_SECS) {
-        AwPtpEvent* events = NULL;
-        AwControl_ReadEvents(&c.aw, 10, c.autoReleasePool, &events);
-        for (int i = 0; i < MArraySize(events); ++i) {
-            AwPtpEvent* event = events + i;
-            const char* eventName = AwGetEventLabel(event->code);
-            if (!eventName) {
-                eventName = "UnknownEvent";
-            }
-            AW_LOG_INFO_F(&c.aw.logger, "%s(%04x) 0x%08x 0x%08x 0x%08x", eventName, event->code, event->param1, event->param2, event->param3);
+// Events and property refreshes are read on the command queue's thread, the UI picks up the changes from the next
+// property snapshot.  Only one poll is queued at a time.
+static void PollDevice(AppContext& c, float currentTime) {
+    AwResult r = {};
+    if (AppContext::TakeFinished(&c.pollCommand, &r)) {
+        if (r.code == AW_RESULT_CANCELLED && c.pollRefresh) {
+            // Shed by a newer command, try again next frame
+            c.propRefresh = true;
         }
-        c.eventRefreshTime = currentTime;
+        c.pollRefresh = false;
     }
-}
 
-static void RefreshProperties(AppContext& c, float currentTime) {
-    bool fullRefresh = TRUE;
-    bool propRefresh =  c.propRefresh;
+    if (AppContext::TakeFinished(&c.propSyncCommand, &r) && r.code != AW_RESULT_OK) {
+        AW_LOG_WARNING(&c.aw.logger, "Property change events not supported by device");
+        c.propEventSync = false;
+    }
+
+    if (c.pollCommand) {
+        return;
+    }
 
-    if (c.propAutoRefresh) {
+    bool readEvents = currentTime - c.eventRefreshTime >= AUTO_EVENT_FETCH_INTERVAL_SECS;
+    bool sync = c.propEventSync;
+    bool fullRefresh = TRUE;
+    bool propRefresh = c.propRefresh;
+    if (!sync && c.propAutoRefresh) {
         if (currentTime - c.propertyLastRefreshTime >= AUTO_PROP_REFRESH_INTERVAL_SECS) {
             propRefresh = true;
             fullRefresh = !c.propAutoRefreshIncremental;
         }
     }
 
+    if (!readEvents && !propRefresh) {
+        return;
+    }
+
+    c.Submit(AW_PRIORITY_REFRESH, [readEvents, sync, propRefresh, fullRefresh](AwControl* control) {
+        AwResult r = {};
+        if (readEvents) {
+            AwPtpEvent* events = NULL;
+            AwControl_ReadEvents(control, 10, control->allocator, &events);
+            for (int i = 0; i < MArraySize(events); ++i) {
+                AwPtpEvent* event = events + i;
+                const char* eventName = AwGetEventLabel(event->code);
+                if (!eventName) {
+                    eventName = "UnknownEvent";
+                }
+                AW_LOG_INFO_F(&control->logger, "%s(%04x) 0x%08x 0x%08x 0x%08x", eventName, event->code,
+                              event->param1, event->param2, event->param3);
+            }
+            MArrayFree(control->allocator, events);
+        }
+        if (sync) {
+            b32 updated = FALSE;
+            r = AwControl_SyncProperties(control, &updated);
+        }
+        if (propRefresh) {
+            r = AwControl_UpdateProperties(control, fullRefresh);
+        }
+        return r;
+    }, &c.pollCommand);
+
+    if (readEvents) {
+        c.eventRefreshTime = currentTime;
+    }
     if (propRefresh) {
-        AwControl_UpdateProperties(&c.aw, fullRefresh);
         c.propRefresh = false;
+        c.pollRefresh = true;
         c.propertyLastRefreshTime = currentTime;
-        c.propTable.needsRebuild = true;
-    }
-
-    if (c.propTable.needsRebuild) {
-        c.propTable.rebuild(c.aw);
-        c.propTable.needsSort = true;
     }
 }
 
@@ -1838,9 +1912,23 @@ void UiPtpShow(AppContext& c) {
     ShowLogWindow(c);
 
     if (c.connected) {
+        // Frames are fetched on the stream's thread and other device calls on the command queue's, the UI only
+        // reads the published frame and property snapshot
+        if (c.liveViewOpen) {
+            AwLiveViewStream_Start(&c.liveViewStream, &c.aw, AW_LIVE_VIEW_STREAM_FPS_DEFAULT);
+        } else if (c.liveViewStream.running) {
+            AwLiveViewStream_Stop(&c.liveViewStream);
+            c.liveViewFrame = nullptr;
+        }
+
         double currentTime = ImGui::GetTime();
-        FetchEvents(c, currentTime);
-        RefreshProperties(c, currentTime);
+        PollDevice(c, currentTime);
+
+        c.UpdatePropertySnapshot();
+        if (c.propTable.needsRebuild) {
+            c.propTable.rebuild(c.props);
+            c.propTable.needsSort = true;
+        }
 
         if (c.showWindowDeviceDebug) {
             ShowMainDeviceDebugWindow(c);